@@ -0,0 +1,610 @@
+/**
+ * @file base64.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/proxy/worker/codec/base64.h"
+
+#include "cc/exception.h"
+
+#include <stdint.h> // uint32_t
+
+#if ( defined(__x86_64__) || defined(__i386__) ) && defined(__GNUC__)
+    #define CASPER_PROXY_WORKER_CODEC_BASE64_X86 1
+    #include <immintrin.h>
+#endif
+
+namespace casper
+{
+
+    namespace proxy
+    {
+
+        namespace worker
+        {
+
+            namespace codec
+            {
+
+                namespace base64
+                {
+
+                    static const char k_alphabet_[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+                    //
+                    // 0xFF - invalid, 0xFE - padding
+                    //
+                    static const unsigned char k_reverse_[256] = {
+                        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,   62, 0xFF, 0xFF, 0xFF,   63,
+                          52,   53,   54,   55,   56,   57,   58,   59,   60,   61, 0xFF, 0xFF, 0xFF, 0xFE, 0xFF, 0xFF,
+                        0xFF,    0,    1,    2,    3,    4,    5,    6,    7,    8,    9,   10,   11,   12,   13,   14,
+                          15,   16,   17,   18,   19,   20,   21,   22,   23,   24,   25, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                        0xFF,   26,   27,   28,   29,   30,   31,   32,   33,   34,   35,   36,   37,   38,   39,   40,
+                          41,   42,   43,   44,   45,   46,   47,   48,   49,   50,   51, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+                    };
+
+                    typedef size_t (*Kernel)(const unsigned char*, size_t, unsigned char*);
+
+                    // MARK: - Scalar
+
+                    /**
+                     * @brief Encode full 3 byte groups.
+                     *
+                     * @return Number of characters written.
+                     */
+                    static size_t EncodeScalar (const unsigned char* a_in, size_t a_length, unsigned char* o_out)
+                    {
+                        unsigned char* out = o_out;
+                        for ( ; a_length >= 3 ; a_length -= 3, a_in += 3 ) {
+                            const uint32_t v = ( static_cast<uint32_t>(a_in[0]) << 16 ) | ( static_cast<uint32_t>(a_in[1]) << 8 ) | a_in[2];
+                            *(out++) = static_cast<unsigned char>(k_alphabet_[( v >> 18 ) & 0x3F]);
+                            *(out++) = static_cast<unsigned char>(k_alphabet_[( v >> 12 ) & 0x3F]);
+                            *(out++) = static_cast<unsigned char>(k_alphabet_[( v >>  6 ) & 0x3F]);
+                            *(out++) = static_cast<unsigned char>(k_alphabet_[v & 0x3F]);
+                        }
+                        return static_cast<size_t>(out - o_out);
+                    }
+
+                    /**
+                     * @brief Decode full 4 character groups, without padding.
+                     *
+                     * @return Number of bytes written.
+                     */
+                    static size_t DecodeScalar (const unsigned char* a_in, size_t a_length, unsigned char* o_out)
+                    {
+                        unsigned char* out = o_out;
+                        for ( ; a_length >= 4 ; a_length -= 4, a_in += 4 ) {
+                            const unsigned char a = k_reverse_[a_in[0]], b = k_reverse_[a_in[1]], c = k_reverse_[a_in[2]], d = k_reverse_[a_in[3]];
+                            if ( ( a | b | c | d ) & 0xC0 ) {
+                                throw ::cc::Exception("Invalid base64 data: unexpected character!");
+                            }
+                            const uint32_t v = ( static_cast<uint32_t>(a) << 18 ) | ( static_cast<uint32_t>(b) << 12 ) | ( static_cast<uint32_t>(c) << 6 ) | d;
+                            *(out++) = static_cast<unsigned char>(( v >> 16 ) & 0xFF);
+                            *(out++) = static_cast<unsigned char>(( v >>  8 ) & 0xFF);
+                            *(out++) = static_cast<unsigned char>(v & 0xFF);
+                        }
+                        return static_cast<size_t>(out - o_out);
+                    }
+
+                    /**
+                     * @brief Decode a last group: 2 to 4 characters, optionally padded to 4.
+                     *
+                     * @return Number of bytes written.
+                     */
+                    static size_t DecodeTail (const char* a_in, const size_t a_length, unsigned char* o_out)
+                    {
+                        size_t length = a_length;
+                        while ( length > 0 && '=' == a_in[length - 1] ) {
+                            length--;
+                        }
+                        if ( length < 2 || a_length > 4 || ( 4 != a_length && a_length != length ) || ( a_length - length ) > 2 ) {
+                            throw ::cc::Exception("Invalid base64 data: unexpected length or padding!");
+                        }
+                        uint32_t v = 0;
+                        for ( size_t idx = 0 ; idx < length ; ++idx ) {
+                            const unsigned char c = k_reverse_[static_cast<unsigned char>(a_in[idx])];
+                            if ( c & 0xC0 ) {
+                                throw ::cc::Exception("Invalid base64 data: unexpected character!");
+                            }
+                            v |= static_cast<uint32_t>(c) << ( 18 - 6 * idx );
+                        }
+                        o_out[0] = static_cast<unsigned char>(( v >> 16 ) & 0xFF);
+                        if ( length > 2 ) {
+                            o_out[1] = static_cast<unsigned char>(( v >> 8 ) & 0xFF);
+                        }
+                        if ( length > 3 ) {
+                            o_out[2] = static_cast<unsigned char>(v & 0xFF);
+                        }
+                        return length - 1;
+                    }
+
+#ifdef CASPER_PROXY_WORKER_CODEC_BASE64_X86
+
+                    // MARK: - SSSE3
+
+                    /**
+                     * @brief Map 16 6-bit values to their ASCII representation.
+                     */
+                    __attribute__((target("ssse3")))
+                    static inline __m128i EncodeLookupSSSE3 (const __m128i a_indices)
+                    {
+                        // ... 0..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12 ...
+                        __m128i result = _mm_subs_epu8(a_indices, _mm_set1_epi8(51));
+                        // ... 0..25 -> 13 ...
+                        const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), a_indices);
+                        result = _mm_or_si128(result, _mm_and_si128(less, _mm_set1_epi8(13)));
+                        const __m128i shift = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                            '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+                        return _mm_add_epi8(_mm_shuffle_epi8(shift, result), a_indices);
+                    }
+
+                    /**
+                     * @brief Split 12 bytes ( at the start of a register ) into 16 6-bit values.
+                     */
+                    __attribute__((target("ssse3")))
+                    static inline __m128i EncodeSplitSSSE3 (const __m128i a_in)
+                    {
+                        const __m128i in = _mm_shuffle_epi8(a_in, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+                        const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+                        const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+                        const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+                        const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+                        return _mm_or_si128(t1, t3);
+                    }
+
+                    __attribute__((target("ssse3")))
+                    static size_t EncodeSSSE3 (const unsigned char* a_in, size_t a_length, unsigned char* o_out)
+                    {
+                        unsigned char* out = o_out;
+                        // ... 16 bytes are loaded, 12 are consumed ...
+                        for ( ; a_length >= 16 ; a_length -= 12, a_in += 12, out += 16 ) {
+                            const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a_in));
+                            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), EncodeLookupSSSE3(EncodeSplitSSSE3(in)));
+                        }
+                        return static_cast<size_t>(out - o_out) + EncodeScalar(a_in, a_length, out);
+                    }
+
+                    /**
+                     * @brief Map 16 ASCII characters to their 6-bit values.
+                     *
+                     * @return False if any character is not part of the alphabet.
+                     */
+                    __attribute__((target("ssse3")))
+                    static inline bool DecodeLookupSSSE3 (const __m128i a_in, __m128i& o_values)
+                    {
+                        const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(a_in, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(a_in, _mm_set1_epi8('Z' + 1)));
+                        const __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(a_in, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(a_in, _mm_set1_epi8('z' + 1)));
+                        const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(a_in, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(a_in, _mm_set1_epi8('9' + 1)));
+                        const __m128i plus  = _mm_cmpeq_epi8(a_in, _mm_set1_epi8('+'));
+                        const __m128i slash = _mm_cmpeq_epi8(a_in, _mm_set1_epi8('/'));
+                        const __m128i valid = _mm_or_si128(_mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, plus)), slash);
+                        if ( 0xFFFF != _mm_movemask_epi8(valid) ) {
+                            return false;
+                        }
+                        __m128i shift = _mm_and_si128(upper, _mm_set1_epi8(-65));
+                        shift = _mm_or_si128(shift, _mm_and_si128(lower, _mm_set1_epi8(-71)));
+                        shift = _mm_or_si128(shift, _mm_and_si128(digit, _mm_set1_epi8(4)));
+                        shift = _mm_or_si128(shift, _mm_and_si128(plus , _mm_set1_epi8(19)));
+                        shift = _mm_or_si128(shift, _mm_and_si128(slash, _mm_set1_epi8(16)));
+                        o_values = _mm_add_epi8(a_in, shift);
+                        return true;
+                    }
+
+                    /**
+                     * @brief Pack 16 6-bit values into 12 bytes ( at the start of the register ).
+                     */
+                    __attribute__((target("ssse3")))
+                    static inline __m128i DecodePackSSSE3 (const __m128i a_values)
+                    {
+                        const __m128i merged = _mm_madd_epi16(_mm_maddubs_epi16(a_values, _mm_set1_epi32(0x01400140)), _mm_set1_epi32(0x00011000));
+                        return _mm_shuffle_epi8(merged, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+                    }
+
+                    __attribute__((target("ssse3")))
+                    static size_t DecodeSSSE3 (const unsigned char* a_in, size_t a_length, unsigned char* o_out)
+                    {
+                        unsigned char* out = o_out;
+                        __m128i        values;
+                        // ... 16 bytes are stored, 12 are produced, keep enough input so output has room ...
+                        for ( ; a_length >= 32 ; a_length -= 16, a_in += 16, out += 12 ) {
+                            if ( false == DecodeLookupSSSE3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a_in)), values) ) {
+                                // ... let scalar version report it ...
+                                break;
+                            }
+                            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), DecodePackSSSE3(values));
+                        }
+                        return static_cast<size_t>(out - o_out) + DecodeScalar(a_in, a_length, out);
+                    }
+
+                    // MARK: - AVX2
+
+                    __attribute__((target("avx2")))
+                    static size_t EncodeAVX2 (const unsigned char* a_in, size_t a_length, unsigned char* o_out)
+                    {
+                        unsigned char* out = o_out;
+                        const __m256i shuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                                                 1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+                        const __m256i lut     = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                                 '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+                                                                 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                                 '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+                        // ... 2 x 16 bytes are loaded, 24 are consumed ...
+                        for ( ; a_length >= 28 ; a_length -= 24, a_in += 24, out += 32 ) {
+                            const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a_in));
+                            const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a_in + 12));
+                            const __m256i in = _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1), shuffle);
+                            const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+                            const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+                            const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+                            const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+                            const __m256i indices = _mm256_or_si256(t1, t3);
+                            __m256i result = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+                            const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+                            result = _mm256_or_si256(result, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+                            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_add_epi8(_mm256_shuffle_epi8(lut, result), indices));
+                        }
+                        return static_cast<size_t>(out - o_out) + EncodeSSSE3(a_in, a_length, out);
+                    }
+
+                    __attribute__((target("avx2")))
+                    static size_t DecodeAVX2 (const unsigned char* a_in, size_t a_length, unsigned char* o_out)
+                    {
+                        unsigned char* out = o_out;
+                        // ... 32 bytes are stored, 24 are produced, keep enough input so output has room ...
+                        for ( ; a_length >= 64 ; a_length -= 32, a_in += 32, out += 24 ) {
+                            const __m256i in    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a_in));
+                            const __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(in, _mm256_set1_epi8('A' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), in));
+                            const __m256i lower = _mm256_and_si256(_mm256_cmpgt_epi8(in, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), in));
+                            const __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(in, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), in));
+                            const __m256i plus  = _mm256_cmpeq_epi8(in, _mm256_set1_epi8('+'));
+                            const __m256i slash = _mm256_cmpeq_epi8(in, _mm256_set1_epi8('/'));
+                            const __m256i valid = _mm256_or_si256(_mm256_or_si256(_mm256_or_si256(upper, lower), _mm256_or_si256(digit, plus)), slash);
+                            if ( -1 != _mm256_movemask_epi8(valid) ) {
+                                // ... let scalar version report it ...
+                                break;
+                            }
+                            __m256i shift = _mm256_and_si256(upper, _mm256_set1_epi8(-65));
+                            shift = _mm256_or_si256(shift, _mm256_and_si256(lower, _mm256_set1_epi8(-71)));
+                            shift = _mm256_or_si256(shift, _mm256_and_si256(digit, _mm256_set1_epi8(4)));
+                            shift = _mm256_or_si256(shift, _mm256_and_si256(plus , _mm256_set1_epi8(19)));
+                            shift = _mm256_or_si256(shift, _mm256_and_si256(slash, _mm256_set1_epi8(16)));
+                            const __m256i values = _mm256_add_epi8(in, shift);
+                            const __m256i merged = _mm256_madd_epi16(_mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140)), _mm256_set1_epi32(0x00011000));
+                            const __m256i packed = _mm256_shuffle_epi8(merged, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                                                                                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+                            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, -1, -1)));
+                        }
+                        return static_cast<size_t>(out - o_out) + DecodeSSSE3(a_in, a_length, out);
+                    }
+
+#endif // CASPER_PROXY_WORKER_CODEC_BASE64_X86
+
+                    // MARK: - Dispatch
+
+                    typedef struct {
+                        Kernel      encode_;
+                        Kernel      decode_;
+                        const char* name_;
+                    } Engine;
+
+                    /**
+                     * @return Best engine for this CPU, selected once.
+                     */
+                    static const Engine& SelectedEngine ()
+                    {
+                        static const Engine engine = [] () -> Engine {
+#ifdef CASPER_PROXY_WORKER_CODEC_BASE64_X86
+                            __builtin_cpu_init();
+                            if ( __builtin_cpu_supports("avx2") ) {
+                                return { EncodeAVX2, DecodeAVX2, "avx2" };
+                            } else if ( __builtin_cpu_supports("ssse3") ) {
+                                return { EncodeSSSE3, DecodeSSSE3, "ssse3" };
+                            }
+#endif
+                            return { EncodeScalar, DecodeScalar, "scalar" };
+                        }();
+                        return engine;
+                    }
+
+                } // end of namespace 'base64'
+
+            } // end of namespace 'codec'
+
+        } // end of namespace 'worker'
+
+    } // end of namespace 'proxy'
+
+} // end of namespace 'casper'
+
+// MARK: - Base64
+
+/**
+ * @brief Encode data.
+ *
+ * @param a_data   Data to encode.
+ * @param a_length Data length, in bytes.
+ * @param o_value  Encoded data.
+ */
+void casper::proxy::worker::codec::Base64::Encode (const unsigned char* a_data, const size_t a_length, std::string& o_value)
+{
+    o_value.resize(EncodedLength(a_length));
+    if ( 0 == a_length ) {
+        return;
+    }
+    char*        out  = &o_value[0];
+    const size_t full = a_length - ( a_length % 3 );
+    out += EncodeBlocks(a_data, full, out);
+    // ... tail ...
+    if ( full < a_length ) {
+        const unsigned char* in = a_data + full;
+        const uint32_t       v  = ( static_cast<uint32_t>(in[0]) << 16 ) | ( ( a_length - full ) > 1 ? static_cast<uint32_t>(in[1]) << 8 : 0 );
+        *(out++) = casper::proxy::worker::codec::base64::k_alphabet_[( v >> 18 ) & 0x3F];
+        *(out++) = casper::proxy::worker::codec::base64::k_alphabet_[( v >> 12 ) & 0x3F];
+        *(out++) = ( ( a_length - full ) > 1 ? casper::proxy::worker::codec::base64::k_alphabet_[( v >> 6 ) & 0x3F] : '=' );
+        *(out++) = '=';
+    }
+}
+
+/**
+ * @brief Encode data.
+ *
+ * @param a_data   Data to encode.
+ * @param a_length Data length, in bytes.
+ *
+ * @return Encoded data.
+ */
+std::string casper::proxy::worker::codec::Base64::Encode (const unsigned char* a_data, const size_t a_length)
+{
+    std::string value;
+    Encode(a_data, a_length, value);
+    return value;
+}
+
+/**
+ * @brief Decode data, padding is optional.
+ *
+ * @param a_data   Data to decode.
+ * @param a_length Data length, in bytes.
+ * @param o_value  Decoded data.
+ */
+void casper::proxy::worker::codec::Base64::Decode (const char* a_data, const size_t a_length, std::string& o_value)
+{
+    o_value.clear();
+    if ( 0 == a_length ) {
+        return;
+    }
+    // ... last group is always decoded by scalar version, it might have padding ...
+    const size_t tail = ( 0 == ( a_length % 4 ) ? 4 : ( a_length % 4 ) );
+    const size_t full = a_length - tail;
+    o_value.resize(( full / 4 ) * 3 + 3);
+    unsigned char* out = reinterpret_cast<unsigned char*>(&o_value[0]);
+    size_t written = DecodeBlocks(a_data, full, out);
+    written += casper::proxy::worker::codec::base64::DecodeTail(a_data + full, tail, out + written);
+    o_value.resize(written);
+}
+
+/**
+ * @return Selected engine name, for logging purposes.
+ */
+const char* casper::proxy::worker::codec::Base64::Engine ()
+{
+    return casper::proxy::worker::codec::base64::SelectedEngine().name_;
+}
+
+/**
+ * @brief Encode full 3 byte groups.
+ *
+ * @param a_data   Data to encode.
+ * @param a_length Data length, in bytes, multiple of 3.
+ * @param o_out    Output buffer, at least \link EncodedLength \link bytes.
+ *
+ * @return Number of characters written.
+ */
+size_t casper::proxy::worker::codec::Base64::EncodeBlocks (const unsigned char* a_data, const size_t a_length, char* o_out)
+{
+    return casper::proxy::worker::codec::base64::SelectedEngine().encode_(a_data, a_length, reinterpret_cast<unsigned char*>(o_out));
+}
+
+/**
+ * @brief Decode full 4 character groups, without padding.
+ *
+ * @param a_data   Data to decode.
+ * @param a_length Data length, in bytes, multiple of 4.
+ * @param o_out    Output buffer, at least ( a_length / 4 ) * 3 bytes.
+ *
+ * @return Number of bytes written.
+ */
+size_t casper::proxy::worker::codec::Base64::DecodeBlocks (const char* a_data, const size_t a_length, unsigned char* o_out)
+{
+    return casper::proxy::worker::codec::base64::SelectedEngine().decode_(reinterpret_cast<const unsigned char*>(a_data), a_length, o_out);
+}
+
+// MARK: - Encoder
+
+/**
+ * @brief Default constructor.
+ */
+casper::proxy::worker::codec::Base64::Encoder::Encoder ()
+    : count_(0)
+{
+    /* empty */
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::proxy::worker::codec::Base64::Encoder::~Encoder ()
+{
+    /* empty */
+}
+
+/**
+ * @brief Encode a chunk of data.
+ *
+ * @param a_data   Chunk data.
+ * @param a_length Chunk length, in bytes.
+ * @param a_sink   Function to call with encoded data.
+ */
+void casper::proxy::worker::codec::Base64::Encoder::Update (const unsigned char* a_data, size_t a_length, const casper::proxy::worker::codec::Base64::Sink& a_sink)
+{
+    buffer_.resize(EncodedLength(count_ + a_length));
+    char* out = &buffer_[0];
+    // ... complete pending group?
+    if ( count_ > 0 ) {
+        while ( count_ < 3 && a_length > 0 ) {
+            pending_[count_++] = *(a_data++);
+            a_length--;
+        }
+        if ( count_ < 3 ) {
+            return;
+        }
+        out += EncodeBlocks(pending_, 3, out);
+        count_ = 0;
+    }
+    const size_t full = a_length - ( a_length % 3 );
+    out += EncodeBlocks(a_data, full, out);
+    // ... keep remaining bytes ...
+    for ( size_t idx = full ; idx < a_length ; ++idx ) {
+        pending_[count_++] = a_data[idx];
+    }
+    if ( out != buffer_.c_str() ) {
+        a_sink(buffer_.c_str(), static_cast<size_t>(out - buffer_.c_str()));
+    }
+}
+
+/**
+ * @brief Flush pending data, with padding.
+ *
+ * @param a_sink Function to call with encoded data.
+ */
+void casper::proxy::worker::codec::Base64::Encoder::Final (const casper::proxy::worker::codec::Base64::Sink& a_sink)
+{
+    if ( 0 == count_ ) {
+        return;
+    }
+    Encode(pending_, count_, buffer_);
+    count_ = 0;
+    a_sink(buffer_.c_str(), buffer_.length());
+}
+
+// MARK: - Decoder
+
+/**
+ * @brief Default constructor.
+ */
+casper::proxy::worker::codec::Base64::Decoder::Decoder ()
+    : count_(0), done_(false)
+{
+    /* empty */
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::proxy::worker::codec::Base64::Decoder::~Decoder ()
+{
+    /* empty */
+}
+
+/**
+ * @brief Decode a chunk of data.
+ *
+ * @param a_data   Chunk data.
+ * @param a_length Chunk length, in bytes.
+ * @param a_sink   Function to call with decoded data.
+ */
+void casper::proxy::worker::codec::Base64::Decoder::Update (const char* a_data, size_t a_length, const casper::proxy::worker::codec::Base64::Sink& a_sink)
+{
+    if ( 0 == a_length ) {
+        return;
+    }
+    if ( true == done_ ) {
+        throw ::cc::Exception("Invalid base64 data: unexpected data after padding!");
+    }
+    buffer_.resize(( ( count_ + a_length ) / 4 ) * 3 + 3);
+    unsigned char* const start = reinterpret_cast<unsigned char*>(&buffer_[0]);
+    unsigned char*       out   = start;
+    // ... complete pending group?
+    if ( count_ > 0 ) {
+        while ( count_ < 4 && a_length > 0 ) {
+            pending_[count_++] = *(a_data++);
+            a_length--;
+        }
+        if ( count_ < 4 ) {
+            return;
+        }
+        count_ = 0;
+        if ( '=' == pending_[3] ) {
+            done_ = true;
+            out += casper::proxy::worker::codec::base64::DecodeTail(pending_, 4, out);
+        } else {
+            out += DecodeBlocks(pending_, 4, out);
+        }
+    }
+    size_t full = a_length - ( a_length % 4 );
+    if ( full > 0 && false == done_ ) {
+        // ... padding?
+        if ( '=' == a_data[full - 1] ) {
+            out += DecodeBlocks(a_data, full - 4, out);
+            out += casper::proxy::worker::codec::base64::DecodeTail(a_data + full - 4, 4, out);
+            done_ = true;
+        } else {
+            out += DecodeBlocks(a_data, full, out);
+        }
+    }
+    if ( full < a_length ) {
+        if ( true == done_ ) {
+            throw ::cc::Exception("Invalid base64 data: unexpected data after padding!");
+        }
+        // ... keep remaining characters ...
+        for ( size_t idx = full ; idx < a_length ; ++idx ) {
+            pending_[count_++] = a_data[idx];
+        }
+    }
+    if ( out != start ) {
+        a_sink(buffer_.c_str(), static_cast<size_t>(out - start));
+    }
+}
+
+/**
+ * @brief Flush pending data, accepts unpadded input.
+ *
+ * @param a_sink Function to call with decoded data.
+ */
+void casper::proxy::worker::codec::Base64::Decoder::Final (const casper::proxy::worker::codec::Base64::Sink& a_sink)
+{
+    if ( 0 == count_ ) {
+        return;
+    }
+    unsigned char out[3];
+    const size_t  written = casper::proxy::worker::codec::base64::DecodeTail(pending_, count_, out);
+    count_ = 0;
+    done_  = true;
+    a_sink(reinterpret_cast<const char*>(out), written);
+}
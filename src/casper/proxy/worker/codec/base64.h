@@ -0,0 +1,154 @@
+/**
+ * @file base64.h
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#ifndef CASPER_PROXY_WORKER_CODEC_BASE64_H_
+#define CASPER_PROXY_WORKER_CODEC_BASE64_H_
+
+#include "cc/non-movable.h"
+
+#include <string>
+#include <functional>
+
+#include <stddef.h>
+
+namespace casper
+{
+
+    namespace proxy
+    {
+
+        namespace worker
+        {
+
+            namespace codec
+            {
+
+                //
+                // RFC 4648 base64, vectorized ( AVX2 or SSSE3, selected at runtime ) with a scalar fallback.
+                //
+                class Base64 final : public ::cc::NonMovable
+                {
+
+                public: // Data Type(s)
+
+                    typedef std::function<void(const char* const, const size_t)> Sink;
+
+                    //
+                    // Streaming encoder: data can be provided in chunks of any size.
+                    //
+                    class Encoder final : public ::cc::NonMovable
+                    {
+
+                    private: // Data
+
+                        unsigned char pending_[3]; //!< bytes that didn't fit in a 3 byte group
+                        size_t        count_;      //!< number of pending bytes
+                        std::string   buffer_;     //!< output buffer, reused between calls
+
+                    public: // Constructor(s) / Destructor
+
+                        Encoder ();
+                        Encoder (const Encoder&) = delete;
+                        virtual ~Encoder ();
+
+                    public: // Overloaded Operator(s)
+
+                        void operator = (Encoder const&) = delete;  // assignment is not allowed
+
+                    public: // Method(s) / Function(s)
+
+                        void Update (const unsigned char* a_data, size_t a_length, const Sink& a_sink);
+                        void Final  (const Sink& a_sink);
+
+                    }; // end of class 'Encoder'
+
+                    //
+                    // Streaming decoder: data can be provided in chunks of any size.
+                    //
+                    class Decoder final : public ::cc::NonMovable
+                    {
+
+                    private: // Data
+
+                        char        pending_[4]; //!< characters that didn't fit in a 4 character group
+                        size_t      count_;      //!< number of pending characters
+                        bool        done_;       //!< true when padding was found
+                        std::string buffer_;     //!< output buffer, reused between calls
+
+                    public: // Constructor(s) / Destructor
+
+                        Decoder ();
+                        Decoder (const Decoder&) = delete;
+                        virtual ~Decoder ();
+
+                    public: // Overloaded Operator(s)
+
+                        void operator = (Decoder const&) = delete;  // assignment is not allowed
+
+                    public: // Method(s) / Function(s)
+
+                        void Update (const char* a_data, size_t a_length, const Sink& a_sink);
+                        void Final  (const Sink& a_sink);
+
+                    }; // end of class 'Decoder'
+
+                public: // Constructor(s) / Destructor
+
+                    Base64 () = delete;
+                    Base64 (const Base64&) = delete;
+
+                public: // Overloaded Operator(s)
+
+                    void operator = (Base64 const&) = delete;  // assignment is not allowed
+
+                public: // Static Method(s) / Function(s)
+
+                    static void        Encode (const unsigned char* a_data, const size_t a_length, std::string& o_value);
+                    static std::string Encode (const unsigned char* a_data, const size_t a_length);
+                    static void        Decode (const char* a_data, const size_t a_length, std::string& o_value);
+                    static const char* Engine ();
+
+                public: // Static Inline Method(s) / Function(s)
+
+                    /**
+                     * @return Number of characters required to encode a number of bytes, including padding.
+                     */
+                    static inline size_t EncodedLength (const size_t a_length)
+                    {
+                        return ( ( a_length + 2 ) / 3 ) * 4;
+                    }
+
+                private: // Static Method(s) / Function(s)
+
+                    static size_t EncodeBlocks (const unsigned char* a_data, const size_t a_length, char* o_out);
+                    static size_t DecodeBlocks (const char* a_data, const size_t a_length, unsigned char* o_out);
+
+                }; // end of class 'Base64'
+
+            } // end of namespace 'codec'
+
+        } // end of namespace 'worker'
+
+    } // end of namespace 'proxy'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_PROXY_WORKER_CODEC_BASE64_H_
@@ -0,0 +1,285 @@
+/**
+ * @file compressor.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/proxy/worker/codec/compressor.h"
+
+#include "cc/exception.h"
+
+#include <zlib.h>
+
+#ifdef CASPER_PROXY_WORKER_WITH_ZSTD
+    #include <zstd.h>
+#endif
+
+#include <vector>
+
+#include <strings.h> // strcasecmp
+
+/**
+ * @brief Default constructor.
+ *
+ * @param a_codec One of \link Compressor::Codec \link.
+ * @param a_level Compression level, -1 for codec's default, see \link ValidateLevel \link.
+ */
+casper::proxy::worker::codec::Compressor::Compressor (const casper::proxy::worker::codec::Compressor::Codec a_codec, const int a_level)
+    : codec_(a_codec), level_(a_level)
+{
+    ValidateLevel(codec_, level_);
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::proxy::worker::codec::Compressor::~Compressor ()
+{
+    /* empty */
+}
+
+/**
+ * @brief Compress data.
+ *
+ * @param a_data   Data to compress.
+ * @param a_length Data length, in bytes.
+ * @param a_sink   Function to call with compressed data, at most \link sk_chunk_size_ \link bytes per call.
+ */
+void casper::proxy::worker::codec::Compressor::Do (const unsigned char* a_data, const size_t a_length, const casper::proxy::worker::codec::Compressor::Sink& a_sink) const
+{
+    switch (codec_) {
+        case Codec::None:
+            a_sink(a_data, a_length);
+            break;
+        case Codec::Deflate:
+        case Codec::GZip:
+            ZLib(a_data, a_length, a_sink);
+            break;
+        case Codec::ZSTD:
+            ZSTD(a_data, a_length, a_sink);
+            break;
+    }
+}
+
+/**
+ * @brief Compress data using zlib, deflate or gzip format.
+ *
+ * @param a_data   Data to compress.
+ * @param a_length Data length, in bytes.
+ * @param a_sink   Function to call with compressed data.
+ */
+void casper::proxy::worker::codec::Compressor::ZLib (const unsigned char* a_data, const size_t a_length, const casper::proxy::worker::codec::Compressor::Sink& a_sink) const
+{
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree  = Z_NULL;
+    stream.opaque = Z_NULL;
+    // ... 15 window bits, + 16 for gzip header and trailer ...
+    if ( Z_OK != deflateInit2(&stream, level_, Z_DEFLATED, ( Codec::GZip == codec_ ? 15 + 16 : 15 ), 8, Z_DEFAULT_STRATEGY) ) {
+        throw ::cc::Exception("Unable to initialize zlib stream: %s!", ( nullptr != stream.msg ? stream.msg : "???" ));
+    }
+    std::vector<unsigned char> out(sk_chunk_size_);
+    size_t remaining = a_length;
+    stream.next_in = const_cast<unsigned char*>(a_data);
+    int rv;
+    do {
+        // ... avail_in is 32 bits wide ...
+        const uInt available = static_cast<uInt>(remaining > UINT32_MAX ? UINT32_MAX : remaining);
+        stream.avail_in = available;
+        remaining      -= available;
+        const int flush = ( 0 == remaining ? Z_FINISH : Z_NO_FLUSH );
+        do {
+            stream.next_out  = out.data();
+            stream.avail_out = static_cast<uInt>(out.size());
+            rv = deflate(&stream, flush);
+            if ( Z_STREAM_ERROR == rv ) {
+                deflateEnd(&stream);
+                throw ::cc::Exception("Unable to compress data: zlib stream error!");
+            }
+            const size_t produced = out.size() - stream.avail_out;
+            if ( produced > 0 ) {
+                try {
+                    a_sink(out.data(), produced);
+                } catch (...) {
+                    deflateEnd(&stream);
+                    throw;
+                }
+            }
+        } while ( Z_STREAM_END != rv && 0 == stream.avail_out );
+    } while ( remaining > 0 );
+    deflateEnd(&stream);
+    if ( Z_STREAM_END != rv ) {
+        throw ::cc::Exception("Unable to compress data: zlib stream not finished!");
+    }
+}
+
+/**
+ * @brief Compress data using zstd format.
+ *
+ * @param a_data   Data to compress.
+ * @param a_length Data length, in bytes.
+ * @param a_sink   Function to call with compressed data.
+ */
+void casper::proxy::worker::codec::Compressor::ZSTD (const unsigned char* a_data, const size_t a_length, const casper::proxy::worker::codec::Compressor::Sink& a_sink) const
+{
+#ifdef CASPER_PROXY_WORKER_WITH_ZSTD
+    ZSTD_CCtx* context = ZSTD_createCCtx();
+    if ( nullptr == context ) {
+        throw ::cc::Exception("Unable to create zstd context!");
+    }
+    // ... content size is known, write it to frame header ...
+    ZSTD_CCtx_setParameter(context, ZSTD_c_compressionLevel, ( -1 == level_ ? ZSTD_CLEVEL_DEFAULT : level_ ));
+    ZSTD_CCtx_setPledgedSrcSize(context, static_cast<unsigned long long>(a_length));
+    std::vector<unsigned char> out(sk_chunk_size_);
+    ZSTD_inBuffer input = { a_data, a_length, 0 };
+    size_t rv;
+    do {
+        ZSTD_outBuffer output = { out.data(), out.size(), 0 };
+        rv = ZSTD_compressStream2(context, &output, &input, ZSTD_e_end);
+        if ( 0 != ZSTD_isError(rv) ) {
+            const std::string reason = ZSTD_getErrorName(rv);
+            ZSTD_freeCCtx(context);
+            throw ::cc::Exception("Unable to compress data: %s!", reason.c_str());
+        }
+        if ( output.pos > 0 ) {
+            try {
+                a_sink(out.data(), output.pos);
+            } catch (...) {
+                ZSTD_freeCCtx(context);
+                throw;
+            }
+        }
+    } while ( 0 != rv );
+    ZSTD_freeCCtx(context);
+#else
+    (void)a_data;
+    (void)a_length;
+    (void)a_sink;
+    throw ::cc::Exception("Unable to compress data: zstd support not available!");
+#endif
+}
+
+/**
+ * @brief Translate a codec name.
+ *
+ * @param a_name Codec name: 'deflate', 'gzip' or 'zstd'.
+ *
+ * @return One of \link Compressor::Codec \link.
+ */
+casper::proxy::worker::codec::Compressor::Codec casper::proxy::worker::codec::Compressor::Translated (const std::string& a_name)
+{
+    if ( 0 == strcasecmp(a_name.c_str(), "deflate") ) {
+        return Codec::Deflate;
+    } else if ( 0 == strcasecmp(a_name.c_str(), "gzip") ) {
+        return Codec::GZip;
+    } else if ( 0 == strcasecmp(a_name.c_str(), "zstd") ) {
+#ifdef CASPER_PROXY_WORKER_WITH_ZSTD
+        return Codec::ZSTD;
+#else
+        throw ::cc::BadRequest("Compression codec '%s' not available!", a_name.c_str());
+#endif
+    }
+    throw ::cc::BadRequest("Compression codec '%s' not supported!", a_name.c_str());
+}
+
+/**
+ * @brief Obtain content type of a compressed output.
+ *
+ * @param a_codec One of \link Compressor::Codec \link.
+ *
+ * @return Content-Type value, nullptr if not compressed.
+ */
+const char* casper::proxy::worker::codec::Compressor::ContentType (const casper::proxy::worker::codec::Compressor::Codec a_codec)
+{
+    switch (a_codec) {
+        case Codec::Deflate:
+            return "application/zlib";
+        case Codec::GZip:
+            return "application/gzip";
+        case Codec::ZSTD:
+            return "application/zstd";
+        default:
+            return nullptr;
+    }
+}
+
+/**
+ * @brief Obtain HTTP Content-Encoding of a compressed output.
+ *
+ * @param a_codec One of \link Compressor::Codec \link.
+ *
+ * @return Content-Encoding value, nullptr if not compressed.
+ */
+const char* casper::proxy::worker::codec::Compressor::Encoding (const casper::proxy::worker::codec::Compressor::Codec a_codec)
+{
+    switch (a_codec) {
+        case Codec::Deflate:
+            return "deflate";
+        case Codec::GZip:
+            return "gzip";
+        case Codec::ZSTD:
+            return "zstd";
+        default:
+            return nullptr;
+    }
+}
+
+/**
+ * @brief Compress data in place, if policy allows it.
+ *
+ * @param a_policy Compression policy.
+ * @param io_data  Data to compress, replaced by compressed data.
+ *
+ * @return True if data was compressed.
+ */
+bool casper::proxy::worker::codec::Compressor::Compress (const casper::proxy::worker::codec::Compressor::Policy& a_policy, std::string& io_data)
+{
+    if ( Codec::None == a_policy.codec_ || 0 == io_data.length() || io_data.length() <= a_policy.threshold_ ) {
+        return false;
+    }
+    std::string compressed;
+    const Compressor compressor(a_policy.codec_, a_policy.level_);
+    compressor.Do(reinterpret_cast<const unsigned char*>(io_data.c_str()), io_data.length(), [&compressed] (const unsigned char* const a_data, const size_t a_size) {
+        compressed.append(reinterpret_cast<const char*>(a_data), a_size);
+    });
+    // ... not worth it?
+    if ( compressed.length() >= io_data.length() ) {
+        return false;
+    }
+    // ... release uncompressed data ...
+    io_data.swap(compressed);
+    return true;
+}
+
+/**
+ * @brief Validate a compression level.
+ *
+ * @param a_codec One of \link Compressor::Codec \link.
+ * @param a_level -1 for codec's default, 0...9 for deflate and gzip, 1...19 for zstd.
+ */
+void casper::proxy::worker::codec::Compressor::ValidateLevel (const casper::proxy::worker::codec::Compressor::Codec a_codec, const int a_level)
+{
+    if ( -1 == a_level || Codec::None == a_codec ) {
+        return;
+    }
+    const int max = ( Codec::ZSTD == a_codec ? 19 : 9 );
+    const int min = ( Codec::ZSTD == a_codec ? 1 : 0 );
+    if ( a_level < min || a_level > max ) {
+        throw ::cc::BadRequest("Invalid compression level %d, expecting -1 or a value between %d and %d!", a_level, min, max);
+    }
+}
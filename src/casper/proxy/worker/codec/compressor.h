@@ -0,0 +1,117 @@
+/**
+ * @file compressor.h
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#ifndef CASPER_PROXY_WORKER_CODEC_COMPRESSOR_H_
+#define CASPER_PROXY_WORKER_CODEC_COMPRESSOR_H_
+
+#include "cc/non-movable.h"
+
+#include <string>
+#include <functional>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace casper
+{
+
+    namespace proxy
+    {
+
+        namespace worker
+        {
+
+            namespace codec
+            {
+
+                //
+                // One-shot compression, output is delivered in chunks.
+                //
+                // - zstd is only available when built with CASPER_PROXY_WORKER_WITH_ZSTD.
+                //
+                class Compressor final : public ::cc::NonMovable
+                {
+
+                public: // Data Type(s)
+
+                    enum class Codec : uint8_t {
+                        None = 0,
+                        Deflate,  //!< zlib stream, RFC 1950
+                        GZip,     //!< gzip file, RFC 1952
+                        ZSTD      //!< zstd frame, RFC 8878
+                    };
+
+                    typedef std::function<void(const unsigned char* const, const size_t)> Sink;
+
+                    typedef struct {
+                        Codec   codec_;     //!< None disables it
+                        int8_t  level_;     //!< compression level, -1 for codec's default, see \link ValidateLevel \link
+                        size_t  threshold_; //!< only data larger than this, in bytes, is compressed
+                    } Policy;
+
+                public: // Static Const Data
+
+                    constexpr static const size_t sk_chunk_size_ = 256 * 1024;
+
+                private: // Const Data
+
+                    const Codec codec_;
+                    const int   level_;
+
+                public: // Constructor(s) / Destructor
+
+                    Compressor () = delete;
+                    Compressor (const Codec a_codec, const int a_level);
+                    Compressor (const Compressor&) = delete;
+                    virtual ~Compressor ();
+
+                public: // Overloaded Operator(s)
+
+                    void operator = (Compressor const&) = delete;  // assignment is not allowed
+
+                public: // Method(s) / Function(s)
+
+                    void Do (const unsigned char* a_data, const size_t a_length, const Sink& a_sink) const;
+
+                private: // Method(s) / Function(s)
+
+                    void ZLib (const unsigned char* a_data, const size_t a_length, const Sink& a_sink) const;
+                    void ZSTD (const unsigned char* a_data, const size_t a_length, const Sink& a_sink) const;
+
+                public: // Static Method(s) / Function(s)
+
+                    static Codec       Translated    (const std::string& a_name);
+                    static const char* ContentType   (const Codec a_codec);
+                    static const char* Encoding      (const Codec a_codec);
+                    static bool        Compress      (const Policy& a_policy, std::string& io_data);
+                    static void        ValidateLevel (const Codec a_codec, const int a_level);
+
+                }; // end of class 'Compressor'
+
+            } // end of namespace 'codec'
+
+        } // end of namespace 'worker'
+
+    } // end of namespace 'proxy'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_PROXY_WORKER_CODEC_COMPRESSOR_H_
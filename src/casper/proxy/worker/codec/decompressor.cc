@@ -0,0 +1,250 @@
+/**
+ * @file decompressor.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/proxy/worker/codec/decompressor.h"
+
+#include "cc/exception.h"
+
+#include <zlib.h>
+
+#ifdef CASPER_PROXY_WORKER_WITH_ZSTD
+    #include <zstd.h>
+#endif
+
+#include <vector>
+
+#include <strings.h> // strcasecmp
+
+#ifdef CASPER_PROXY_WORKER_WITH_ZSTD
+const char* const casper::proxy::worker::codec::Decompressor::sk_accept_encoding_ = "gzip, deflate, zstd";
+#else
+const char* const casper::proxy::worker::codec::Decompressor::sk_accept_encoding_ = "gzip, deflate";
+#endif
+
+/**
+ * @brief Obtain a response body encoding.
+ *
+ * @param a_headers Response headers.
+ *
+ * @return One of \link Compressor::Codec \link, None if not encoded.
+ */
+casper::proxy::worker::codec::Compressor::Codec casper::proxy::worker::codec::Decompressor::Encoding (const casper::proxy::worker::codec::Decompressor::Headers& a_headers)
+{
+    for ( const auto& header : a_headers ) {
+        if ( false == IsEncodingHeader(header.first) ) {
+            continue;
+        }
+        const char* const value = header.second.c_str();
+        if ( 0 == header.second.length() || 0 == strcasecmp(value, "identity") ) {
+            return Compressor::Codec::None;
+        } else if ( 0 == strcasecmp(value, "gzip") || 0 == strcasecmp(value, "x-gzip") ) {
+            return Compressor::Codec::GZip;
+        } else if ( 0 == strcasecmp(value, "deflate") ) {
+            return Compressor::Codec::Deflate;
+        }
+#ifdef CASPER_PROXY_WORKER_WITH_ZSTD
+        else if ( 0 == strcasecmp(value, "zstd") ) {
+            return Compressor::Codec::ZSTD;
+        }
+#endif
+        // ... not requested by us, a server should not send it ...
+        throw ::cc::Exception("Unsupported Content-Encoding '%s'!", value);
+    }
+    return Compressor::Codec::None;
+}
+
+/**
+ * @return True if the provided header name is 'Content-Encoding'.
+ *
+ * @param a_name Header name.
+ */
+bool casper::proxy::worker::codec::Decompressor::IsEncodingHeader (const std::string& a_name)
+{
+    return ( 0 == strcasecmp(a_name.c_str(), "Content-Encoding") );
+}
+
+/**
+ * @brief Copy headers, except 'Content-Encoding', for bodies that were decoded.
+ *
+ * @param a_headers Response headers.
+ * @param o_headers Copied headers.
+ */
+void casper::proxy::worker::codec::Decompressor::Stripped (const casper::proxy::worker::codec::Decompressor::Headers& a_headers,
+                                                           casper::proxy::worker::codec::Decompressor::Headers& o_headers)
+{
+    o_headers.clear();
+    for ( const auto& header : a_headers ) {
+        if ( false == IsEncodingHeader(header.first) ) {
+            o_headers[header.first] = header.second;
+        }
+    }
+}
+
+/**
+ * @brief Decompress data.
+ *
+ * @param a_codec  One of \link Compressor::Codec \link.
+ * @param a_data   Data to decompress.
+ * @param a_length Data length, in bytes.
+ * @param o_data   Decompressed data.
+ */
+void casper::proxy::worker::codec::Decompressor::Do (const casper::proxy::worker::codec::Compressor::Codec a_codec, const unsigned char* a_data, const size_t a_length,
+                                                     std::string& o_data)
+{
+    o_data.clear();
+    switch (a_codec) {
+        case Compressor::Codec::None:
+            o_data.assign(reinterpret_cast<const char*>(a_data), a_length);
+            break;
+        case Compressor::Codec::Deflate:
+        case Compressor::Codec::GZip:
+        {
+            // ... 15 window bits, + 32 to detect zlib or gzip header ...
+            int rv = ZLib(a_data, a_length, 15 + 32, o_data);
+            if ( Z_DATA_ERROR == rv && Compressor::Codec::Deflate == a_codec ) {
+                // ... 'deflate' should be a zlib stream, but some servers send raw deflate data ...
+                o_data.clear();
+                rv = ZLib(a_data, a_length, -15, o_data);
+            }
+            if ( Z_DATA_ERROR == rv ) {
+                throw ::cc::Exception("Unable to decompress data: invalid or unknown zlib stream format!");
+            }
+        }
+            break;
+        case Compressor::Codec::ZSTD:
+            ZSTD(a_data, a_length, o_data);
+            break;
+    }
+}
+
+/**
+ * @brief Obtain a response body, decoded if required.
+ *
+ * @param a_headers Response headers.
+ * @param a_body    Response body, as received.
+ * @param o_buffer  Buffer where decoded body will be written, only if encoded.
+ *
+ * @return \link a_body \link if not encoded, otherwise \link o_buffer \link.
+ */
+const std::string& casper::proxy::worker::codec::Decompressor::Decoded (const casper::proxy::worker::codec::Decompressor::Headers& a_headers, const std::string& a_body,
+                                                                        std::string& o_buffer)
+{
+    const Compressor::Codec codec = Encoding(a_headers);
+    if ( Compressor::Codec::None == codec ) {
+        return a_body;
+    }
+    Do(codec, reinterpret_cast<const unsigned char*>(a_body.c_str()), a_body.length(), o_buffer);
+    return o_buffer;
+}
+
+/**
+ * @brief Decompress data using zlib, deflate or gzip format.
+ *
+ * @param a_data        Data to decompress.
+ * @param a_length      Data length, in bytes.
+ * @param a_window_bits zlib window bits.
+ * @param o_data        Decompressed data.
+ *
+ * @return Z_OK on success, Z_DATA_ERROR if data is not in expected format and nothing was decompressed.
+ */
+int casper::proxy::worker::codec::Decompressor::ZLib (const unsigned char* a_data, const size_t a_length, const int a_window_bits, std::string& o_data)
+{
+    z_stream stream;
+    stream.zalloc   = Z_NULL;
+    stream.zfree    = Z_NULL;
+    stream.opaque   = Z_NULL;
+    stream.next_in  = Z_NULL;
+    stream.avail_in = 0;
+    if ( Z_OK != inflateInit2(&stream, a_window_bits) ) {
+        throw ::cc::Exception("Unable to initialize zlib stream: %s!", ( nullptr != stream.msg ? stream.msg : "???" ));
+    }
+    std::vector<unsigned char> out(Compressor::sk_chunk_size_);
+    size_t remaining = a_length;
+    stream.next_in = const_cast<unsigned char*>(a_data);
+    int rv = Z_OK;
+    do {
+        // ... avail_in is 32 bits wide ...
+        const uInt available = static_cast<uInt>(remaining > UINT32_MAX ? UINT32_MAX : remaining);
+        stream.avail_in = available;
+        remaining      -= available;
+        do {
+            stream.next_out  = out.data();
+            stream.avail_out = static_cast<uInt>(out.size());
+            rv = inflate(&stream, Z_NO_FLUSH);
+            if ( Z_DATA_ERROR == rv && 0 == stream.total_out ) {
+                inflateEnd(&stream);
+                return rv;
+            } else if ( Z_OK != rv && Z_STREAM_END != rv && Z_BUF_ERROR != rv ) {
+                const std::string reason = ( nullptr != stream.msg ? stream.msg : "???" );
+                inflateEnd(&stream);
+                throw ::cc::Exception("Unable to decompress data: %s!", reason.c_str());
+            }
+            o_data.append(reinterpret_cast<const char*>(out.data()), out.size() - stream.avail_out);
+        } while ( Z_STREAM_END != rv && 0 == stream.avail_out );
+    } while ( Z_STREAM_END != rv && remaining > 0 );
+    inflateEnd(&stream);
+    if ( Z_STREAM_END != rv ) {
+        throw ::cc::Exception("Unable to decompress data: truncated zlib stream!");
+    }
+    return Z_OK;
+}
+
+/**
+ * @brief Decompress data using zstd format.
+ *
+ * @param a_data   Data to decompress.
+ * @param a_length Data length, in bytes.
+ * @param o_data   Decompressed data.
+ */
+void casper::proxy::worker::codec::Decompressor::ZSTD (const unsigned char* a_data, const size_t a_length, std::string& o_data)
+{
+#ifdef CASPER_PROXY_WORKER_WITH_ZSTD
+    ZSTD_DCtx* context = ZSTD_createDCtx();
+    if ( nullptr == context ) {
+        throw ::cc::Exception("Unable to create zstd context!");
+    }
+    std::vector<unsigned char> out(Compressor::sk_chunk_size_);
+    ZSTD_inBuffer input = { a_data, a_length, 0 };
+    size_t rv   = 0;
+    bool   more = false;
+    do {
+        ZSTD_outBuffer output = { out.data(), out.size(), 0 };
+        rv = ZSTD_decompressStream(context, &output, &input);
+        if ( 0 != ZSTD_isError(rv) ) {
+            const std::string reason = ZSTD_getErrorName(rv);
+            ZSTD_freeDCtx(context);
+            throw ::cc::Exception("Unable to decompress data: %s!", reason.c_str());
+        }
+        o_data.append(reinterpret_cast<const char*>(out.data()), output.pos);
+        // ... a full output buffer means there might be more data to flush ...
+        more = ( input.pos < input.size || output.pos == output.size );
+    } while ( true == more );
+    ZSTD_freeDCtx(context);
+    if ( 0 != rv ) {
+        throw ::cc::Exception("Unable to decompress data: truncated zstd frame!");
+    }
+#else
+    (void)a_data;
+    (void)a_length;
+    (void)o_data;
+    throw ::cc::Exception("Unable to decompress data: zstd support not available!");
+#endif
+}
@@ -0,0 +1,95 @@
+/**
+ * @file decompressor.h
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#ifndef CASPER_PROXY_WORKER_CODEC_DECOMPRESSOR_H_
+#define CASPER_PROXY_WORKER_CODEC_DECOMPRESSOR_H_
+
+#include "cc/non-movable.h"
+
+#include "casper/proxy/worker/codec/compressor.h"
+
+#include <string>
+#include <map>
+
+#include <stddef.h>
+
+namespace casper
+{
+
+    namespace proxy
+    {
+
+        namespace worker
+        {
+
+            namespace codec
+            {
+
+                //
+                // Upstream Content-Encoding support:
+                //
+                // - bodies are received as sent, curl does not decode them, and are only decoded when they must be inspected;
+                // - zstd is only available when built with CASPER_PROXY_WORKER_WITH_ZSTD.
+                //
+                class Decompressor final : public ::cc::NonMovable
+                {
+
+                public: // Data Type(s)
+
+                    typedef std::map<std::string, std::string> Headers;
+
+                public: // Static Const Data
+
+                    static const char* const sk_accept_encoding_;
+
+                public: // Constructor(s) / Destructor
+
+                    Decompressor () = delete;
+                    Decompressor (const Decompressor&) = delete;
+
+                public: // Overloaded Operator(s)
+
+                    void operator = (Decompressor const&) = delete;  // assignment is not allowed
+
+                public: // Static Method(s) / Function(s)
+
+                    static Compressor::Codec  Encoding          (const Headers& a_headers);
+                    static bool               IsEncodingHeader  (const std::string& a_name);
+                    static void               Stripped          (const Headers& a_headers, Headers& o_headers);
+                    static void               Do                (const Compressor::Codec a_codec, const unsigned char* a_data, const size_t a_length, std::string& o_data);
+                    static const std::string& Decoded           (const Headers& a_headers, const std::string& a_body, std::string& o_buffer);
+
+                private: // Static Method(s) / Function(s)
+
+                    static int  ZLib (const unsigned char* a_data, const size_t a_length, const int a_window_bits, std::string& o_data);
+                    static void ZSTD (const unsigned char* a_data, const size_t a_length, std::string& o_data);
+
+                }; // end of class 'Decompressor'
+
+            } // end of namespace 'codec'
+
+        } // end of namespace 'worker'
+
+    } // end of namespace 'proxy'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_PROXY_WORKER_CODEC_DECOMPRESSOR_H_
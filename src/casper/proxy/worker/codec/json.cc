@@ -0,0 +1,47 @@
+/**
+ * @file json.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/proxy/worker/codec/json.h"
+
+#include "cc/exception.h"
+
+#include <memory>
+
+/**
+ * @brief Parse a JSON document.
+ *
+ * @param a_data  JSON document.
+ * @param o_value Parsed value.
+ */
+void casper::proxy::worker::codec::JSON::Parse (const std::string& a_data, Json::Value& o_value)
+{
+    // ... building a reader is not cheap, one per thread ...
+    thread_local std::unique_ptr<Json::CharReader> reader;
+    if ( nullptr == reader ) {
+        Json::CharReaderBuilder builder;
+        builder["collectComments"] = false;
+        reader.reset(builder.newCharReader());
+    }
+    std::string errors;
+    if ( false == reader->parse(a_data.c_str(), a_data.c_str() + a_data.length(), &o_value, &errors) ) {
+        throw ::cc::Exception("Unable to parse JSON: %s", errors.c_str());
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ * @file json.h
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#ifndef CASPER_PROXY_WORKER_CODEC_JSON_H_
+#define CASPER_PROXY_WORKER_CODEC_JSON_H_
+
+#include "cc/non-movable.h"
+
+#include "json/json.h"
+
+#include <string>
+
+namespace casper
+{
+
+    namespace proxy
+    {
+
+        namespace worker
+        {
+
+            namespace codec
+            {
+
+                //
+                // JSON parsing for response bodies: one reader per thread, reused, parsing straight from the body buffer.
+                //
+                class JSON final : public ::cc::NonMovable
+                {
+
+                public: // Constructor(s) / Destructor
+
+                    JSON () = delete;
+                    JSON (const JSON&) = delete;
+
+                public: // Overloaded Operator(s)
+
+                    void operator = (JSON const&) = delete;  // assignment is not allowed
+
+                public: // Static Method(s) / Function(s)
+
+                    static void Parse (const std::string& a_data, Json::Value& o_value);
+
+                }; // end of class 'JSON'
+
+            } // end of namespace 'codec'
+
+        } // end of namespace 'worker'
+
+    } // end of namespace 'proxy'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_PROXY_WORKER_CODEC_JSON_H_
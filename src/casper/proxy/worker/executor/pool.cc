@@ -0,0 +1,116 @@
+/**
+ * @file pool.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/proxy/worker/executor/pool.h"
+
+#include <algorithm> // std::min, std::max
+
+/**
+ * @brief Default constructor.
+ *
+ * @param a_max_threads Default maximum number of threads, bounded by hardware concurrency.
+ */
+casper::proxy::worker::executor::Pool::Pool (const size_t a_max_threads)
+    : max_threads_(std::max(static_cast<size_t>(1), std::min(a_max_threads, static_cast<size_t>(std::thread::hardware_concurrency())))),
+      idle_(0), stop_(false)
+{
+    /* empty */
+}
+
+/**
+ * @brief Destructor, waits for pending tasks.
+ */
+casper::proxy::worker::executor::Pool::~Pool ()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    condition_.notify_all();
+    for ( auto& thread : threads_ ) {
+        thread.join();
+    }
+}
+
+/**
+ * @brief Set maximum number of threads, only effective before first submission.
+ *
+ * @param a_threads Number of threads, 0 to keep default.
+ */
+void casper::proxy::worker::executor::Pool::Setup (const size_t a_threads)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if ( 0 == a_threads || 0 != threads_.size() ) {
+        return;
+    }
+    max_threads_ = std::min(a_threads, static_cast<size_t>(sk_max_limit_));
+}
+
+/**
+ * @brief Submit a task to be executed by one of this pool threads.
+ *
+ * @param a_task Function to call, ⚠️ exceptions must be handled by the task itself.
+ *
+ * @return True if task was accepted, false if queue is full - caller should run it in place.
+ */
+bool casper::proxy::worker::executor::Pool::Submit (casper::proxy::worker::executor::Pool::Task a_task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if ( true == stop_ || tasks_.size() >= sk_max_pending_ ) {
+            return false;
+        }
+        // ... no idle threads? start one more, if allowed ...
+        if ( 0 == idle_ && threads_.size() < max_threads_ ) {
+            threads_.push_back(std::thread(&casper::proxy::worker::executor::Pool::Loop, this));
+        }
+        tasks_.push_back(std::move(a_task));
+    }
+    condition_.notify_one();
+    return true;
+}
+
+/**
+ * @brief Thread loop.
+ */
+void casper::proxy::worker::executor::Pool::Loop ()
+{
+    while ( true ) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            idle_++;
+            condition_.wait(lock, [this] { return ( true == stop_ || tasks_.size() > 0 ); });
+            idle_--;
+            if ( 0 == tasks_.size() ) {
+                // ... stopping and nothing left to do ...
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        try {
+            task();
+        } catch (...) {
+            // ... tasks must handle their own exceptions, never let one kill this thread ...
+        }
+    }
+}
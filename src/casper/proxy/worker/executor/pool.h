@@ -0,0 +1,129 @@
+/**
+ * @file pool.h
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#ifndef CASPER_PROXY_WORKER_EXECUTOR_POOL_H_
+#define CASPER_PROXY_WORKER_EXECUTOR_POOL_H_
+
+#include "cc/non-movable.h"
+
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace casper
+{
+
+    namespace proxy
+    {
+
+        namespace worker
+        {
+
+            namespace executor
+            {
+
+                //
+                // Process wide, bounded, thread pool for CPU or disk bound work that must not run on looper or main threads.
+                //
+                // - tasks are rejected ( not queued ) when the queue is full, callers should fallback to run them in place;
+                // - threads are only started on first submission;
+                // - V8 work ( interceptors, GC ) has its own instance, it blocks on isolates and must not starve post-processing.
+                //
+                class Pool final : public ::cc::NonMovable
+                {
+
+                public: // Data Type(s)
+
+                    typedef std::function<void()> Task;
+
+                public: // Static Const Data
+
+                    constexpr static const size_t sk_max_threads_ = 4;  //!< default number of threads
+                    constexpr static const size_t sk_v8_threads_  = 2;  //!< default number of threads, V8 instance
+                    constexpr static const size_t sk_max_limit_   = 64; //!< maximum configurable number of threads
+                    constexpr static const size_t sk_max_pending_ = 64;
+
+                private: // Data
+
+                    size_t                   max_threads_; //!< at most sk_max_threads_ or sk_v8_threads_, bounded by hardware concurrency, unless configured
+                    std::mutex               mutex_;
+                    std::condition_variable  condition_;
+                    std::deque<Task>         tasks_;    //!< pending tasks
+                    std::vector<std::thread> threads_;  //!< started on demand
+                    size_t                   idle_;     //!< number of threads waiting for tasks
+                    bool                     stop_;     //!< true when shutting down
+
+                private: // Constructor(s) / Destructor
+
+                    Pool (const size_t a_max_threads);
+                    virtual ~Pool ();
+
+                public: // Constructor(s) / Destructor
+
+                    Pool (const Pool&) = delete;
+
+                public: // Overloaded Operator(s)
+
+                    void operator = (Pool const&) = delete;  // assignment is not allowed
+
+                public: // Method(s) / Function(s)
+
+                    void Setup  (const size_t a_threads);
+                    bool Submit (Task a_task);
+
+                private: // Method(s) / Function(s)
+
+                    void Loop ();
+
+                public: // Static Method(s) / Function(s)
+
+                    /**
+                     * @return Process wide instance.
+                     */
+                    static Pool& GetInstance ()
+                    {
+                        static Pool instance(sk_max_threads_);
+                        return instance;
+                    }
+
+                    /**
+                     * @return Process wide instance for V8 work.
+                     */
+                    static Pool& GetV8Instance ()
+                    {
+                        static Pool instance(sk_v8_threads_);
+                        return instance;
+                    }
+
+                }; // end of class 'Pool'
+
+            } // end of namespace 'executor'
+
+        } // end of namespace 'worker'
+
+    } // end of namespace 'proxy'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_PROXY_WORKER_EXECUTOR_POOL_H_
@@ -0,0 +1,163 @@
+/**
+ * @file ring.h
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#ifndef CASPER_PROXY_WORKER_EXECUTOR_RING_H_
+#define CASPER_PROXY_WORKER_EXECUTOR_RING_H_
+
+#include "cc/non-movable.h"
+
+#include <atomic>
+#include <utility> // std::move
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace casper
+{
+
+    namespace proxy
+    {
+
+        namespace worker
+        {
+
+            namespace executor
+            {
+
+                //
+                // Bounded, lock-free, multiple producers single consumer queue of fixed size records.
+                //
+                // - producers claim a cell with a CAS on head, consumer owns tail, cells sequence numbers tell who may access them;
+                // - \link Push \link never blocks, it fails when full;
+                // - \link Pop \link must only be called by one thread at a time.
+                //
+                template <typename T, size_t N>
+                class Ring final : public ::cc::NonMovable
+                {
+
+                    static_assert(N >= 2 && 0 == ( N & ( N - 1 ) ), "Ring size must be a power of 2!");
+
+                private: // Data Type(s)
+
+                    typedef struct {
+                        std::atomic<size_t> sequence_;
+                        T                   value_;
+                    } Cell;
+
+                private: // Data
+
+                    Cell                cells_[N];
+                    char                pad0_[64];  //!< keep producers and consumer indexes in different cache lines
+                    std::atomic<size_t> head_;      //!< next cell to claim, producers
+                    char                pad1_[64];
+                    size_t              tail_;      //!< next cell to read, consumer
+
+                public: // Constructor(s) / Destructor
+
+                    /**
+                     * @brief Default constructor.
+                     */
+                    Ring ()
+                        : head_(0), tail_(0)
+                    {
+                        for ( size_t idx = 0 ; idx < N ; ++idx ) {
+                            cells_[idx].sequence_.store(idx, std::memory_order_relaxed);
+                        }
+                    }
+
+                    Ring (const Ring&) = delete;
+
+                    /**
+                     * @brief Destructor.
+                     */
+                    virtual ~Ring ()
+                    {
+                        /* empty */
+                    }
+
+                public: // Overloaded Operator(s)
+
+                    void operator = (Ring const&) = delete;  // assignment is not allowed
+
+                public: // Method(s) / Function(s)
+
+                    /**
+                     * @brief Append a record, from any thread.
+                     *
+                     * @param a_value Record to copy.
+                     *
+                     * @return True if it was queued, false if queue is full.
+                     */
+                    bool Push (const T& a_value)
+                    {
+                        size_t position = head_.load(std::memory_order_relaxed);
+                        while ( true ) {
+                            Cell&          cell     = cells_[position & ( N - 1 )];
+                            const size_t   sequence = cell.sequence_.load(std::memory_order_acquire);
+                            const intptr_t diff     = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+                            if ( 0 == diff ) {
+                                // ... free, claim it ...
+                                if ( true == head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed) ) {
+                                    cell.value_ = a_value;
+                                    cell.sequence_.store(position + 1, std::memory_order_release);
+                                    return true;
+                                }
+                            } else if ( diff < 0 ) {
+                                // ... not read yet: full ...
+                                return false;
+                            } else {
+                                // ... claimed by another producer ...
+                                position = head_.load(std::memory_order_relaxed);
+                            }
+                        }
+                    }
+
+                    /**
+                     * @brief Take the oldest record, ⚠️ consumer thread only.
+                     *
+                     * @param o_value Record.
+                     *
+                     * @return True if a record was taken, false if queue is empty ( or oldest record is still being written ).
+                     */
+                    bool Pop (T& o_value)
+                    {
+                        Cell& cell = cells_[tail_ & ( N - 1 )];
+                        if ( cell.sequence_.load(std::memory_order_acquire) != tail_ + 1 ) {
+                            return false;
+                        }
+                        o_value = std::move(cell.value_);
+                        // ... free it for the next lap ...
+                        cell.sequence_.store(tail_ + N, std::memory_order_release);
+                        tail_++;
+                        return true;
+                    }
+
+                }; // end of class 'Ring'
+
+            } // end of namespace 'executor'
+
+        } // end of namespace 'worker'
+
+    } // end of namespace 'proxy'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_PROXY_WORKER_EXECUTOR_RING_H_
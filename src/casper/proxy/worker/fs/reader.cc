@@ -0,0 +1,93 @@
+/**
+ * @file reader.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/proxy/worker/fs/reader.h"
+
+#include "cc/exception.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h> // PATH_MAX
+#include <stdlib.h> // realpath
+#include <string.h> // strerror, strncmp
+#include <strings.h> // strncasecmp
+#include <unistd.h>
+#include <sys/stat.h>
+
+/**
+ * @brief Load a local file.
+ *
+ * @param a_uri    Local file URI, 'file://' scheme is optional.
+ * @param a_prefix Trusted directory, file must be under it ( after resolving links and relative components ), empty if any file can be read.
+ * @param o_data   File content.
+ */
+void casper::proxy::worker::fs::Reader::Load (const std::string& a_uri, const std::string& a_prefix, std::string& o_data)
+{
+    const char* const uri = ( 0 == strncasecmp(a_uri.c_str(), "file://", 7) ? a_uri.c_str() + 7 : a_uri.c_str() );
+    // ... resolve paths ...
+    char file[PATH_MAX];
+    if ( nullptr == realpath(uri, file) ) {
+        throw ::cc::BadRequest("Unable to load file '%s': %s!", uri, strerror(errno));
+    }
+    // ... must be under trusted directory?
+    if ( 0 != a_prefix.length() ) {
+        char prefix[PATH_MAX];
+        if ( nullptr == realpath(a_prefix.c_str(), prefix) ) {
+            throw ::cc::InternalServerError("Unable to resolve directory '%s': %s!", a_prefix.c_str(), strerror(errno));
+        }
+        const size_t length = strlen(prefix);
+        if ( 0 != strncmp(file, prefix, length) || ( '/' != file[length] && '/' != prefix[length - 1] ) ) {
+            throw ::cc::BadRequest("Unable to load file '%s': not allowed!", uri);
+        }
+    }
+    // ... open it ...
+    const int fd = open(file, O_RDONLY | O_CLOEXEC);
+    if ( -1 == fd ) {
+        throw ::cc::BadRequest("Unable to open file '%s': %s!", uri, strerror(errno));
+    }
+    struct stat st;
+    if ( 0 != fstat(fd, &st) || false == S_ISREG(st.st_mode) ) {
+        close(fd);
+        throw ::cc::BadRequest("Unable to load file '%s': not a regular file!", uri);
+    }
+#ifdef __linux__
+    // ... read once, sequentially ...
+    (void)posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    // ... read it into final buffer ...
+    o_data.resize(static_cast<size_t>(st.st_size));
+    size_t offset = 0;
+    while ( offset < o_data.size() ) {
+        const ssize_t rv = pread(fd, &o_data[offset], o_data.size() - offset, static_cast<off_t>(offset));
+        if ( rv > 0 ) {
+            offset += static_cast<size_t>(rv);
+        } else if ( 0 == rv ) {
+            // ... truncated while reading ...
+            o_data.resize(offset);
+            break;
+        } else if ( EINTR != errno ) {
+            const int error = errno;
+            close(fd);
+            throw ::cc::InternalServerError("Unable to read file '%s': %s!", uri, strerror(error));
+        }
+    }
+    close(fd);
+}
@@ -0,0 +1,73 @@
+/**
+ * @file reader.h
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#ifndef CASPER_PROXY_WORKER_FS_READER_H_
+#define CASPER_PROXY_WORKER_FS_READER_H_
+
+#include "cc/non-movable.h"
+
+#include <string>
+
+namespace casper
+{
+
+    namespace proxy
+    {
+
+        namespace worker
+        {
+
+            namespace fs
+            {
+
+                //
+                // Local files used as request bodies, e.g. exports produced by other workers in the same tmp area:
+                //
+                // - when a trusted directory is provided only files under it can be read;
+                // - size is known up front, so data is read straight into it's final buffer, without intermediate copies.
+                //
+                class Reader final : public ::cc::NonMovable
+                {
+
+                public: // Constructor(s) / Destructor
+
+                    Reader () = delete;
+                    Reader (const Reader&) = delete;
+
+                public: // Overloaded Operator(s)
+
+                    void operator = (Reader const&) = delete;  // assignment is not allowed
+
+                public: // Static Method(s) / Function(s)
+
+                    static void Load (const std::string& a_uri, const std::string& a_prefix, std::string& o_data);
+
+                }; // end of class 'Reader'
+
+            } // end of namespace 'fs'
+
+        } // end of namespace 'worker'
+
+    } // end of namespace 'proxy'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_PROXY_WORKER_FS_READER_H_
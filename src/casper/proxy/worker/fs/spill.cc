@@ -0,0 +1,84 @@
+/**
+ * @file spill.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/proxy/worker/fs/spill.h"
+
+#include "casper/proxy/worker/fs/writer.h"
+#include "casper/proxy/worker/fs/store.h"
+
+#include "cc/fs/file.h"
+#include "cc/hash/sha256.h"
+
+/**
+ * @brief Write a response body to file, if it exceeds configured threshold.
+ *
+ * @param a_config  Spill config.
+ * @param a_body    Response body.
+ * @param o_payload JSON object where 'url', 'size' and 'sha256' will be set, only if body was written.
+ *
+ * @return True if body was written to file, false if it should be inlined.
+ */
+bool casper::proxy::worker::fs::Spill::Do (const casper::proxy::worker::fs::Spill::Config& a_config, const std::string& a_body, Json::Value& o_payload)
+{
+    // ... disabled or small enough?
+    if ( 0 == a_config.threshold_ || a_body.length() <= a_config.threshold_ ) {
+        // ... yes, inline it ...
+        return false;
+    }
+    // ... make unique file ...
+    std::string uri;
+    ::cc::fs::File::Unique(a_config.dir_, /* name */ "", "ohc", uri);
+    // ... write it, unless same content was already written ...
+    const std::string sha256 = ::cc::hash::SHA256::Calculate(a_body);
+    (void)casper::proxy::worker::fs::Store::Put(a_config.store_, sha256, uri, [&uri, &a_body] () {
+        casper::proxy::worker::fs::Writer writer(uri, a_body.length());
+        writer.Append(reinterpret_cast<const unsigned char*>(a_body.c_str()), a_body.length());
+        writer.Close();
+    });
+    // ... set URL ...
+    o_payload["url"] = URL(a_config, uri);
+    // ... and what's needed to validate it ...
+    o_payload["size"]   = static_cast<Json::UInt64>(a_body.length());
+    o_payload["sha256"] = sha256;
+    // ... done ...
+    return true;
+}
+
+/**
+ * @brief Build the URL of a file written to the output directory.
+ *
+ * @param a_config Spill config.
+ * @param a_uri    File URI.
+ *
+ * @return 'file://' URL if no base URL is configured, otherwise base URL followed by file URI without output directory prefix.
+ */
+std::string casper::proxy::worker::fs::Spill::URL (const casper::proxy::worker::fs::Spill::Config& a_config, const std::string& a_uri)
+{
+    if ( 0 == a_config.base_url_.length() ) {
+        return "file://" + a_uri;
+    }
+    std::string url = a_config.base_url_;
+    if ( '/' != url[url.length() - 1] ) {
+        url += '/';
+    }
+    url += std::string(a_uri.c_str() + a_config.prefix_.length());
+    return url;
+}
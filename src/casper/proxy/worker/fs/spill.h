@@ -0,0 +1,85 @@
+/**
+ * @file spill.h
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#ifndef CASPER_PROXY_WORKER_FS_SPILL_H_
+#define CASPER_PROXY_WORKER_FS_SPILL_H_
+
+#include "cc/non-movable.h"
+
+#include "json/json.h"
+
+#include <string>
+
+#include <stddef.h>
+
+namespace casper
+{
+
+    namespace proxy
+    {
+
+        namespace worker
+        {
+
+            namespace fs
+            {
+
+                //
+                // Oversized response bodies are written to the tmp output area instead of being inlined in job payloads.
+                //
+                class Spill final : public ::cc::NonMovable
+                {
+
+                public: // Data Type(s)
+
+                    typedef struct {
+                        size_t      threshold_; //!< bodies larger than this, in bytes, are written to file, 0 disables it
+                        std::string dir_;       //!< output directory
+                        std::string prefix_;    //!< output directory prefix, stripped from file URI to build it's URL
+                        std::string base_url_;  //!< URL to access output directory prefix, if empty a 'file://' URL is used
+                        std::string store_;     //!< content addressed store directory, empty if disabled, see \link Store \link
+                    } Config;
+
+                public: // Constructor(s) / Destructor
+
+                    Spill () = delete;
+                    Spill (const Spill&) = delete;
+
+                public: // Overloaded Operator(s)
+
+                    void operator = (Spill const&) = delete;  // assignment is not allowed
+
+                public: // Static Method(s) / Function(s)
+
+                    static bool        Do  (const Config& a_config, const std::string& a_body, Json::Value& o_payload);
+                    static std::string URL (const Config& a_config, const std::string& a_uri);
+
+                }; // end of class 'Spill'
+
+            } // end of namespace 'fs'
+
+        } // end of namespace 'worker'
+
+    } // end of namespace 'proxy'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_PROXY_WORKER_FS_SPILL_H_
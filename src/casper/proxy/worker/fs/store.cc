@@ -0,0 +1,142 @@
+/**
+ * @file store.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/proxy/worker/fs/store.h"
+
+#include "cc/hash/sha256.h"
+
+#include <errno.h>
+#include <dirent.h>   // opendir, readdir
+#include <stdio.h>    // rename
+#include <sys/stat.h> // mkdir, lstat
+#include <unistd.h>   // link, unlink
+
+/**
+ * @brief Build an object key.
+ *
+ * @param a_data    Data, as it would be written.
+ * @param a_variant How data is transformed when written ( e.g. encoding ), empty if written as-is.
+ *
+ * @return Object key.
+ */
+std::string casper::proxy::worker::fs::Store::Key (const std::string& a_data, const std::string& a_variant)
+{
+    return ::cc::hash::SHA256::Calculate(a_data) + ( 0 != a_variant.length() ? "-" + a_variant : "" );
+}
+
+/**
+ * @brief Make a file with the content identified by the provided key, linking it to a stored object or writing it.
+ *
+ * @param a_dir   Store directory, if empty file is just written.
+ * @param a_key   Object key, see \link Key \link.
+ * @param a_uri   Local file URI, an existing file is replaced.
+ * @param a_write Function to call to write file, when there's no stored object yet.
+ *
+ * @return True if file was linked to a stored object, false if it was written.
+ */
+bool casper::proxy::worker::fs::Store::Put (const std::string& a_dir, const std::string& a_key, const std::string& a_uri, const std::function<void()>& a_write)
+{
+    // ... disabled?
+    if ( 0 == a_dir.length() ) {
+        a_write();
+        return false;
+    }
+    // ... already stored? link it, replacing file atomically ...
+    const std::string tmp = a_uri + ".lnk";
+    if ( 0 == link(Object(a_dir, a_key, /* a_create */ false).c_str(), tmp.c_str()) ) {
+        if ( 0 == rename(tmp.c_str(), a_uri.c_str()) ) {
+            return true;
+        }
+        (void)unlink(tmp.c_str());
+    }
+    // ... no, write it ...
+    a_write();
+    // ... and store it, best effort: if it was stored meanwhile, next ones will link to that one ...
+    const std::string object = Object(a_dir, a_key, /* a_create */ true);
+    if ( 0 != object.length() ) {
+        (void)link(a_uri.c_str(), object.c_str());
+    }
+    return false;
+}
+
+/**
+ * @brief Remove objects no longer linked by any job file.
+ *
+ * @param a_dir   Store directory.
+ * @param o_files Incremented by the number of removed objects.
+ * @param o_bytes Incremented by the number of reclaimed bytes.
+ */
+void casper::proxy::worker::fs::Store::Prune (const std::string& a_dir, uint64_t& o_files, uint64_t& o_bytes)
+{
+    const std::string root = ( 0 != a_dir.length() && '/' == a_dir[a_dir.length() - 1] ? a_dir : a_dir + '/' );
+    DIR* store = opendir(root.c_str());
+    if ( nullptr == store ) {
+        return;
+    }
+    struct dirent* parent;
+    while ( nullptr != ( parent = readdir(store) ) ) {
+        if ( '.' == parent->d_name[0] ) {
+            continue;
+        }
+        const std::string path = root + parent->d_name + '/';
+        DIR* objects = opendir(path.c_str());
+        if ( nullptr == objects ) {
+            continue;
+        }
+        struct dirent* object;
+        while ( nullptr != ( object = readdir(objects) ) ) {
+            const std::string uri = path + object->d_name;
+            struct stat st;
+            // ... only the store link is left?
+            if ( '.' != object->d_name[0] && 0 == lstat(uri.c_str(), &st) && 0 != S_ISREG(st.st_mode) && 1 == st.st_nlink && 0 == unlink(uri.c_str()) ) {
+                o_files += 1;
+                o_bytes += static_cast<uint64_t>(st.st_size);
+            }
+        }
+        closedir(objects);
+    }
+    closedir(store);
+}
+
+/**
+ * @brief Build an object URI.
+ *
+ * @param a_dir    Store directory.
+ * @param a_key    Object key.
+ * @param a_create When true, object parent directory is created if needed.
+ *
+ * @return Object URI, empty if it's parent directory could not be created.
+ */
+std::string casper::proxy::worker::fs::Store::Object (const std::string& a_dir, const std::string& a_key, const bool a_create)
+{
+    std::string uri = a_dir;
+    if ( 0 == uri.length() || '/' != uri[uri.length() - 1] ) {
+        uri += '/';
+    }
+    if ( true == a_create && 0 != mkdir(uri.c_str(), 0755) && EEXIST != errno ) {
+        return "";
+    }
+    uri += a_key.substr(0, 2) + '/';
+    if ( true == a_create && 0 != mkdir(uri.c_str(), 0755) && EEXIST != errno ) {
+        return "";
+    }
+    return uri + a_key;
+}
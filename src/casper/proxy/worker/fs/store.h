@@ -0,0 +1,84 @@
+/**
+ * @file store.h
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#ifndef CASPER_PROXY_WORKER_FS_STORE_H_
+#define CASPER_PROXY_WORKER_FS_STORE_H_
+
+#include "cc/non-movable.h"
+
+#include <string>
+#include <functional>
+
+#include <stdint.h>
+
+namespace casper
+{
+
+    namespace proxy
+    {
+
+        namespace worker
+        {
+
+            namespace fs
+            {
+
+                //
+                // Content addressed store for tmp output files:
+                //
+                // - each distinct content is stored once, as '<dir>/<2 first hash chars>/<hash>[-<variant>]';
+                // - job files are hard links to the stored object, so each keeps it's own name and validity, and the data is kept
+                //   for as long as any of them is;
+                // - an object that is no longer linked by any job file can be safely removed, job files are never affected.
+                //
+                class Store final : public ::cc::NonMovable
+                {
+
+                public: // Constructor(s) / Destructor
+
+                    Store () = delete;
+                    Store (const Store&) = delete;
+
+                public: // Overloaded Operator(s)
+
+                    void operator = (Store const&) = delete;  // assignment is not allowed
+
+                public: // Static Method(s) / Function(s)
+
+                    static std::string Key   (const std::string& a_data, const std::string& a_variant);
+                    static bool        Put   (const std::string& a_dir, const std::string& a_key, const std::string& a_uri, const std::function<void()>& a_write);
+                    static void        Prune (const std::string& a_dir, uint64_t& o_files, uint64_t& o_bytes);
+
+                private: // Static Method(s) / Function(s)
+
+                    static std::string Object (const std::string& a_dir, const std::string& a_key, const bool a_create);
+
+                }; // end of class 'Store'
+
+            } // end of namespace 'fs'
+
+        } // end of namespace 'worker'
+
+    } // end of namespace 'proxy'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_PROXY_WORKER_FS_STORE_H_
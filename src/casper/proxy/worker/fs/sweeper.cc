@@ -0,0 +1,235 @@
+/**
+ * @file sweeper.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/proxy/worker/fs/sweeper.h"
+
+#include "casper/proxy/worker/fs/store.h"
+
+#include "cc/exception.h"
+
+#include <chrono>
+#include <vector>
+
+#include <errno.h>
+#include <dirent.h>       // opendir, readdir
+#include <stdio.h>        // rename
+#include <stdlib.h>       // strtoll
+#include <string.h>       // strerror
+#include <sys/stat.h>     // mkdir, lstat
+#include <sys/resource.h> // setpriority
+#include <time.h>         // time
+#include <unistd.h>       // unlink, rmdir
+#ifdef __linux__
+    #include <sys/syscall.h> // SYS_gettid
+#endif
+
+/**
+ * @brief Default constructor.
+ */
+casper::proxy::worker::fs::Sweeper::Sweeper ()
+    : stop_(false), stats_({ /* buckets_ */ 0, /* files_ */ 0, /* bytes_ */ 0 })
+{
+    /* empty */
+}
+
+/**
+ * @brief Destructor, waits for sweep in progress ( if any ).
+ */
+casper::proxy::worker::fs::Sweeper::~Sweeper ()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    condition_.notify_all();
+    if ( true == thread_.joinable() ) {
+        thread_.join();
+    }
+}
+
+/**
+ * @brief Obtain ( creating it if needed ) the directory where files with the provided validity should be written.
+ *
+ * @param a_prefix   Output directory prefix.
+ * @param a_validity Files validity, in seconds.
+ * @param a_bucket   Time bucket size, in seconds.
+ * @param a_grace    Grace period, in seconds, at least the request timeout: validity only starts once files are written.
+ *
+ * @return Directory URI.
+ */
+std::string casper::proxy::worker::fs::Sweeper::Dir (const std::string& a_prefix, const int64_t a_validity, const int64_t a_bucket, const int64_t a_grace)
+{
+    const std::string root   = a_prefix + ( 0 != a_prefix.length() && '/' == a_prefix[a_prefix.length() - 1] ? "" : "/" ) + "expires/";
+    // ... bucket is picked when job is set up, it must outlive the request that will write to it ...
+    const int64_t     expires = static_cast<int64_t>(time(nullptr)) + ( a_validity > 0 ? a_validity : 0 ) + ( a_grace > 0 ? a_grace : 0 ) + sk_margin_;
+    // ... rounded up, so that files are never removed before they expire ...
+    const int64_t     bucket  = ( ( expires + a_bucket - 1 ) / a_bucket ) * a_bucket;
+    const std::string dir     = root + std::to_string(bucket) + '/';
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = roots_.find(root);
+    if ( roots_.end() == it || it->second != bucket ) {
+        // ... first file in this bucket ...
+        if ( ( 0 != mkdir(root.c_str(), 0755) && EEXIST != errno ) || ( 0 != mkdir(dir.c_str(), 0755) && EEXIST != errno ) ) {
+            throw ::cc::Exception("Unable to create directory '%s': %s!", dir.c_str(), strerror(errno));
+        }
+        roots_[root] = bucket;
+        Start();
+    }
+    return dir;
+}
+
+/**
+ * @brief Keep a content addressed store pruned, see \link Store::Prune \link.
+ *
+ * @param a_store Store directory.
+ */
+void casper::proxy::worker::fs::Sweeper::Watch (const std::string& a_store)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if ( stores_.end() == stores_.find(a_store) ) {
+        stores_.insert(a_store);
+        Start();
+    }
+}
+
+/**
+ * @return What was reclaimed so far.
+ */
+casper::proxy::worker::fs::Sweeper::Stats casper::proxy::worker::fs::Sweeper::stats ()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+/**
+ * @brief Start thread, if not started yet, ⚠️ mutex_ must be locked.
+ */
+void casper::proxy::worker::fs::Sweeper::Start ()
+{
+    if ( false == thread_.joinable() && false == stop_ ) {
+        thread_ = std::thread(&casper::proxy::worker::fs::Sweeper::Loop, this);
+    }
+}
+
+/**
+ * @brief Thread loop.
+ */
+void casper::proxy::worker::fs::Sweeper::Loop ()
+{
+#ifdef __linux__
+    // ... best effort: this thread only, as low priority as possible ...
+    (void)setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);
+#endif
+    std::unique_lock<std::mutex> lock(mutex_);
+    while ( false == stop_ ) {
+        const std::map<std::string, int64_t> roots  = roots_;
+        const std::set<std::string>          stores = stores_;
+        // ... sweep without holding the lock, new files are never written to expired buckets ...
+        lock.unlock();
+        Stats stats = { /* buckets_ */ 0, /* files_ */ 0, /* bytes_ */ 0 };
+        for ( const auto& root : roots ) {
+            Sweep(root.first, stats);
+        }
+        for ( const auto& store : stores ) {
+            casper::proxy::worker::fs::Store::Prune(store, stats.files_, stats.bytes_);
+        }
+        lock.lock();
+        stats_.buckets_ += stats.buckets_;
+        stats_.files_   += stats.files_;
+        stats_.bytes_   += stats.bytes_;
+        condition_.wait_for(lock, std::chrono::seconds(static_cast<int64_t>(sk_interval_)), [this] { return stop_; });
+    }
+}
+
+/**
+ * @brief Remove all expired buckets of a root directory.
+ *
+ * @param a_root  Buckets root directory.
+ * @param o_stats Updated with what was reclaimed.
+ */
+void casper::proxy::worker::fs::Sweeper::Sweep (const std::string& a_root, casper::proxy::worker::fs::Sweeper::Stats& o_stats)
+{
+    DIR* root = opendir(a_root.c_str());
+    if ( nullptr == root ) {
+        return;
+    }
+    const int64_t            now = static_cast<int64_t>(time(nullptr));
+    std::vector<std::string> expired;
+    struct dirent*           entry;
+    while ( nullptr != ( entry = readdir(root) ) ) {
+        // ... '<epoch>' bucket, or '.<epoch>' if a previous removal was interrupted ...
+        const char* const name   = ( '.' == entry->d_name[0] ? entry->d_name + 1 : entry->d_name );
+        char*             end    = nullptr;
+        const long long   bucket = strtoll(name, &end, 10);
+        if ( end == name || '\0' != *end ) {
+            continue;
+        }
+        if ( '.' == entry->d_name[0] ) {
+            expired.push_back(entry->d_name);
+        } else if ( static_cast<int64_t>(bucket) <= now ) {
+            // ... out of the way, so it's no longer visible as a bucket ...
+            if ( 0 == rename((a_root + entry->d_name).c_str(), (a_root + '.' + entry->d_name).c_str()) ) {
+                expired.push_back(std::string(".") + entry->d_name);
+            }
+        }
+    }
+    closedir(root);
+    for ( const auto& name : expired ) {
+        Remove(a_root + name, o_stats);
+        o_stats.buckets_ += 1;
+    }
+}
+
+/**
+ * @brief Remove a directory and all it's contents.
+ *
+ * @param a_dir   Directory URI.
+ * @param o_stats Updated with what was reclaimed.
+ */
+void casper::proxy::worker::fs::Sweeper::Remove (const std::string& a_dir, casper::proxy::worker::fs::Sweeper::Stats& o_stats)
+{
+    DIR* dir = opendir(a_dir.c_str());
+    if ( nullptr == dir ) {
+        return;
+    }
+    struct dirent* entry;
+    while ( nullptr != ( entry = readdir(dir) ) ) {
+        if ( 0 == strcmp(entry->d_name, ".") || 0 == strcmp(entry->d_name, "..") ) {
+            continue;
+        }
+        const std::string uri = a_dir + '/' + entry->d_name;
+        struct stat st;
+        if ( 0 != lstat(uri.c_str(), &st) ) {
+            continue;
+        }
+        if ( 0 != S_ISDIR(st.st_mode) ) {
+            Remove(uri, o_stats);
+        } else if ( 0 == unlink(uri.c_str()) ) {
+            o_stats.files_ += 1;
+            // ... data is only reclaimed when it's last link is removed ...
+            if ( 1 == st.st_nlink ) {
+                o_stats.bytes_ += static_cast<uint64_t>(st.st_size);
+            }
+        }
+    }
+    closedir(dir);
+    (void)rmdir(a_dir.c_str());
+}
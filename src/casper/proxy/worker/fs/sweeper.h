@@ -0,0 +1,145 @@
+/**
+ * @file sweeper.h
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#ifndef CASPER_PROXY_WORKER_FS_SWEEPER_H_
+#define CASPER_PROXY_WORKER_FS_SWEEPER_H_
+
+#include "cc/non-movable.h"
+
+#include <string>
+#include <map>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include <stdint.h>
+
+namespace casper
+{
+
+    namespace proxy
+    {
+
+        namespace worker
+        {
+
+            namespace fs
+            {
+
+                //
+                // Process wide, low priority, reclaimer of expired tmp output files:
+                //
+                // - files are laid out in '<prefix>/expires/<epoch>/' directories, where epoch is the end of the time bucket in
+                //   which they expire, so each directory only holds files that expire at or before it's name;
+                // - expired directories are renamed out of the way ( one operation, no matter how many files ) and removed as a whole,
+                //   files are never checked one by one;
+                // - content addressed stores are pruned of objects no longer linked by any file, see \link Store \link;
+                // - thread is only started on first use.
+                //
+                class Sweeper final : public ::cc::NonMovable
+                {
+
+                public: // Data Type(s)
+
+                    typedef struct {
+                        uint64_t buckets_; //!< number of removed directories
+                        uint64_t files_;   //!< number of removed files
+                        uint64_t bytes_;   //!< number of reclaimed bytes, files still linked elsewhere are not accounted
+                    } Stats;
+
+                public: // Static Const Data
+
+                    constexpr static const int64_t sk_interval_ = 30;  //!< seconds between sweeps
+                    constexpr static const int64_t sk_margin_   = 300; //!< seconds, added to every bucket grace period ( queueing, retries, post-processing )
+
+                private: // Data
+
+                    std::mutex                         mutex_;
+                    std::condition_variable            condition_;
+                    std::map<std::string, int64_t>     roots_;  //!< buckets root directories, and last bucket created in each one
+                    std::set<std::string>              stores_; //!< content addressed stores to prune
+                    std::thread                        thread_; //!< started on demand
+                    bool                               stop_;   //!< true when shutting down
+                    Stats                              stats_;
+
+                private: // Constructor(s) / Destructor
+
+                    Sweeper ();
+                    virtual ~Sweeper ();
+
+                public: // Constructor(s) / Destructor
+
+                    Sweeper (const Sweeper&) = delete;
+
+                public: // Overloaded Operator(s)
+
+                    void operator = (Sweeper const&) = delete;  // assignment is not allowed
+
+                public: // Method(s) / Function(s)
+
+                    std::string Dir   (const std::string& a_prefix, const int64_t a_validity, const int64_t a_bucket, const int64_t a_grace);
+                    void        Watch (const std::string& a_store);
+                    Stats       stats ();
+
+                private: // Method(s) / Function(s)
+
+                    void Start ();
+                    void Loop  ();
+                    void Sweep (const std::string& a_root, Stats& o_stats);
+
+                private: // Static Method(s) / Function(s)
+
+                    static void Remove (const std::string& a_dir, Stats& o_stats);
+
+                public: // Static Method(s) / Function(s)
+
+                    /**
+                     * @param a_connection Request connection timeout, in seconds, <= 0 if not set.
+                     * @param a_operation  Request operation timeout, in seconds, <= 0 if not set.
+                     *
+                     * @return Grace period, in seconds, for files written by a request with the provided timeouts.
+                     */
+                    static int64_t Grace (const long a_connection, const long a_operation)
+                    {
+                        return ( a_connection > 0 ? static_cast<int64_t>(a_connection) : 0 ) + ( a_operation > 0 ? static_cast<int64_t>(a_operation) : 0 );
+                    }
+
+                    /**
+                     * @return Process wide instance.
+                     */
+                    static Sweeper& GetInstance ()
+                    {
+                        static Sweeper instance;
+                        return instance;
+                    }
+
+                }; // end of class 'Sweeper'
+
+            } // end of namespace 'fs'
+
+        } // end of namespace 'worker'
+
+    } // end of namespace 'proxy'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_PROXY_WORKER_FS_SWEEPER_H_
@@ -0,0 +1,359 @@
+/**
+ * @file writer.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/proxy/worker/fs/writer.h"
+
+#include "cc/exception.h"
+#include "cc/types.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h> // memcpy, strerror
+#include <unistd.h>
+
+#ifdef CASPER_PROXY_WORKER_WITH_IO_URING
+    #include <liburing.h>
+#endif
+
+#ifdef CASPER_PROXY_WORKER_WITH_IO_URING
+
+namespace casper
+{
+
+    namespace proxy
+    {
+
+        namespace worker
+        {
+
+            namespace fs
+            {
+
+                //
+                // One ring per thread, created on first use.
+                //
+                class Ring final : public ::cc::NonMovable
+                {
+
+                private: // Data
+
+                    struct io_uring ring_;
+                    bool            ready_;
+
+                public: // Constructor(s) / Destructor
+
+                    Ring ()
+                    {
+                        ready_ = ( 0 == io_uring_queue_init(static_cast<unsigned>(2 * Writer::sk_max_buffers_), &ring_, 0) );
+                    }
+
+                    virtual ~Ring ()
+                    {
+                        if ( true == ready_ ) {
+                            io_uring_queue_exit(&ring_);
+                        }
+                    }
+
+                public: // Static Method(s) / Function(s)
+
+                    /**
+                     * @return This thread ring, nullptr if io_uring is not available.
+                     */
+                    static struct io_uring* Get ()
+                    {
+                        thread_local Ring instance;
+                        return ( true == instance.ready_ ? &instance.ring_ : nullptr );
+                    }
+
+                }; // end of class 'Ring'
+
+            } // end of namespace 'fs'
+
+        } // end of namespace 'worker'
+
+    } // end of namespace 'proxy'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_PROXY_WORKER_WITH_IO_URING
+
+/**
+ * @brief Default constructor, opens ( truncating ) file.
+ *
+ * @param a_uri     Local file URI.
+ * @param a_reserve Number of bytes to reserve, 0 if unknown.
+ */
+casper::proxy::worker::fs::Writer::Writer (const std::string& a_uri, const size_t a_reserve)
+    : uri_(a_uri),
+      fd_(-1), offset_(0), reserved_(0), async_(false), current_(0), pending_(0), error_(0), extent_(0)
+{
+    fd_ = open(uri_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if ( -1 == fd_ ) {
+        throw ::cc::Exception("Unable to open file '%s': %s!", uri_.c_str(), strerror(errno));
+    }
+#ifdef __linux__
+    // ... best effort: reserve space, keeping file contiguous and failing early on full disks ...
+    if ( a_reserve > 0 ) {
+        if ( 0 == fallocate(fd_, 0, 0, static_cast<off_t>(a_reserve)) ) {
+            reserved_ = a_reserve;
+        } else if ( ENOSPC == errno ) {
+            const int error = errno;
+            close(fd_);
+            fd_ = -1;
+            throw ::cc::Exception("Unable to reserve " SIZET_FMT " byte(s) for file '%s': %s!", a_reserve, uri_.c_str(), strerror(error));
+        }
+    }
+#else
+    (void)a_reserve;
+#endif
+#ifdef CASPER_PROXY_WORKER_WITH_IO_URING
+    if ( nullptr != casper::proxy::worker::fs::Ring::Get() ) {
+        async_ = true;
+        buffers_.resize(sk_max_buffers_);
+        for ( auto& buffer : buffers_ ) {
+            buffer.length_  = 0;
+            buffer.offset_  = 0;
+            buffer.pending_ = false;
+        }
+    }
+#endif
+}
+
+/**
+ * @brief Destructor, waits for queued writes and closes file ( if not closed yet ).
+ */
+casper::proxy::worker::fs::Writer::~Writer ()
+{
+    if ( -1 != fd_ ) {
+        // ... buffers must outlive queued writes ...
+        Reap(/* a_all */ true);
+        close(fd_);
+    }
+}
+
+/**
+ * @brief Append data to file.
+ *
+ * @param a_data   Data to write.
+ * @param a_length Data length, in bytes.
+ */
+void casper::proxy::worker::fs::Writer::Append (const unsigned char* a_data, size_t a_length)
+{
+    if ( -1 == fd_ ) {
+        throw ::cc::Exception("Unable to write to file '%s': already closed!", uri_.c_str());
+    }
+    // ... synchronous?
+    if ( false == async_ ) {
+        Write(a_data, a_length, offset_);
+        offset_ += static_cast<off_t>(a_length);
+        return;
+    }
+    // ... queued ...
+    while ( a_length > 0 ) {
+        Buffer& buffer = buffers_[current_];
+        // ... wait for buffer to be available ...
+        while ( true == buffer.pending_ ) {
+            Reap(/* a_all */ false);
+        }
+        if ( 0 != error_ ) {
+            throw ::cc::Exception("Unable to write to file '%s': %s!", uri_.c_str(), strerror(error_));
+        }
+        if ( 0 == buffer.data_.size() ) {
+            buffer.data_.resize(sk_buffer_size_);
+        }
+        const size_t length = ( a_length < sk_buffer_size_ - buffer.length_ ? a_length : sk_buffer_size_ - buffer.length_ );
+        memcpy(buffer.data_.data() + buffer.length_, a_data, length);
+        buffer.length_ += length;
+        a_data         += length;
+        a_length       -= length;
+        if ( sk_buffer_size_ == buffer.length_ ) {
+            Submit(buffer);
+            current_ = ( current_ + 1 ) % buffers_.size();
+        }
+    }
+}
+
+/**
+ * @brief Synchronously write data at a given position, ⚠️ not to be mixed with \link Append \link.
+ *
+ * @param a_data   Data to write.
+ * @param a_length Data length, in bytes.
+ * @param a_offset File offset.
+ */
+void casper::proxy::worker::fs::Writer::WriteAt (const unsigned char* a_data, size_t a_length, off_t a_offset)
+{
+    if ( -1 == fd_ ) {
+        throw ::cc::Exception("Unable to write to file '%s': already closed!", uri_.c_str());
+    }
+    Write(a_data, a_length, a_offset);
+    // ... keep track of the furthest byte written, so that reserved space is only given back beyond it ...
+    const off_t end = a_offset + static_cast<off_t>(a_length);
+    off_t       current = extent_.load();
+    while ( current < end && false == extent_.compare_exchange_weak(current, end) ) {
+        // ... retry ...
+    }
+}
+
+/**
+ * @brief Flush queued data and close file.
+ */
+void casper::proxy::worker::fs::Writer::Close ()
+{
+    if ( -1 == fd_ ) {
+        return;
+    }
+    if ( true == async_ ) {
+        if ( buffers_[current_].length_ > 0 && false == buffers_[current_].pending_ ) {
+            Submit(buffers_[current_]);
+        }
+        Reap(/* a_all */ true);
+    }
+    int error = error_;
+    // ... reserved more than written? give it back ...
+    if ( extent_.load() > offset_ ) {
+        offset_ = extent_.load();
+    }
+    if ( 0 == error && static_cast<off_t>(reserved_) > offset_ && 0 != ftruncate(fd_, offset_) ) {
+        error = errno;
+    }
+    if ( 0 != close(fd_) && 0 == error ) {
+        error = errno;
+    }
+    fd_ = -1;
+    if ( 0 != error ) {
+        throw ::cc::Exception("Unable to write to file '%s': %s!", uri_.c_str(), strerror(error));
+    }
+}
+
+/**
+ * @brief Queue a buffer write.
+ *
+ * @param a_buffer Buffer to write, must not be changed until it's reaped.
+ */
+void casper::proxy::worker::fs::Writer::Submit (casper::proxy::worker::fs::Writer::Buffer& a_buffer)
+{
+    a_buffer.offset_ = offset_;
+    offset_         += static_cast<off_t>(a_buffer.length_);
+#ifdef CASPER_PROXY_WORKER_WITH_IO_URING
+    struct io_uring* ring = casper::proxy::worker::fs::Ring::Get();
+    struct io_uring_sqe* sqe = io_uring_get_sqe(ring);
+    while ( nullptr == sqe ) {
+        Reap(/* a_all */ false);
+        sqe = io_uring_get_sqe(ring);
+    }
+    io_uring_prep_write(sqe, fd_, a_buffer.data_.data(), static_cast<unsigned>(a_buffer.length_), static_cast<uint64_t>(a_buffer.offset_));
+    io_uring_sqe_set_data(sqe, &a_buffer);
+    a_buffer.pending_ = true;
+    pending_++;
+    int rv;
+    do {
+        rv = io_uring_submit(ring);
+    } while ( -EINTR == rv );
+    if ( rv < 0 ) {
+        // ... not submitted: neutralize it, ring is shared by all writers of this thread, and write it now ...
+        io_uring_prep_nop(sqe);
+        io_uring_sqe_set_data(sqe, nullptr);
+        a_buffer.pending_ = false;
+        pending_--;
+        Write(a_buffer.data_.data(), a_buffer.length_, a_buffer.offset_);
+        a_buffer.length_ = 0;
+    }
+#else
+    Write(a_buffer.data_.data(), a_buffer.length_, a_buffer.offset_);
+    a_buffer.length_ = 0;
+#endif
+}
+
+/**
+ * @brief Wait for queued writes completion, ⚠️ errors are kept in error_, never thrown.
+ *
+ * @param a_all When true wait for all queued writes, otherwise wait for at least one.
+ */
+void casper::proxy::worker::fs::Writer::Reap (const bool a_all)
+{
+#ifdef CASPER_PROXY_WORKER_WITH_IO_URING
+    struct io_uring* ring = ( pending_ > 0 ? casper::proxy::worker::fs::Ring::Get() : nullptr );
+    while ( pending_ > 0 ) {
+        struct io_uring_cqe* cqe = nullptr;
+        const int rv = io_uring_wait_cqe(ring, &cqe);
+        if ( -EINTR == rv ) {
+            continue;
+        } else if ( rv < 0 || nullptr == cqe ) {
+            // ... unrecoverable, buffers can't be reused safely, stop using them ...
+            error_ = ( 0 != error_ ? error_ : -rv );
+            pending_ = 0;
+            for ( auto& buffer : buffers_ ) {
+                buffer.pending_ = false;
+                buffer.length_  = 0;
+            }
+            return;
+        }
+        Buffer* buffer = static_cast<Buffer*>(io_uring_cqe_get_data(cqe));
+        const int result = cqe->res;
+        io_uring_cqe_seen(ring, cqe);
+        // ... neutralized request, see \link Submit \link ...
+        if ( nullptr == buffer ) {
+            continue;
+        }
+        pending_--;
+        buffer->pending_ = false;
+        if ( result < 0 ) {
+            error_ = ( 0 != error_ ? error_ : -result );
+        } else if ( static_cast<size_t>(result) < buffer->length_ && 0 == error_ ) {
+            // ... short write, finish it now ...
+            try {
+                Write(buffer->data_.data() + result, buffer->length_ - static_cast<size_t>(result), buffer->offset_ + result);
+            } catch (...) {
+                error_ = EIO;
+            }
+        }
+        buffer->length_ = 0;
+        if ( false == a_all ) {
+            break;
+        }
+    }
+#else
+    (void)a_all;
+#endif
+}
+
+/**
+ * @brief Synchronously write data.
+ *
+ * @param a_data   Data to write.
+ * @param a_length Data length, in bytes.
+ * @param a_offset File offset.
+ */
+void casper::proxy::worker::fs::Writer::Write (const unsigned char* a_data, size_t a_length, off_t a_offset)
+{
+    while ( a_length > 0 ) {
+        const ssize_t written = pwrite(fd_, a_data, a_length, a_offset);
+        if ( written < 0 ) {
+            if ( EINTR == errno ) {
+                continue;
+            }
+            throw ::cc::Exception("Unable to write to file '%s': %s!", uri_.c_str(), strerror(errno));
+        }
+        a_data   += written;
+        a_length -= static_cast<size_t>(written);
+        a_offset += written;
+    }
+}
@@ -0,0 +1,120 @@
+/**
+ * @file writer.h
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#ifndef CASPER_PROXY_WORKER_FS_WRITER_H_
+#define CASPER_PROXY_WORKER_FS_WRITER_H_
+
+#include "cc/non-movable.h"
+
+#include <string>
+#include <vector>
+#include <atomic>
+
+#include <stddef.h>
+#include <sys/types.h> // off_t
+
+namespace casper
+{
+
+    namespace proxy
+    {
+
+        namespace worker
+        {
+
+            namespace fs
+            {
+
+                //
+                // Sequential file writer, meant to be used from \link executor::Pool \link threads:
+                //
+                // - space is reserved up front, when the final size is known;
+                // - with CASPER_PROXY_WORKER_WITH_IO_URING writes are queued to a per thread io_uring, so that producing
+                //   data ( e.g. compressing ) overlaps with disk I/O, otherwise, or if io_uring is not available, pwrite is used;
+                // - positional writes, from any number of threads, are also supported for files assembled out of order.
+                //
+                class Writer final : public ::cc::NonMovable
+                {
+
+                public: // Static Const Data
+
+                    constexpr static const size_t sk_buffer_size_ = 1024 * 1024;
+                    constexpr static const size_t sk_max_buffers_ = 4;
+
+                private: // Data Type(s)
+
+                    typedef struct {
+                        std::vector<unsigned char> data_;    //!< buffered data
+                        size_t                     length_;  //!< number of buffered bytes
+                        off_t                      offset_;  //!< file offset
+                        bool                       pending_; //!< true while queued
+                    } Buffer;
+
+                private: // Const Data
+
+                    const std::string   uri_;
+
+                private: // Data
+
+                    int                 fd_;        //!< file descriptor, -1 if closed
+                    off_t               offset_;    //!< next write offset
+                    size_t              reserved_;  //!< number of bytes reserved with fallocate
+                    bool                async_;     //!< true if io_uring is being used
+                    std::vector<Buffer> buffers_;   //!< io_uring buffers
+                    size_t              current_;   //!< buffer being filled
+                    size_t              pending_;   //!< number of queued writes
+                    int                 error_;     //!< first error reported by a queued write, 0 if none
+                    std::atomic<off_t>  extent_;    //!< end of the furthest positional write
+
+                public: // Constructor(s) / Destructor
+
+                    Writer () = delete;
+                    Writer (const std::string& a_uri, const size_t a_reserve);
+                    Writer (const Writer&) = delete;
+                    virtual ~Writer ();
+
+                public: // Overloaded Operator(s)
+
+                    void operator = (Writer const&) = delete;  // assignment is not allowed
+
+                public: // Method(s) / Function(s)
+
+                    void Append  (const unsigned char* a_data, size_t a_length);
+                    void WriteAt (const unsigned char* a_data, size_t a_length, off_t a_offset);
+                    void Close   ();
+
+                private: // Method(s) / Function(s)
+
+                    void Submit (Buffer& a_buffer);
+                    void Reap   (const bool a_all);
+                    void Write  (const unsigned char* a_data, size_t a_length, off_t a_offset);
+
+                }; // end of class 'Writer'
+
+            } // end of namespace 'fs'
+
+        } // end of namespace 'worker'
+
+    } // end of namespace 'proxy'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_PROXY_WORKER_FS_WRITER_H_
@@ -27,6 +27,9 @@
 #include "casper/proxy/worker/http/types.h"
 #include "casper/proxy/worker/http/deferred.h"
 
+#include "casper/proxy/worker/codec/compressor.h"
+#include "casper/proxy/worker/fs/sweeper.h"
+
 #include <string>
 #include <map>
 
@@ -62,6 +65,10 @@ namespace casper
                     static const char* const             sk_tube_;
                     static             const Json::Value sk_behaviour_;
 
+                private: // Data
+
+                    casper::proxy::worker::fs::Sweeper::Stats sweeper_stats_; //!< last logged reclaimed tmp files stats
+
                 public: // Constructor(s) / Destructor
                     
                     Client () = delete;
@@ -78,6 +85,11 @@ namespace casper
                     uint16_t OnDeferredRequestCompleted (const ::casper::job::deferrable::Deferred<worker::http::Arguments>* a_deferred, Json::Value& o_payload);
                     uint16_t OnDeferredRequestFailed    (const ::casper::job::deferrable::Deferred<worker::http::Arguments>* a_deferred, Json::Value& o_payload);
 
+                private: // Method(s) / Function(s) - Schedule Helper(s)
+
+                    casper::proxy::worker::codec::Compressor::Policy TranslatedBodyCompression (const Json::Value& a_object) const;
+                    std::string                                      OutputDir                 (const int64_t a_validity, const int64_t a_bucket, const int64_t a_grace);
+
                 }; // end of class 'Client'
                         
             } // end of namespace 'http'
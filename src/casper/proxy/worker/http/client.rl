@@ -25,6 +25,11 @@
 
 #include "version.h"
 
+#include "casper/proxy/worker/http/gateway.h"
+#include "casper/proxy/worker/codec/decompressor.h"
+#include "casper/proxy/worker/fs/reader.h"
+#include "casper/proxy/worker/executor/pool.h"
+
 #include "cc/ragel.h"
 
 #include "cc/pragmas.h"
@@ -32,7 +37,8 @@
 #include "cc/fs/dir.h"
 
 #include "cc/v8/exception.h"
-#include "cc/b64.h"
+
+#include <algorithm> // std::find_if
 
 #include "version.h"
 
@@ -46,7 +52,8 @@ const Json::Value casper::proxy::worker::http::Client::sk_behaviour_ = "default"
  * param a_config
  */
 casper::proxy::worker::http::Client::Client (const ev::Loggable::Data& a_loggable_data, const cc::easy::job::Job::Config& a_config)
-    : ClientBaseClass("HC", sk_tube_, a_loggable_data, a_config, /* a_sequentiable */ false)
+    : ClientBaseClass("HC", sk_tube_, a_loggable_data, a_config, /* a_sequentiable */ false),
+      sweeper_stats_({ /* buckets_ */ 0, /* files_ */ 0, /* bytes_ */ 0 })
 {
     /* empty */
 }
@@ -68,6 +75,30 @@ void casper::proxy::worker::http::Client::InnerSetup ()
     d_.dispatcher_                    = new casper::proxy::worker::http::Dispatcher(loggable_data_, CASPER_PROXY_WORKER_NAME "/" CASPER_PROXY_WORKER_VERSION CC_IF_DEBUG_CONSTRUCT_APPEND_PARAM_VALUE(thread_id_));
     d_.on_deferred_request_completed_ = std::bind(&casper::proxy::worker::http::Client::OnDeferredRequestCompleted, this, std::placeholders::_1, std::placeholders::_2);
     d_.on_deferred_request_failed_    = std::bind(&casper::proxy::worker::http::Client::OnDeferredRequestFailed   , this, std::placeholders::_1, std::placeholders::_2);
+    const ::cc::easy::JSON<::cc::InternalServerError> json;
+    // ... number of post-processing threads, process wide, first tube to setup wins ...
+    const Json::Value& executor_ref = json.Get(config_.other(), "executor", Json::ValueType::objectValue, &Json::Value::null);
+    if ( false == executor_ref.isNull() ) {
+        casper::proxy::worker::executor::Pool::GetInstance().Setup(static_cast<size_t>(json.Get(executor_ref, "threads", Json::ValueType::uintValue, &Json::Value::null).asUInt()));
+    }
+    // ... perform plain requests on dedicated I/O loops, instead of @ MAIN thread?
+    //
+    // "io": {
+    //     "loops": <number>,                  - number of loops, process wide, first tube to setup wins, 0 disables them
+    //     "affinity": "round-robin" | "host", - optional, default 'round-robin': requests, even to a single hot upstream, are spread over all loops;
+    //                                           'host' favours connection reuse, each host is assigned to 'spread' consecutive loops
+    //     "spread": <number>                  - optional, 'host' affinity only, default 2, 1 pins each host to a single loop
+    // }
+    //
+    const Json::Value& io_ref = json.Get(config_.other(), "io", Json::ValueType::objectValue, &Json::Value::null);
+    if ( false == io_ref.isNull() ) {
+        const Json::Value& affinity_ref = json.Get(io_ref, "affinity", Json::ValueType::stringValue, &Json::Value::null);
+        const Json::Value& spread_ref   = json.Get(io_ref, "spread", Json::ValueType::uintValue, &Json::Value::null);
+        casper::proxy::worker::http::Loops::GetInstance().Start(static_cast<size_t>(json.Get(io_ref, "loops", Json::ValueType::uintValue, &Json::Value::null).asUInt()),
+                                                                ( false == affinity_ref.isNull() && 0 == strcasecmp("host", affinity_ref.asCString()) ? casper::proxy::worker::http::Loops::Affinity::Host : casper::proxy::worker::http::Loops::Affinity::RoundRobin ),
+                                                                ( false == spread_ref.isNull() ? static_cast<size_t>(spread_ref.asUInt()) : 2 )
+        );
+    }
 }
 
 /**
@@ -115,7 +146,8 @@ void casper::proxy::worker::http::Client::InnerRun (const uint64_t& a_id, const
     http::Arguments arguments = http::Arguments(
         {
             /* a_data       */ http,
-            /* a_primitive  */ ( true == broker && 0 == strcasecmp("gateway", behaviour.asCString()) ),
+            /* a_primitive  */ ( true == broker && ( 0 == strcasecmp("gateway", behaviour.asCString()) || 0 == strcasecmp("gateway-v2", behaviour.asCString()) ) ),
+            /* a_gateway    */ ( 0 == strcasecmp("gateway-v2", behaviour.asCString()) ? casper::proxy::worker::http::Gateway::Format::V2 : casper::proxy::worker::http::Gateway::Format::V1 ),
             /* a_log_level  */ config_.log_level(),
             /* a_log_redact */ config_.log_redact()
         }
@@ -130,6 +162,7 @@ void casper::proxy::worker::http::Client::InnerRun (const uint64_t& a_id, const
         const Json::Value& params          = json.Get(http, "params"         , Json::ValueType::objectValue, &Json::Value::null);
         const Json::Value& body_data       = json.Get(http, "body"           , { Json::ValueType::objectValue, Json::ValueType::stringValue }, &Json::Value::null);
         const Json::Value& body_url        = json.Get(http, "body_url"       , Json::ValueType::stringValue, &Json::Value::null);
+        const Json::Value& body_file       = json.Get(http, "body_file"      , Json::ValueType::stringValue, &Json::Value::null);
         const Json::Value& headers         = json.Get(http, "headers"        , Json::ValueType::objectValue, nullptr);
         const Json::Value& follow_location = json.Get(http, "follow_location", Json::ValueType::booleanValue, &Json::Value::null);
 #ifdef CC_DEBUG_ON
@@ -183,10 +216,17 @@ void casper::proxy::worker::http::Client::InnerRun (const uint64_t& a_id, const
             ::cc::easy::http::Client::SetURLQuery(request.url_, map, request.url_);
         }
         // ... body ...
-        if ( false == body_data.isNull() && false == body_url.isNull() ) {
+        if ( ( false == body_data.isNull() ? 1 : 0 ) + ( false == body_url.isNull() ? 1 : 0 ) + ( false == body_file.isNull() ? 1 : 0 ) > 1 ) {
             throw ::cc::BadRequest("Multiple 'body' values provided, only one is supported!");
         }
-        if ( false == body_data.isNull() ) {
+        if ( false == body_file.isNull() || ( false == body_url.isNull() && 0 == strncasecmp(body_url.asCString(), "file://", 7) ) ) {
+            // ... local file, usually produced by another worker in the same tmp area: read it directly, as-is ...
+            // ... 'body_file' is always confined to tmp area, 'file://' 'body_url' only if configured so ( any readable file was accepted before ) ...
+            const Json::Value& tmp_ref  = json.Get(config_.other(), "tmp", Json::ValueType::objectValue, &Json::Value::null);
+            const bool         confined = ( false == body_file.isNull()
+                                           || ( false == tmp_ref.isNull() && true == json.Get(tmp_ref, "confine_file_urls", Json::ValueType::booleanValue, &Json::Value::null).asBool() ) );
+            casper::proxy::worker::fs::Reader::Load(( false == body_file.isNull() ? body_file.asString() : body_url.asString() ), ( true == confined ? output_dir_prefix() : "" ), request.body_);
+        } else if ( false == body_data.isNull() ) {
             const Json::Value& content_type = json.Get(headers, "Content-Type", Json::ValueType::stringValue, nullptr);
             if ( 0 == strncasecmp(content_type.asCString(), "application/json", sizeof(char) * 16) ) {
                 request.body_ = json.Write(body_data);
@@ -241,6 +281,23 @@ void casper::proxy::worker::http::Client::InnerRun (const uint64_t& a_id, const
             const Json::Value& header = json.Get(headers, key.c_str(), Json::ValueType::stringValue, nullptr);
             request.headers_[key] = { header.asString() };
         }
+        // ... negotiate upstream compression? body will only be decoded when needed ...
+        const Json::Value& accept_encoding = json.Get(http, "accept_encoding", Json::ValueType::booleanValue, &Json::Value::null);
+        if ( false == accept_encoding.isNull() && true == accept_encoding.asBool() ) {
+            // ... unless it was explicitly set, it's body will be delivered as received ...
+            if ( request.headers_.end() == std::find_if(request.headers_.begin(), request.headers_.end(), ::cc::easy::http::Client::HeaderMapKeyComparator("Accept-Encoding")) ) {
+                request.headers_["Accept-Encoding"] = { casper::proxy::worker::codec::Decompressor::sk_accept_encoding_ };
+                arguments.parameters().accept_encoding(true);
+            }
+        }
+        // ... compress body?
+        const Json::Value& body_compression = json.Get(http, "body_compression", Json::ValueType::objectValue, &Json::Value::null);
+        if ( false == body_compression.isNull() && request.headers_.end() == std::find_if(request.headers_.begin(), request.headers_.end(), ::cc::easy::http::Client::HeaderMapKeyComparator("Content-Encoding")) ) {
+            const casper::proxy::worker::codec::Compressor::Policy policy = TranslatedBodyCompression(body_compression);
+            if ( true == casper::proxy::worker::codec::Compressor::Compress(policy, request.body_) ) {
+                request.headers_["Content-Encoding"] = { casper::proxy::worker::codec::Compressor::Encoding(policy.codec_) };
+            }
+        }
         // ... follow location?
         if ( false == follow_location.isNull() ) {
             request.follow_location_ = follow_location.asBool();
@@ -262,6 +319,8 @@ void casper::proxy::worker::http::Client::InnerRun (const uint64_t& a_id, const
         }
 #endif
     });
+    // ... tmp files must outlive the request that will write them ...
+    const int64_t grace = casper::proxy::worker::fs::Sweeper::Grace(arguments.parameters().http_request().timeouts_.connection_, arguments.parameters().http_request().timeouts_.operation_);
     //
     // RESPONSE config
     //
@@ -281,7 +340,7 @@ void casper::proxy::worker::http::Client::InnerRun (const uint64_t& a_id, const
                     response.validity_ = static_cast<int64_t>(json.Get(tmp_ref, "validity", Json::ValueType::uintValue, &Json::Value::null).asUInt());
                 }
                 // ... make unique file ...
-                ::cc::fs::File::Unique(EnsureOutputDir(response.validity_), /* name */ "", "ohc", response.uri_);
+                ::cc::fs::File::Unique(OutputDir(response.validity_, static_cast<int64_t>(json.Get(tmp_ref, "bucket", Json::ValueType::uintValue, &Json::Value::null).asUInt()), grace), /* name */ "", "ohc", response.uri_);
                 // ... set URL ...
                 const Json::Value& local_ref = json.Get(response_ref, "local", Json::ValueType::booleanValue, &Json::Value::null);
                 if ( true == local_ref.isNull() || true == local_ref.asBool() ) {
@@ -293,14 +352,94 @@ void casper::proxy::worker::http::Client::InnerRun (const uint64_t& a_id, const
                     }
                     response.url_ += std::string(response.uri_.c_str() + output_dir_prefix().length());
                 }
+                // ... store identical files once?
+                if ( true == json.Get(tmp_ref, "dedupe", Json::ValueType::booleanValue, &Json::Value::null).asBool() ) {
+                    response.store_ = ::cc::fs::Dir::Normalize(output_dir_prefix()) + "cas/";
+                    proxy::worker::fs::Sweeper::GetInstance().Watch(response.store_);
+                }
             }
             // ... base64?
             const Json::Value& base64_ref = json.Get(response_ref, "base64", Json::ValueType::booleanValue, &Json::Value::null);
             if ( false == base64_ref.isNull() ) {
                 response.base64_ = base64_ref.asBool();
             }
+            // ... download file in concurrent ranges?
+            const Json::Value& ranged_ref = json.Get(response_ref, "ranged", Json::ValueType::objectValue, &Json::Value::null);
+            if ( false == ranged_ref.isNull() ) {
+                // ... only a file written as received can be assembled out of order ...
+                if ( 0 == response.uri_.length() || true == response.base64_ || true == arguments.parameters().accept_encoding()
+                    || ::cc::easy::http::Client::Method::GET != arguments.parameters().http_request().method_ ) {
+                    throw ::cc::BadRequest("'ranged' download requires a GET request 'to_file', without 'base64' or 'accept_encoding'!");
+                }
+                const Json::Value& connections_ref = json.Get(ranged_ref, "connections", Json::ValueType::uintValue, nullptr);
+                response.connections_ = static_cast<uint8_t>(std::max(static_cast<Json::UInt64>(1),
+                                                                      std::min(static_cast<Json::UInt64>(casper::proxy::worker::http::Deferred::sk_max_range_connections_), connections_ref.asUInt64()))
+                );
+                const Json::Value& range_size_ref = json.Get(ranged_ref, "range_size", Json::ValueType::uintValue, &Json::Value::null);
+                response.range_size_ = ( false == range_size_ref.isNull() && range_size_ref.asUInt64() > 0 ? static_cast<uint64_t>(range_size_ref.asUInt64())
+                                                                                                            : casper::proxy::worker::http::Deferred::sk_range_size_ );
+            }
         });
     }
+    //
+    // REUSE config
+    //
+    // ... an unexpired download of the same resource should be revalidated instead of downloaded again?
+    if ( true == arguments.parameters().IsCustomHTTPResponseSet() && 0 != arguments.parameters().http_response().uri_.length()
+        && ::cc::easy::http::Client::Method::GET == arguments.parameters().http_request().method_ ) {
+        const Json::Value& tmp_ref   = json.Get(config_.other(), "tmp", Json::ValueType::objectValue, nullptr);
+        const Json::Value& reuse_ref = json.Get(response_ref, "reuse", Json::ValueType::booleanValue, &Json::Value::null);
+        if ( true == ( false == reuse_ref.isNull() ? reuse_ref : json.Get(tmp_ref, "reuse", Json::ValueType::booleanValue, &Json::Value::null) ).asBool() ) {
+            (void)arguments.parameters().http_request([&arguments](proxy::worker::http::Parameters::HTTPRequest& request) {
+                (void)arguments.parameters().http_response([&request](proxy::worker::http::Parameters::HTTPResponse& response) {
+                    response.key_ = casper::proxy::worker::http::Index::Key(request.method_, request.url_, request.headers_, response.base64_);
+                    // ... unless caller is already revalidating it ...
+                    if ( request.headers_.end() != std::find_if(request.headers_.begin(), request.headers_.end(), ::cc::easy::http::Client::HeaderMapKeyComparator("If-None-Match"))
+                        || request.headers_.end() != std::find_if(request.headers_.begin(), request.headers_.end(), ::cc::easy::http::Client::HeaderMapKeyComparator("If-Modified-Since"))
+                        || false == casper::proxy::worker::http::Index::GetInstance().Find(response.key_, response.cached_) ) {
+                        return;
+                    }
+                    if ( 0 != response.cached_.etag_.length() ) {
+                        request.headers_["If-None-Match"] = { response.cached_.etag_ };
+                    }
+                    if ( 0 != response.cached_.last_modified_.length() ) {
+                        request.headers_["If-Modified-Since"] = { response.cached_.last_modified_ };
+                    }
+                });
+            });
+        }
+    }
+    //
+    // SPILL config
+    //
+    // ... binary gateway frames are written to file, see \link Gateway \link ...
+    if ( true == arguments.parameters().primitive_ && casper::proxy::worker::http::Gateway::Format::V2 == arguments.parameters().gateway_ ) {
+        const Json::Value& tmp_ref = json.Get(config_.other(), "tmp", Json::ValueType::objectValue, nullptr);
+        (void)arguments.parameters().spill([&](proxy::worker::fs::Spill::Config& spill) {
+            spill.dir_      = OutputDir(static_cast<int64_t>(json.Get(tmp_ref, "validity", Json::ValueType::uintValue, &Json::Value::null).asUInt()),
+                                        static_cast<int64_t>(json.Get(tmp_ref, "bucket", Json::ValueType::uintValue, &Json::Value::null).asUInt()), grace);
+            spill.prefix_   = output_dir_prefix();
+            spill.base_url_ = json.Get(tmp_ref, "base_url", Json::ValueType::stringValue, &Json::Value::null).asString();
+        });
+    }
+    // ... oversized bodies, not written to file by request, should be written to file anyway?
+    if ( false == arguments.parameters().primitive_ && not ( true == arguments.parameters().IsCustomHTTPResponseSet() && 0 != arguments.parameters().http_response().uri_.length() ) ) {
+        const Json::Value& tmp_ref       = json.Get(config_.other(), "tmp", Json::ValueType::objectValue, &Json::Value::null);
+        const Json::Value& threshold_ref = ( true == tmp_ref.isNull() ? Json::Value::null : json.Get(tmp_ref, "spill_threshold", Json::ValueType::uintValue, &Json::Value::null) );
+        if ( false == threshold_ref.isNull() && threshold_ref.asUInt64() > 0 ) {
+            (void)arguments.parameters().spill([&](proxy::worker::fs::Spill::Config& spill) {
+                spill.threshold_ = static_cast<size_t>(threshold_ref.asUInt64());
+                spill.dir_       = OutputDir(static_cast<int64_t>(json.Get(tmp_ref, "validity", Json::ValueType::uintValue, &Json::Value::null).asUInt()),
+                                             static_cast<int64_t>(json.Get(tmp_ref, "bucket", Json::ValueType::uintValue, &Json::Value::null).asUInt()), grace);
+                spill.prefix_    = output_dir_prefix();
+                spill.base_url_  = json.Get(tmp_ref, "base_url", Json::ValueType::stringValue, &Json::Value::null).asString();
+                spill.store_     = ( true == json.Get(tmp_ref, "dedupe", Json::ValueType::booleanValue, &Json::Value::null).asBool() ? ::cc::fs::Dir::Normalize(output_dir_prefix()) + "cas/" : "" );
+                if ( 0 != spill.store_.length() ) {
+                    proxy::worker::fs::Sweeper::GetInstance().Watch(spill.store_);
+                }
+            });
+        }
+    }
     // ... schedule deferred HTTP request ...
     dynamic_cast<http::Dispatcher*>(d_.dispatcher_)->Push(tracking, arguments);
     // ... publish progress ...
@@ -313,6 +452,61 @@ void casper::proxy::worker::http::Client::InnerRun (const uint64_t& a_id, const
     SetDeferred();
 }
 
+// MARK: - Method(s) / Function(s) - Schedule Helper(s)
+
+/**
+ * @brief Translate a request body compression policy.
+ *
+ * @param a_object JSON object: { "codec": <string>, "level": <integer>, "threshold": <unsigned integer> }.
+ *
+ * @return Request body compression policy, see \link codec::Compressor::Policy \link.
+ */
+casper::proxy::worker::codec::Compressor::Policy casper::proxy::worker::http::Client::TranslatedBodyCompression (const Json::Value& a_object) const
+{
+    const ::cc::easy::JSON<::cc::BadRequest> json;
+    casper::proxy::worker::codec::Compressor::Policy policy = {
+        /* codec_     */ casper::proxy::worker::codec::Compressor::Translated(json.Get(a_object, "codec", Json::ValueType::stringValue, nullptr).asString()),
+        /* level_     */ -1,
+        /* threshold_ */ 0
+    };
+    const Json::Value& level = json.Get(a_object, "level", Json::ValueType::intValue, &Json::Value::null);
+    if ( false == level.isNull() ) {
+        casper::proxy::worker::codec::Compressor::ValidateLevel(policy.codec_, level.asInt());
+        policy.level_ = static_cast<int8_t>(level.asInt());
+    }
+    const Json::Value& threshold = json.Get(a_object, "threshold", Json::ValueType::uintValue, &Json::Value::null);
+    if ( false == threshold.isNull() ) {
+        policy.threshold_ = static_cast<size_t>(threshold.asUInt64());
+    }
+    return policy;
+}
+
+/**
+ * @brief Obtain ( creating it if needed ) the directory where tmp files should be written.
+ *
+ * @param a_validity Files validity, in seconds.
+ * @param a_bucket   Time bucket size, in seconds, 0 to keep files where \link EnsureOutputDir \link places them.
+ * @param a_grace    Grace period, in seconds, see \link fs::Sweeper::Dir \link.
+ *
+ * @return Directory URI.
+ */
+std::string casper::proxy::worker::http::Client::OutputDir (const int64_t a_validity, const int64_t a_bucket, const int64_t a_grace)
+{
+    if ( a_bucket <= 0 ) {
+        return EnsureOutputDir(a_validity);
+    }
+    auto& sweeper = casper::proxy::worker::fs::Sweeper::GetInstance();
+    // ... report what was reclaimed since last time ( if anything ) ...
+    const casper::proxy::worker::fs::Sweeper::Stats stats = sweeper.stats();
+    if ( stats.files_ != sweeper_stats_.files_ || stats.buckets_ != sweeper_stats_.buckets_ ) {
+        LogMessage(CC_JOB_LOG_LEVEL_INF, CC_JOB_LOG_STEP_INFO,
+                   "TMP sweeper: reclaimed " + std::to_string(stats.bytes_) + " byte(s), " + std::to_string(stats.files_) + " file(s), " + std::to_string(stats.buckets_) + " bucket(s)"
+        );
+        sweeper_stats_ = stats;
+    }
+    return sweeper.Dir(output_dir_prefix(), a_validity, a_bucket, a_grace);
+}
+
 // MARK: - Method(s) / Function(s) - deferrable::Dispatcher Callbacks
 
 /**
@@ -327,77 +521,13 @@ void casper::proxy::worker::http::Client::InnerRun (const uint64_t& a_id, const
  */
 uint16_t casper::proxy::worker::http::Client::OnDeferredRequestCompleted (const ::casper::job::deferrable::Deferred<casper::proxy::worker::http::Arguments>* a_deferred, Json::Value& o_payload)
 {
-    const auto&    params   = a_deferred->arguments().parameters();
-    const auto     response = a_deferred->response();
-    const uint16_t code     = response.code();
-    // ... set payload ...
-    o_payload = Json::Value(Json::ValueType::objectValue);
-    // ... primitive or default?
-    if ( true == params.primitive_ ) {
-        // ... gateway response mode ....
-        // !<status-code-int-value>,<content-type-length-in-bytes>,<content-type-string-value>,<headers-length-bytes>,<headers>,<body-length-bytes>,<body>
-        std::stringstream ss;
-        ss << '!' << response.code() << ',' << response.content_type().length() << ',' << response.content_type();
-        ss << ',' << response.body().length() << ',' << response.body();
-        {
-            std::string v = "";
-            for ( auto header : a_deferred->response().headers() ) {
-                v = header.first + ":" + header.second;
-                ss << ',' << v.length() << ',' << v;
-            }
-        }
-        // ... data ...
-        o_payload["data"] = ss.str();
+    auto           deferred = const_cast<casper::proxy::worker::http::Deferred*>(static_cast<const casper::proxy::worker::http::Deferred*>(a_deferred));
+    const uint16_t code     = deferred->response().code();
+    // ... payload already built ( off the looper thread ) by deferred request?
+    if ( true == deferred->prepared() ) {
+        deferred->TakePayload(o_payload);
     } else {
-        // ...
-        if ( 200 == response.code()
-                && true == a_deferred->arguments().parameters().IsCustomHTTPResponseSet()
-        ) {            
-            const unsigned char* const data = reinterpret_cast<const unsigned char*>(response.body().c_str());
-            const size_t               size = response.body().size();
-            // ... to file?
-            if ( 0 != a_deferred->arguments().parameters().http_response().uri_.length() ) {
-                // ... yes ...
-                ::cc::fs::File file;
-                file.Open(a_deferred->arguments().parameters().http_response().uri_, ::cc::fs::File::Mode::Write);
-                // ... base64 it?
-                if ( true == a_deferred->arguments().parameters().http_response().base64_ ) {
-                    const auto b64 = ::cc::base64_rfc4648::encode(data, size);
-                    file.Write(b64.c_str(), b64.length());
-                } else {
-                    file.Write(data, size);
-                }
-                file.Close();
-                const char* const dst = a_deferred->arguments().parameters().http_response().url_.c_str();
-                if ( nullptr != strcasestr(dst, "file://") ) {
-                    o_payload["uri"] = dst;
-                } else {
-                    o_payload["url"] = dst;
-                }
-            } else {
-                // ... no ...
-                if ( true == a_deferred->arguments().parameters().http_response().base64_ ) {
-                    o_payload["body"] =::cc::base64_rfc4648::encode(data, size);
-                } else {
-                    o_payload["body"] = response.body();
-                }
-            }
-        } else {
-            // ... body ...
-            if ( true == ::cc::easy::JSON<::cc::Exception>::IsJSON(response.content_type()) ) {
-                const ::cc::easy::JSON<::cc::Exception> json;
-                json.Parse(response.body(), o_payload["body"]);
-            } else {
-                o_payload["body"] = response.body();
-            }
-            // ... headers ...
-            o_payload["headers"] = Json::Value(Json::ValueType::objectValue);
-            for ( auto header : response.headers() ) {
-                o_payload["headers"][header.first] = header.second;
-            }
-            // ... code ...
-            o_payload["code"] = response.code();
-        }
+        casper::proxy::worker::http::Deferred::BuildPayload(deferred->arguments().parameters(), deferred->response(), o_payload, deferred->written());
     }
     // ... done ...
     return code;
@@ -415,49 +545,13 @@ uint16_t casper::proxy::worker::http::Client::OnDeferredRequestCompleted (const
  */
 uint16_t casper::proxy::worker::http::Client::OnDeferredRequestFailed (const ::casper::job::deferrable::Deferred<casper::proxy::worker::http::Arguments>* a_deferred, Json::Value& o_payload)
 {
-    const auto&    params   = a_deferred->arguments().parameters();
-    const auto     response = a_deferred->response();
-    const uint16_t code     = response.code();
-    // ... set payload ...
-    o_payload = Json::Value(Json::ValueType::objectValue);
-    // ... primitive or default?
-    if ( true == params.primitive_ ) {
-        // ... gateway response mode ....
-        // !<status-code-int-value>,<content-type-length-in-bytes>,<content-type-string-value>,<headers-length-bytes>,<headers>,<body-length-bytes>,<body>
-        std::stringstream ss;
-        ss << '!' << response.code() << ',' << response.content_type().length() << ',' << response.content_type();
-        // ... body ...
-        const auto exception = a_deferred->response().exception();
-        if ( nullptr != exception ) {
-            ss << ',' << strlen(exception->what()) << ',' << exception->what();
-        } else {
-            ss << ',' << response.body().length() << ',' << response.body();
-        }
-        // ... headers ...
-        {
-            std::string v = "";
-            for ( auto header : a_deferred->response().headers() ) {
-                v = header.first + ":" + header.second;
-                ss << ',' << v.length() << ',' << v;
-            }
-        }
-        // ... data ...
-        o_payload["data"] = ss.str();
+    auto           deferred = const_cast<casper::proxy::worker::http::Deferred*>(static_cast<const casper::proxy::worker::http::Deferred*>(a_deferred));
+    const uint16_t code     = deferred->response().code();
+    // ... payload already built ( off the looper thread ) by deferred request?
+    if ( true == deferred->prepared() ) {
+        deferred->TakePayload(o_payload);
     } else {
-        // ... body ...
-        if ( true == ::cc::easy::JSON<::cc::Exception>::IsJSON(response.content_type()) ) {
-            const ::cc::easy::JSON<::cc::Exception> json;
-            json.Parse(response.body(), o_payload["body"]);
-        } else {
-            o_payload["body"] = response.body();
-        }
-        // ... headers ...
-        o_payload["headers"] = Json::Value(Json::ValueType::objectValue);
-        for ( auto header : response.headers() ) {
-            o_payload["headers"][header.first] = header.second;
-        }
-        // ... code ...
-        o_payload["code"] = response.code();
+        casper::proxy::worker::http::Deferred::BuildPayload(deferred->arguments().parameters(), deferred->response(), o_payload, deferred->written());
     }
     // ... done ...
     return code;
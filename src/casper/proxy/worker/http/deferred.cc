@@ -23,6 +23,25 @@
 
 #include "cc/easy/job/types.h"
 
+#include "casper/proxy/worker/executor/pool.h"
+#include "casper/proxy/worker/fs/writer.h"
+#include "casper/proxy/worker/fs/store.h"
+#include "casper/proxy/worker/fs/spill.h"
+#include "casper/proxy/worker/codec/base64.h"
+#include "casper/proxy/worker/codec/json.h"
+#include "casper/proxy/worker/codec/decompressor.h"
+#include "casper/proxy/worker/http/gateway.h"
+
+#include "cc/easy/json.h"
+
+#include <algorithm> // std::min
+#include <memory>    // std::shared_ptr
+
+#include <stdlib.h> // strtoull
+#include <string.h> // strlen, strcasestr
+#include <unistd.h> // link, unlink
+#include <stdio.h>  // rename
+
 /**
  * @brief Default constructor.
  *
@@ -33,7 +52,8 @@ casper::proxy::worker::http::Deferred::Deferred (const casper::job::deferrable::
                                                  CC_IF_DEBUG_CONSTRUCT_APPEND_VAR(const cc::debug::Threading::ThreadID, a_thread_id))
 : ::casper::job::deferrable::Deferred<casper::proxy::worker::http::Arguments>(MakeID(a_tracking), a_tracking CC_IF_DEBUG_CONSTRUCT_APPEND_PARAM_VALUE(a_thread_id)),
     loggable_data_(a_loggable_data),
-    http_(nullptr)
+    http_(nullptr),
+    processed_(false), prepared_(false), ranged_(nullptr), written_(false), revalidate_(false)
 {
     http_options_ = HTTPOptions::Trace | HTTPOptions::Redact;
 }
@@ -46,6 +66,15 @@ casper::proxy::worker::http::Deferred::~Deferred()
     if ( nullptr != http_ ) {
         delete http_;
     }
+    if ( nullptr != ranged_ ) {
+        for ( auto client : ranged_->clients_ ) {
+            delete client;
+        }
+        if ( nullptr != ranged_->writer_ ) {
+            delete ranged_->writer_;
+        }
+        delete ranged_;
+    }
 }
 
 /**
@@ -76,8 +105,42 @@ void casper::proxy::worker::http::Deferred::Run (const casper::proxy::worker::ht
     Bind(a_callbacks);
     // ... prepare HTTP client ...
     http_ = new ::cc::easy::http::Client(loggable_data_, tracking_.ua_.c_str());
+    // ... track it ...
+    Track();
+    // ... log ...
+    OnLogDeferredStep(this, "http/...");
+    // ... revalidating a previous download?
+    revalidate_ = ( true == arguments_->parameters().IsCustomHTTPResponseSet() && 0 != arguments_->parameters().http_response().cached_.uri_.length() );
+    // ... plain request? perform it on an I/O loop ...
+    if ( true == Offload() ) {
+        return;
+    }
+    // ... HTTP requests must be performed @ MAIN thread ...
+    CallOnMainThread([this]() {
+        // ... set additional properties ...
+        Setup(*http_);
+        // ... large file, that might be downloaded in concurrent ranges?
+        if ( true == arguments_->parameters().IsCustomHTTPResponseSet() && arguments_->parameters().http_response().connections_ > 1 ) {
+            Probe();
+        } else {
+            Perform();
+        }
+    });
+}
+
+/**
+ * @brief Set an HTTP client properties, from this request arguments.
+ *
+ * @param a_client HTTP client to setup.
+ */
+void casper::proxy::worker::http::Deferred::Setup (::cc::easy::http::Client& a_client)
+{
+    // ... (in)sanity checkpoint ...
+    CC_DEBUG_FAIL_IF_NOT_AT_MAIN_THREAD();
+    const auto& request = arguments_->parameters().http_request();
+    // ... log?
     if ( HTTPOptions::NotSet != ( ( HTTPOptions::Log | HTTPOptions::Trace ) & http_options_ ) ) {
-        http_->SetcURLedCallbacks({
+        a_client.SetcURLedCallbacks({
             /* log_request_  */ std::bind(&casper::proxy::worker::http::Deferred::OnLogHTTPRequest , this, std::placeholders::_1, std::placeholders::_2),
             /* log_response_ */ std::bind(&casper::proxy::worker::http::Deferred::OnLogHTTPValue   , this, std::placeholders::_1, std::placeholders::_2)
             CC_IF_DEBUG(
@@ -87,58 +150,205 @@ void casper::proxy::worker::http::Deferred::Run (const casper::proxy::worker::ht
             )
         }, HTTPOptions::Redact == ( HTTPOptions::Redact & http_options_ ));
     }
-    // ... track it ...
-    Track();
-    // ... log ...
-    OnLogDeferredStep(this, "http/...");
-    // ... HTTP requests must be performed @ MAIN thread ...
-    CallOnMainThread([this]() {
-        //
-        const auto& request = arguments_->parameters().http_request();
-        // ... set additional properties ...
-        if ( true == request.follow_location_ ) {
-            http_->SetFollowLocation();
-        }
-        // ... disable SSL peer verification?
+    // ... set additional properties ...
+    if ( true == request.follow_location_ ) {
+        a_client.SetFollowLocation();
+    }
+    // ... disable SSL peer verification?
 #ifdef CC_DEBUG_ON
-        if ( true == request.ssl_do_not_verify_peer_ ) {
-            http_->SetSSLDoNotVerifyPeer();
-        }
-        http_->SetProxy(request.proxy_);
-        http_->SetCACert(request.ca_cert_);
+    if ( true == request.ssl_do_not_verify_peer_ ) {
+        a_client.SetSSLDoNotVerifyPeer();
+    }
+    a_client.SetProxy(request.proxy_);
+    a_client.SetCACert(request.ca_cert_);
 #endif
-        // ... set callbacks ...
-        const ::cc::easy::http::Client::Callbacks callbacks = {
-            /* on_success_ */ std::bind(&casper::proxy::worker::http::Deferred::OnHTTPRequestCompleted, this, std::placeholders::_1),
-            /* on_error_   */ std::bind(&casper::proxy::worker::http::Deferred::OnHTTPRequestError    , this, std::placeholders::_1),
-            /* on_failure_ */ std::bind(&casper::proxy::worker::http::Deferred::OnHTTPRequestFailure  , this, std::placeholders::_1)
-        };
-        // ... async perform HTTP request ...
-        switch(request.method_) {
-            case ::cc::easy::http::Client::Method::HEAD:
-                http_->HEAD(request.url_, request.headers_, callbacks, &request.timeouts_);
-                break;
-            case ::cc::easy::http::Client::Method::GET:
-                http_->GET(request.url_, request.headers_, callbacks, &request.timeouts_);
-                break;
-            case ::cc::easy::http::Client::Method::DELETE:
-                http_->DELETE(request.url_, request.headers_, ( 0 != request.body_.length() ? &request.body_ : nullptr ), callbacks, &request.timeouts_);
-                break;
-            case ::cc::easy::http::Client::Method::POST:
-                http_->POST(request.url_, request.headers_, request.body_, callbacks, &request.timeouts_);
-                break;
-            case ::cc::easy::http::Client::Method::PUT:
-                http_->PUT(request.url_, request.headers_, request.body_, callbacks, &request.timeouts_);
-                break;
-            case ::cc::easy::http::Client::Method::PATCH:
-                http_->PATCH(request.url_, request.headers_, request.body_, callbacks, &request.timeouts_);
-                break;
-            default:
-                throw ::cc::NotImplemented("Method '" UINT8_FMT "' not implemented!", static_cast<uint8_t>(request.method_));
-        }
+}
+
+/**
+ * @brief Async perform HTTP request, as provided.
+ */
+void casper::proxy::worker::http::Deferred::Perform ()
+{
+    // ... (in)sanity checkpoint ...
+    CC_DEBUG_FAIL_IF_NOT_AT_MAIN_THREAD();
+    const auto& request = arguments_->parameters().http_request();
+    // ... no longer revalidating a previous download? request it as if it was never downloaded ...
+    const ::cc::easy::http::Client::Headers* headers = &request.headers_;
+    ::cc::easy::http::Client::Headers        unconditional;
+    if ( false == revalidate_ && true == arguments_->parameters().IsCustomHTTPResponseSet() && 0 != arguments_->parameters().http_response().cached_.uri_.length() ) {
+        unconditional = request.headers_;
+        Unconditional(unconditional);
+        headers = &unconditional;
+    }
+    // ... set callbacks ...
+    const ::cc::easy::http::Client::Callbacks callbacks = {
+        /* on_success_ */ std::bind(&casper::proxy::worker::http::Deferred::OnHTTPRequestCompleted, this, std::placeholders::_1),
+        /* on_error_   */ std::bind(&casper::proxy::worker::http::Deferred::OnHTTPRequestError    , this, std::placeholders::_1),
+        /* on_failure_ */ std::bind(&casper::proxy::worker::http::Deferred::OnHTTPRequestFailure  , this, std::placeholders::_1)
+    };
+    // ... async perform HTTP request ...
+    switch(request.method_) {
+        case ::cc::easy::http::Client::Method::HEAD:
+            http_->HEAD(request.url_, *headers, callbacks, &request.timeouts_);
+            break;
+        case ::cc::easy::http::Client::Method::GET:
+            http_->GET(request.url_, *headers, callbacks, &request.timeouts_);
+            break;
+        case ::cc::easy::http::Client::Method::DELETE:
+            http_->DELETE(request.url_, *headers, ( 0 != request.body_.length() ? &request.body_ : nullptr ), callbacks, &request.timeouts_);
+            break;
+        case ::cc::easy::http::Client::Method::POST:
+            http_->POST(request.url_, *headers, request.body_, callbacks, &request.timeouts_);
+            break;
+        case ::cc::easy::http::Client::Method::PUT:
+            http_->PUT(request.url_, *headers, request.body_, callbacks, &request.timeouts_);
+            break;
+        case ::cc::easy::http::Client::Method::PATCH:
+            http_->PATCH(request.url_, *headers, request.body_, callbacks, &request.timeouts_);
+            break;
+        default:
+            throw ::cc::NotImplemented("Method '" UINT8_FMT "' not implemented!", static_cast<uint8_t>(request.method_));
+    }
+}
+
+/**
+ * @brief Async perform HTTP request on one of \link Loops \link, instead of @ MAIN thread.
+ *
+ * @return True if it was submitted, false if loops are disabled or if request requires \link ::cc::easy::http::Client \link - caller should perform it.
+ */
+bool casper::proxy::worker::http::Deferred::Offload ()
+{
+    const auto& request = arguments_->parameters().http_request();
+    // ... ranged downloads are handled by Probe ...
+    if ( false == Loopable() || nullptr == casper::proxy::worker::http::Loops::Method(request.method_)
+        || ( true == arguments_->parameters().IsCustomHTTPResponseSet() && arguments_->parameters().http_response().connections_ > 1 ) ) {
+        return false;
+    }
+    casper::proxy::worker::http::Loops::Request loop_request = {
+        /* method_          */ request.method_,
+        /* url_             */ request.url_,
+        /* headers_         */ request.headers_,
+        /* body_            */ request.body_,
+        /* timeouts_        */ request.timeouts_,
+        /* follow_location_ */ request.follow_location_,
+        /* user_agent_      */ tracking_.ua_,
+        /* max_body_        */ 0
+    };
+    // ... no longer revalidating a previous download? request it as if it was never downloaded ...
+    if ( false == revalidate_ ) {
+        Unconditional(loop_request.headers_);
+    }
+    // ... no cURL(ed) callbacks, trace request as they would ( it will only be logged if request fails ) ...
+    if ( HTTPOptions::Trace == ( HTTPOptions::Trace & http_options_ ) ) {
+        const std::string data = std::string("curl -X ") + casper::proxy::worker::http::Loops::Method(request.method_)
+                                    + " '" + ( HTTPOptions::Redact == ( HTTPOptions::Redact & http_options_ ) ? request.url_.substr(0, request.url_.find('?')) : request.url_ ) + "'";
+        const std::string tag  = tags_(casper::proxy::worker::http::Tag::Hop::LogRequest);
+        CallOnLooperThread(tag, [this, data] (const std::string&) {
+            http_trace_.push_back({
+                /* code_ */ 0,
+                /* data_ */ data
+            });
+        });
+    }
+    // ... completion is reported @ loop thread, straight to looper thread ( main thread is kept out of it ) ...
+    const std::string tag = tags_(casper::proxy::worker::http::Tag::Hop::Completed);
+    return casper::proxy::worker::http::Loops::GetInstance().Submit(loop_request, [this, tag] (casper::proxy::worker::http::Loops::Result& a_result) {
+        const std::shared_ptr<casper::proxy::worker::http::Loops::Result> result = std::make_shared<casper::proxy::worker::http::Loops::Result>(std::move(a_result));
+        CallOnLooperThread(tag, [this, result] (const std::string&) {
+            OnLoopRequestCompleted(*result);
+        }, /* a_daredevil */ true);
     });
 }
 
+/**
+ * @return True if this request can be performed by \link Loops \link.
+ */
+bool casper::proxy::worker::http::Deferred::Loopable () const
+{
+#ifdef CC_DEBUG_ON
+    // ... SSL peer verification, proxy and CA overrides are only supported by ::cc::easy::http::Client ...
+    const auto& request = arguments_->parameters().http_request();
+    if ( true == request.ssl_do_not_verify_peer_ || 0 != request.proxy_.url_.length() || 0 != request.ca_cert_.uri_.length() ) {
+        return false;
+    }
+#endif
+    // ... logging requires cURL(ed) callbacks ...
+    return ( true == casper::proxy::worker::http::Loops::GetInstance().enabled() && not ( HTTPOptions::Log == ( HTTPOptions::Log & http_options_ ) ) );
+}
+
+/**
+ * @brief Remove revalidation headers added to request, see \link Index \link.
+ *
+ * @param io_headers Request headers.
+ */
+void casper::proxy::worker::http::Deferred::Unconditional (::cc::easy::http::Client::Headers& io_headers) const
+{
+    if ( true == arguments_->parameters().IsCustomHTTPResponseSet() && 0 != arguments_->parameters().http_response().cached_.uri_.length() ) {
+        io_headers.erase("If-None-Match");
+        io_headers.erase("If-Modified-Since");
+    }
+}
+
+/**
+ * @brief Reuse previous download, if it's being revalidated and it's unchanged.
+ *
+ * @param a_value Value.
+ *
+ * @return True if it was handled, either finalized or requested again.
+ */
+bool casper::proxy::worker::http::Deferred::Revalidated (const ::cc::easy::http::Client::Value& a_value)
+{
+    if ( false == revalidate_ || 304 != a_value.code() ) {
+        return false;
+    }
+    std::map<std::string, std::string> headers;
+    a_value.headers_as_map(headers);
+    return Revalidated(a_value.code(), headers, a_value.rtt(), tags_(casper::proxy::worker::http::Tag::Hop::Revalidated));
+}
+
+/**
+ * @brief Reuse previous download, if it's being revalidated and it's unchanged.
+ *
+ * @param a_code    HTTP status code.
+ * @param a_headers Response headers, validators might be added.
+ * @param a_rtt     Round trip time.
+ * @param a_tag     Callback tag.
+ *
+ * @return True if it was handled, either finalized or requested again.
+ */
+bool casper::proxy::worker::http::Deferred::Revalidated (const uint16_t a_code, std::map<std::string, std::string>& a_headers, const size_t a_rtt, const std::string& a_tag)
+{
+    // ... (in)sanity checkpoint ...
+    CC_DEBUG_FAIL_IF_NOT_AT_MAIN_THREAD();
+    if ( false == revalidate_ || 304 != a_code ) {
+        return false;
+    }
+    revalidate_ = false;
+    const auto& config = arguments_->parameters().http_response();
+    // ... unchanged: hard link previous download as this job file, it's data is kept for as long as any of them is ...
+    const std::string tmp = config.uri_ + ".lnk";
+    if ( 0 != link(config.cached_.uri_.c_str(), tmp.c_str()) || 0 != rename(tmp.c_str(), config.uri_.c_str()) ) {
+        (void)unlink(tmp.c_str());
+        // ... previous download is gone ( or can't be linked ), download it again ...
+        if ( false == Offload() ) {
+            Perform();
+        }
+        return true;
+    }
+    // ... a 304 response is not required to repeat validators ...
+    if ( 0 == casper::proxy::worker::http::Index::Header(a_headers, "ETag").length() && 0 != config.cached_.etag_.length() ) {
+        a_headers["ETag"] = config.cached_.etag_;
+    }
+    if ( 0 == casper::proxy::worker::http::Index::Header(a_headers, "Last-Modified").length() && 0 != config.cached_.last_modified_.length() ) {
+        a_headers["Last-Modified"] = config.cached_.last_modified_;
+    }
+    response_.Set(CC_EASY_HTTP_OK, casper::proxy::worker::http::Index::Header(a_headers, "Content-Type"), a_headers, "", a_rtt);
+    written_ = true;
+    // ... finalize ...
+    Finalize(a_tag);
+    return true;
+}
+
 // MARK: -
 
 /**
@@ -150,19 +360,222 @@ void casper::proxy::worker::http::Deferred::Finalize (const std::string& a_tag)
 {
     // ... (in)sanity checkpoint ...
     CC_DEBUG_FAIL_IF_NOT_AT_MAIN_THREAD();
+    // ... build job payload off the looper thread, we'll be back here when it's done ...
+    if ( true == PostProcess(a_tag, /* a_looper */ false) ) {
+        return;
+    }
     // ... must be done on 'looper' thread ...
     CallOnLooperThread(a_tag, [this] (const std::string&) {
-        // ... if request failed, and if we're tracing and did not log HTTP calls, should we do it now?
-        if ( CC_EASY_HTTP_OK != response_.code() && HTTPOptions::Trace == ( HTTPOptions::Trace & http_options_ ) && not ( HTTPOptions::Log == ( HTTPOptions::Log & http_options_ ) ) ) {
-            for ( const auto& trace : http_trace_ ) {
-                OnLogDeferred(this, CC_JOB_LOG_LEVEL_VBS ,CC_JOB_LOG_STEP_HTTP, trace.data_);
+        Notify();
+    }, /* a_daredevil */ true);
+}
+
+/**
+ * @brief Same as \link Finalize \link but for requests completed by \link Loops \link, it must be called @ looper thread.
+ *
+ * @param a_tag Callback tag.
+ */
+void casper::proxy::worker::http::Deferred::Conclude (const std::string& a_tag)
+{
+    // ... build job payload off the looper thread, we'll be back here when it's done ...
+    if ( true == PostProcess(a_tag, /* a_looper */ true) ) {
+        return;
+    }
+    // ... already @ 'looper' thread ...
+    Notify();
+}
+
+/**
+ * @brief Signal that this request is now completed, it must be called @ looper thread.
+ */
+void casper::proxy::worker::http::Deferred::Notify ()
+{
+    // ... if request failed, and if we're tracing and did not log HTTP calls, should we do it now?
+    if ( CC_EASY_HTTP_OK != response_.code() && HTTPOptions::Trace == ( HTTPOptions::Trace & http_options_ ) && not ( HTTPOptions::Log == ( HTTPOptions::Log & http_options_ ) ) ) {
+        for ( const auto& trace : http_trace_ ) {
+            OnLogDeferred(this, CC_JOB_LOG_LEVEL_VBS ,CC_JOB_LOG_STEP_HTTP, trace.data_);
+        }
+    }
+    // ... notify ...
+    OnCompleted(this);
+    // ... done ...
+    Untrack();
+}
+
+/**
+ * @brief Build job payload using \link executor::Pool \link, so that CPU or disk bound work ( files, base64, JSON parsing, gateway encoding ) doesn't stall the looper thread.
+ *
+ * @param a_tag    Callback tag.
+ * @param a_looper True when called from \link Conclude \link @ looper thread.
+ *
+ * @return True if it was submitted, \link Finalize \link or \link Conclude \link will be called again when done.
+ */
+bool casper::proxy::worker::http::Deferred::PostProcess (const std::string& a_tag, const bool a_looper)
+{
+    // ... only once ...
+    if ( true == processed_ || nullptr == arguments_ ) {
+        return false;
+    }
+    processed_ = true;
+    // ... submit it, or fallback to looper thread if busy ...
+    return casper::proxy::worker::executor::Pool::GetInstance().Submit([this, a_tag, a_looper] () {
+        try {
+            BuildPayload(arguments_->parameters(), response_, payload_, written_);
+        } catch (const ::cc::Exception& a_exception) {
+            error_ = a_exception.what();
+        } catch (...) {
+            try {
+                ::cc::Exception::Rethrow(/* a_unhandled */ true, __FILE__, __LINE__, __FUNCTION__);
+            } catch (const ::cc::Exception& a_exception) {
+                error_ = a_exception.what();
             }
         }
-        // ... notify ...
-        OnCompleted(this);
-        // ... done ...
-        Untrack();
-    }, /* a_daredevil */ true);
+        prepared_ = true;
+        // ... back to the thread we came from, to finalize ...
+        if ( true == a_looper ) {
+            CallOnLooperThread(a_tag, [this, a_tag] (const std::string&) {
+                Conclude(a_tag);
+            }, /* a_daredevil */ true);
+        } else {
+            CallOnMainThread([this, a_tag] () {
+                Finalize(a_tag);
+            });
+        }
+    });
+}
+
+/**
+ * @brief Hand over job payload built by post-processing.
+ *
+ * @param o_payload JSON response to fill.
+ */
+void casper::proxy::worker::http::Deferred::TakePayload (Json::Value& o_payload)
+{
+    // ... (in)sanity checkpoint ...
+    CC_DEBUG_ASSERT(true == prepared_);
+    // ... failed? report it as if it happened now ...
+    if ( 0 != error_.length() ) {
+        throw ::cc::Exception("%s", error_.c_str());
+    }
+    o_payload.swap(payload_);
+}
+
+/**
+ * @brief Build job payload.
+ *
+ * @param a_parameters Job parameters.
+ * @param a_response   Deferred request response.
+ * @param o_payload    JSON response to fill.
+ * @param a_written    True if response body was already written to file, see \link Deferred::written \link.
+ */
+void casper::proxy::worker::http::Deferred::BuildPayload (const casper::proxy::worker::http::Parameters& a_parameters, const ::casper::job::deferrable::Response& a_response,
+                                                          Json::Value& o_payload, const bool a_written)
+{
+    // ... set payload ...
+    o_payload = Json::Value(Json::ValueType::objectValue);
+    // ... upstream compression negotiated? body is only decoded now, when it's needed ...
+    const auto encoding = ( true == a_parameters.accept_encoding() ? casper::proxy::worker::codec::Decompressor::Encoding(a_response.headers()) : casper::proxy::worker::codec::Compressor::Codec::None );
+    std::string                                         decoded;
+    casper::proxy::worker::codec::Decompressor::Headers stripped;
+    if ( casper::proxy::worker::codec::Compressor::Codec::None != encoding ) {
+        casper::proxy::worker::codec::Decompressor::Do(encoding, reinterpret_cast<const unsigned char*>(a_response.body().c_str()), a_response.body().length(), decoded);
+        casper::proxy::worker::codec::Decompressor::Stripped(a_response.headers(), stripped);
+    }
+    const std::string& body    = ( casper::proxy::worker::codec::Compressor::Codec::None != encoding ? decoded  : a_response.body()    );
+    const auto&        headers = ( casper::proxy::worker::codec::Compressor::Codec::None != encoding ? stripped : a_response.headers() );
+    // ... primitive or default?
+    if ( true == a_parameters.primitive_ ) {
+        // ... gateway response mode ....
+        // ... V1 or V2 format, see \link Gateway \link ...
+        const auto exception = a_response.exception();
+        if ( nullptr != exception ) {
+            casper::proxy::worker::http::Gateway::Encode(a_parameters.gateway_, a_response.code(), a_response.content_type(), exception->what(), strlen(exception->what()),
+                                                         headers, a_parameters.spill(), o_payload);
+        } else {
+            casper::proxy::worker::http::Gateway::Encode(a_parameters.gateway_, a_response.code(), a_response.content_type(), body.c_str(), body.length(),
+                                                         headers, a_parameters.spill(), o_payload);
+        }
+    } else if ( 200 == a_response.code() && true == a_parameters.IsCustomHTTPResponseSet() ) {
+        const auto& config = a_parameters.http_response();
+        // ... to file?
+        if ( 0 != config.uri_.length() ) {
+            // ... yes, unless it was already written by ranges ...
+            if ( false == a_written ) {
+                Write(config, body);
+            }
+            // ... keep track of it, so it can be reused by identical requests ...
+            if ( 0 != config.key_.length() ) {
+                casper::proxy::worker::http::Index::GetInstance().Set(config.key_, headers, config.uri_, config.validity_);
+            }
+            const char* const dst = config.url_.c_str();
+            if ( nullptr != strcasestr(dst, "file://") ) {
+                o_payload["uri"] = dst;
+            } else {
+                o_payload["url"] = dst;
+            }
+        } else {
+            // ... no, unless it's oversized ...
+            if ( true == casper::proxy::worker::fs::Spill::Do(a_parameters.spill(), body, o_payload) ) {
+                // ... written to file ...
+            } else if ( true == config.base64_ ) {
+                o_payload["body"] = casper::proxy::worker::codec::Base64::Encode(reinterpret_cast<const unsigned char*>(body.c_str()), body.size());
+            } else {
+                o_payload["body"] = body;
+            }
+        }
+    } else {
+        // ... body ...
+        if ( true == casper::proxy::worker::fs::Spill::Do(a_parameters.spill(), body, o_payload) ) {
+            // ... oversized, written to file ...
+        } else if ( true == ::cc::easy::JSON<::cc::Exception>::IsJSON(a_response.content_type()) ) {
+            casper::proxy::worker::codec::JSON::Parse(body, o_payload["body"]);
+        } else {
+            o_payload["body"] = body;
+        }
+        // ... headers ...
+        o_payload["headers"] = Json::Value(Json::ValueType::objectValue);
+        for ( const auto& header : headers ) {
+            o_payload["headers"][header.first] = header.second;
+        }
+        // ... code ...
+        o_payload["code"] = a_response.code();
+    }
+}
+
+/**
+ * @brief Write a response body to file, base64 encoded if requested.
+ *
+ * @param a_config HTTP response config.
+ * @param a_body   Response body.
+ */
+void casper::proxy::worker::http::Deferred::Write (const casper::proxy::worker::http::Parameters::HTTPResponse& a_config, const std::string& a_body)
+{
+    const unsigned char* const data = reinterpret_cast<const unsigned char*>(a_body.c_str());
+    const size_t               size = a_body.size();
+    const auto write = [&a_config, data, size] () {
+        // ... body is fully buffered, so final size is known: reserve it ...
+        casper::proxy::worker::fs::Writer writer(a_config.uri_, ( true == a_config.base64_ ? casper::proxy::worker::codec::Base64::EncodedLength(size) : size ));
+        if ( true == a_config.base64_ ) {
+            // ... in slices, so the encoded body is never fully held in memory ...
+            casper::proxy::worker::codec::Base64::Encoder encoder;
+            const auto sink = [&writer] (const char* const a_data, const size_t a_size) {
+                writer.Append(reinterpret_cast<const unsigned char*>(a_data), a_size);
+            };
+            for ( size_t offset = 0 ; offset < size ; offset += sk_base64_slice_size_ ) {
+                encoder.Update(data + offset, ( size - offset > sk_base64_slice_size_ ? sk_base64_slice_size_ : size - offset ), sink);
+            }
+            encoder.Final(sink);
+        } else {
+            writer.Append(data, size);
+        }
+        writer.Close();
+    };
+    // ... same content, encoded the same way, is only written once ...
+    if ( 0 != a_config.store_.length() ) {
+        (void)casper::proxy::worker::fs::Store::Put(a_config.store_, casper::proxy::worker::fs::Store::Key(a_body, ( true == a_config.base64_ ? "b64" : "" )), a_config.uri_, write);
+    } else {
+        write();
+    }
 }
 
 /**
@@ -174,15 +587,18 @@ void casper::proxy::worker::http::Deferred::OnHTTPRequestCompleted (const ::cc::
 {
     // ... (in)sanity checkpoint ...
     CC_DEBUG_FAIL_IF_NOT_AT_MAIN_THREAD();
+    // ... previous download is still valid?
+    if ( true == Revalidated(a_value) ) {
+        return;
+    }
     // ... save response ...
     const std::string content_type = a_value.header_value("Content-Type");
     {
         std::map<std::string, std::string> headers;
         response_.Set(a_value.code(), content_type, a_value.headers_as_map(headers), a_value.body(), a_value.rtt());
     }
-    const std::string tag = std::to_string(tracking_.bjid_) + "-" + tracking_.rjid_ + '-' + ::cc::ObjectHexAddr<::cc::easy::http::Client::Value>(&a_value) + "-http-" + ( CC_EASY_HTTP_OK == response_.code() ? "-succeeded-" : "-failed-" );
     // ... finalize ...
-    Finalize(tag);
+    Finalize(tags_(casper::proxy::worker::http::Tag::Hop::Completed));
 }
 
 /**
@@ -206,7 +622,7 @@ void casper::proxy::worker::http::Deferred::OnHTTPRequestError (const ::cc::easy
             break;
     }
     // ... finalize ...
-    Finalize(std::to_string(tracking_.bjid_) + "-" + tracking_.rjid_ + '-' + ::cc::ObjectHexAddr<::cc::easy::http::Client::Error>(&a_value) + "-http-error-");
+    Finalize(tags_(casper::proxy::worker::http::Tag::Hop::Error));
 }
 
 /**
@@ -221,7 +637,372 @@ void casper::proxy::worker::http::Deferred::OnHTTPRequestFailure (const ::cc::Ex
     // ... set response ...
     response_.Set(CC_EASY_HTTP_INTERNAL_SERVER_ERROR, a_exception);
     // ... finalize ...
-    Finalize(std::to_string(tracking_.bjid_) + "-" + tracking_.rjid_ + '-' + ::cc::ObjectHexAddr<::cc::Exception>(&a_exception) + "-http-failure-");
+    Finalize(tags_(casper::proxy::worker::http::Tag::Hop::Failure));
+}
+
+/**
+ * @brief Called, @ looper thread, when a request performed by one of \link Loops \link is completed.
+ *
+ * @param a_result Request result.
+ */
+void casper::proxy::worker::http::Deferred::OnLoopRequestCompleted (casper::proxy::worker::http::Loops::Result& a_result)
+{
+    // ... not performed?
+    if ( CURLE_OK != a_result.error_ ) {
+        switch (a_result.error_) {
+            case CURLE_OPERATION_TIMEOUTED:
+                // 504 Gateway Timeout
+                response_.Set(CC_EASY_HTTP_GATEWAY_TIMEOUT, "cURL: " + a_result.message_);
+                break;
+            default:
+                // 500 Internal Server Error
+                response_.Set(CC_EASY_HTTP_INTERNAL_SERVER_ERROR, a_result.message_);
+                break;
+        }
+        Conclude(tags_(casper::proxy::worker::http::Tag::Hop::Error));
+        return;
+    }
+    // ... previous download might still be valid? it might have to be requested again, by ::cc::easy::http::Client @ MAIN thread ...
+    if ( true == revalidate_ && 304 == a_result.code_ ) {
+        const uint16_t                     code    = a_result.code_;
+        const size_t                       rtt     = a_result.rtt_;
+        std::map<std::string, std::string> headers = std::move(a_result.headers_);
+        CallOnMainThread([this, code, headers, rtt] () {
+            std::map<std::string, std::string> validators = headers;
+            (void)Revalidated(code, validators, rtt, tags_(casper::proxy::worker::http::Tag::Hop::Revalidated));
+        });
+        return;
+    }
+    // ... save response ...
+    response_.Set(a_result.code_, casper::proxy::worker::http::Index::Header(a_result.headers_, "Content-Type"), a_result.headers_, a_result.body_, a_result.rtt_);
+    // ... finalize ...
+    Conclude(tags_(casper::proxy::worker::http::Tag::Hop::Completed));
+}
+
+// MARK: - Ranged Download
+
+/**
+ * @brief Learn file size and if ranges are supported, with a HEAD request, before downloading it.
+ */
+void casper::proxy::worker::http::Deferred::Probe ()
+{
+    // ... (in)sanity checkpoint ...
+    CC_DEBUG_FAIL_IF_NOT_AT_MAIN_THREAD();
+    const auto& request = arguments_->parameters().http_request();
+    // ... on error, just perform request as provided ...
+    http_->HEAD(request.url_, request.headers_, {
+        /* on_success_ */ std::bind(&casper::proxy::worker::http::Deferred::OnProbeCompleted, this, std::placeholders::_1),
+        /* on_error_   */ [this] (const ::cc::easy::http::Client::Error&) { Perform(); },
+        /* on_failure_ */ [this] (const ::cc::Exception&) { Perform(); }
+    }, &request.timeouts_);
+}
+
+/**
+ * @brief Called by HTTP client when probe request was performed.
+ *
+ * @param a_value Value.
+ */
+void casper::proxy::worker::http::Deferred::OnProbeCompleted (const ::cc::easy::http::Client::Value& a_value)
+{
+    // ... (in)sanity checkpoint ...
+    CC_DEBUG_FAIL_IF_NOT_AT_MAIN_THREAD();
+    // ... previous download is still valid?
+    if ( true == Revalidated(a_value) ) {
+        return;
+    }
+    const auto&       config   = arguments_->parameters().http_response();
+    const std::string length   = a_value.header_value("Content-Length");
+    const std::string ranges   = a_value.header_value("Accept-Ranges");
+    const std::string encoding = a_value.header_value("Content-Encoding");
+    const uint64_t    size     = ( 0 != length.length() ? static_cast<uint64_t>(strtoull(length.c_str(), nullptr, 10)) : 0 );
+    // ... not supported, or not worth it? perform request as provided ...
+    if ( CC_EASY_HTTP_OK != a_value.code() || nullptr == strcasestr(ranges.c_str(), "bytes")
+        || ( 0 != encoding.length() && 0 != strcasecmp(encoding.c_str(), "identity") ) || size <= config.range_size_ ) {
+        Perform();
+        return;
+    }
+    // ... keep probe response, body will be written straight to file ...
+    {
+        std::map<std::string, std::string> headers;
+        response_.Set(a_value.code(), a_value.header_value("Content-Type"), a_value.headers_as_map(headers), "", a_value.rtt());
+    }
+    ranged_ = new Ranged({
+        /* size_      */ size,
+        /* validator_ */ "",
+        /* pending_   */ {},
+        /* clients_   */ {},
+        /* busy_      */ {},
+        /* in_flight_ */ 0,
+        /* writer_    */ nullptr,
+        /* failed_    */ false,
+        /* looped_    */ Loopable(),
+        /* honoured_  */ false
+    });
+    // ... only a strong validator can be used with 'If-Range' ...
+    const std::string etag = a_value.header_value("ETag");
+    if ( 0 != etag.length() && 0 != strncmp(etag.c_str(), "W/", 2) ) {
+        ranged_->validator_ = etag;
+    }
+    for ( uint64_t offset = 0 ; offset < size ; offset += config.range_size_ ) {
+        ranged_->pending_.push_back({
+            /* offset_   */ offset,
+            /* length_   */ ( size - offset > config.range_size_ ? config.range_size_ : size - offset ),
+            /* attempts_ */ 0
+        });
+    }
+    const size_t connections = std::min(static_cast<size_t>(config.connections_), ranged_->pending_.size());
+    for ( size_t idx = 0 ; idx < connections ; ++idx ) {
+        ranged_->busy_.push_back(false);
+        // ... loops will share connections by host, but only they can limit response size ...
+        if ( false == ranged_->looped_ ) {
+            ranged_->clients_.push_back(new ::cc::easy::http::Client(loggable_data_, tracking_.ua_.c_str()));
+            Setup(*ranged_->clients_.back());
+        }
+    }
+    // ... preallocate file, so ranges can be written in place, in any order ...
+    try {
+        ranged_->writer_ = new casper::proxy::worker::fs::Writer(config.uri_, static_cast<size_t>(size));
+    } catch (const ::cc::Exception& a_exception) {
+        response_.Set(CC_EASY_HTTP_INTERNAL_SERVER_ERROR, a_exception);
+        ranged_->failed_ = true;
+    }
+    // ... start ...
+    Next();
+}
+
+/**
+ * @brief Keep all connections busy while there are ranges to download, finalize when all of them are written or when giving up.
+ */
+void casper::proxy::worker::http::Deferred::Next ()
+{
+    // ... (in)sanity checkpoint ...
+    CC_DEBUG_FAIL_IF_NOT_AT_MAIN_THREAD();
+    if ( false == ranged_->failed_ ) {
+        // ... until a range is received, request only one at a time: a server that ignores ranges would send the whole file to each connection ...
+        const size_t slots = ( true == ranged_->honoured_ ? ranged_->busy_.size() : ( 0 == ranged_->in_flight_ ? 1 : 0 ) );
+        for ( size_t slot = 0 ; slot < slots && ranged_->pending_.size() > 0 ; ++slot ) {
+            if ( false == ranged_->busy_[slot] ) {
+                const Range range = ranged_->pending_.front();
+                ranged_->pending_.pop_front();
+                Fetch(slot, range);
+            }
+        }
+    }
+    // ... still work in progress?
+    if ( ranged_->in_flight_ > 0 || ( false == ranged_->failed_ && ranged_->pending_.size() > 0 ) ) {
+        return;
+    }
+    // ... done ...
+    if ( false == ranged_->failed_ ) {
+        try {
+            ranged_->writer_->Close();
+            written_ = true;
+        } catch (const ::cc::Exception& a_exception) {
+            response_.Set(CC_EASY_HTTP_INTERNAL_SERVER_ERROR, a_exception);
+            ranged_->failed_ = true;
+        }
+    }
+    // ... failed? don't leave a preallocated, partially written, file behind ...
+    if ( true == ranged_->failed_ ) {
+        if ( nullptr != ranged_->writer_ ) {
+            delete ranged_->writer_;
+            ranged_->writer_ = nullptr;
+        }
+        (void)unlink(arguments_->parameters().http_response().uri_.c_str());
+    }
+    // ... finalize ...
+    Finalize(tags_(casper::proxy::worker::http::Tag::Hop::Ranged));
+}
+
+/**
+ * @brief Async request a range.
+ *
+ * @param a_slot  Connection index.
+ * @param a_range Range to request.
+ */
+void casper::proxy::worker::http::Deferred::Fetch (const size_t a_slot, const casper::proxy::worker::http::Deferred::Range a_range)
+{
+    // ... (in)sanity checkpoint ...
+    CC_DEBUG_FAIL_IF_NOT_AT_MAIN_THREAD();
+    const auto& request = arguments_->parameters().http_request();
+    ::cc::easy::http::Client::Headers headers = request.headers_;
+    Unconditional(headers);
+    headers["Range"] = { "bytes=" + std::to_string(a_range.offset_) + "-" + std::to_string(a_range.offset_ + a_range.length_ - 1) };
+    if ( 0 != ranged_->validator_.length() ) {
+        headers["If-Range"] = { ranged_->validator_ };
+    }
+    ranged_->busy_[a_slot] = true;
+    ranged_->in_flight_++;
+    // ... using loops? response size is limited to requested range, a whole file ( range not honoured ) is aborted ...
+    if ( true == ranged_->looped_ ) {
+        const casper::proxy::worker::http::Loops::Request loop_request = {
+            /* method_          */ ::cc::easy::http::Client::Method::GET,
+            /* url_             */ request.url_,
+            /* headers_         */ headers,
+            /* body_            */ "",
+            /* timeouts_        */ request.timeouts_,
+            /* follow_location_ */ request.follow_location_,
+            /* user_agent_      */ tracking_.ua_,
+            /* max_body_        */ a_range.length_
+        };
+        const bool submitted = casper::proxy::worker::http::Loops::GetInstance().Submit(loop_request, [this, a_slot, a_range] (casper::proxy::worker::http::Loops::Result& a_result) {
+            const std::shared_ptr<casper::proxy::worker::http::Loops::Result> result = std::make_shared<casper::proxy::worker::http::Loops::Result>(std::move(a_result));
+            CallOnMainThread([this, a_slot, a_range, result] () {
+                switch (result->error_) {
+                    case CURLE_OK:
+                        OnRangeCompleted(a_slot, a_range, result->code_, casper::proxy::worker::http::Index::Header(result->headers_, "Content-Range"), result->body_);
+                        break;
+                    case CURLE_OPERATION_TIMEOUTED:
+                        OnRangeFailed(a_slot, a_range, CC_EASY_HTTP_GATEWAY_TIMEOUT, "cURL: " + result->message_);
+                        break;
+                    case CURLE_FILESIZE_EXCEEDED:
+                    case CURLE_WRITE_ERROR:
+                        OnRangeFailed(a_slot, a_range, 412, "File changed, or range not honoured, while downloading it: " + result->message_);
+                        break;
+                    default:
+                        OnRangeFailed(a_slot, a_range, CC_EASY_HTTP_INTERNAL_SERVER_ERROR, "cURL: " + result->message_);
+                        break;
+                }
+            });
+        });
+        if ( false == submitted ) {
+            // ... loop queue is full, retry it later ...
+            CallOnMainThread([this, a_slot, a_range] () {
+                OnRangeFailed(a_slot, a_range, CC_EASY_HTTP_INTERNAL_SERVER_ERROR, "I/O loop queue is full!");
+            });
+        }
+        return;
+    }
+    ranged_->clients_[a_slot]->GET(request.url_, headers, {
+        /* on_success_ */ [this, a_slot, a_range] (const ::cc::easy::http::Client::Value& a_value) {
+            OnRangeCompleted(a_slot, a_range, a_value.code(), a_value.header_value("Content-Range"), a_value.body());
+        },
+        /* on_error_   */ [this, a_slot, a_range] (const ::cc::easy::http::Client::Error& a_error) {
+            OnRangeFailed(a_slot, a_range, ( CURLE_OPERATION_TIMEOUTED == a_error.code_ ? CC_EASY_HTTP_GATEWAY_TIMEOUT : CC_EASY_HTTP_INTERNAL_SERVER_ERROR ), "cURL: " + a_error.message());
+        },
+        /* on_failure_ */ [this, a_slot, a_range] (const ::cc::Exception& a_exception) {
+            OnRangeFailed(a_slot, a_range, CC_EASY_HTTP_INTERNAL_SERVER_ERROR, a_exception.what());
+        }
+    }, &request.timeouts_);
+}
+
+/**
+ * @brief Called by HTTP client when a range request was performed.
+ *
+ * @param a_slot          Connection index.
+ * @param a_range         Requested range.
+ * @param a_code          HTTP status code.
+ * @param a_content_range 'Content-Range' header value.
+ * @param a_body          Response body.
+ */
+void casper::proxy::worker::http::Deferred::OnRangeCompleted (const size_t a_slot, const casper::proxy::worker::http::Deferred::Range a_range,
+                                                              const uint16_t a_code, const std::string& a_content_range, const std::string& a_body)
+{
+    // ... (in)sanity checkpoint ...
+    CC_DEBUG_FAIL_IF_NOT_AT_MAIN_THREAD();
+    // ... giving up? just account for it ...
+    if ( true == ranged_->failed_ ) {
+        OnRangeFailed(a_slot, a_range, a_code, "");
+        return;
+    }
+    // ... 200 means range was not honoured, or file changed ( 'If-Range' ): can't be assembled ...
+    if ( 206 != a_code ) {
+        if ( CC_EASY_HTTP_OK == a_code ) {
+            OnRangeFailed(a_slot, a_range, 412, "File changed, or range not honoured, while downloading it!");
+        } else {
+            OnRangeFailed(a_slot, a_range, a_code, a_body);
+        }
+        return;
+    }
+    const std::string content_range = "bytes " + std::to_string(a_range.offset_) + "-";
+    if ( 0 != strncasecmp(a_content_range.c_str(), content_range.c_str(), content_range.length()) || 0 == a_body.length() || a_body.length() > a_range.length_ ) {
+        OnRangeFailed(a_slot, a_range, 502, "Unexpected range received, expecting " + content_range + std::to_string(a_range.offset_ + a_range.length_ - 1) + "!");
+        return;
+    }
+    // ... connection is free, but this range is still in progress until it's written ...
+    ranged_->busy_[a_slot] = false;
+    ranged_->honoured_     = true;
+    // ... short? resume it from where it stopped ...
+    if ( a_body.length() < a_range.length_ ) {
+        ranged_->pending_.push_front({
+            /* offset_   */ a_range.offset_ + a_body.length(),
+            /* length_   */ a_range.length_ - a_body.length(),
+            /* attempts_ */ a_range.attempts_
+        });
+    }
+    // ... write it in place, off the main thread ...
+    const std::shared_ptr<std::string>      data   = std::make_shared<std::string>(a_body);
+    casper::proxy::worker::fs::Writer*      writer = ranged_->writer_;
+    const off_t                             offset = static_cast<off_t>(a_range.offset_);
+    const casper::proxy::worker::executor::Pool::Task write = [this, writer, data, offset] () {
+        std::string error;
+        try {
+            writer->WriteAt(reinterpret_cast<const unsigned char*>(data->c_str()), data->length(), offset);
+        } catch (const ::cc::Exception& a_exception) {
+            error = a_exception.what();
+        } catch (...) {
+            try {
+                ::cc::Exception::Rethrow(/* a_unhandled */ true, __FILE__, __LINE__, __FUNCTION__);
+            } catch (const ::cc::Exception& a_exception) {
+                error = a_exception.what();
+            }
+        }
+        // ... back to main thread ...
+        CallOnMainThread([this, error] () {
+            OnRangeStored(error);
+        });
+    };
+    // ... or in place if busy ...
+    if ( false == casper::proxy::worker::executor::Pool::GetInstance().Submit(write) ) {
+        write();
+    }
+    // ... next ...
+    Next();
+}
+
+/**
+ * @brief Called when a range request failed.
+ *
+ * @param a_slot    Connection index.
+ * @param a_range   Requested range.
+ * @param a_code    HTTP status code.
+ * @param a_message Error message.
+ */
+void casper::proxy::worker::http::Deferred::OnRangeFailed (const size_t a_slot, casper::proxy::worker::http::Deferred::Range a_range, const uint16_t a_code, const std::string& a_message)
+{
+    // ... (in)sanity checkpoint ...
+    CC_DEBUG_FAIL_IF_NOT_AT_MAIN_THREAD();
+    ranged_->busy_[a_slot] = false;
+    ranged_->in_flight_--;
+    if ( false == ranged_->failed_ ) {
+        // ... transient? resume only this range, unless it failed too many times ...
+        if ( ( a_code >= 500 || 429 == a_code ) && ++a_range.attempts_ < sk_range_max_attempts_ ) {
+            ranged_->pending_.push_front(a_range);
+        } else {
+            response_.Set(a_code, a_message);
+            ranged_->failed_ = true;
+        }
+    }
+    // ... next ...
+    Next();
+}
+
+/**
+ * @brief Called when a range was written to file.
+ *
+ * @param a_error Error message, empty if none.
+ */
+void casper::proxy::worker::http::Deferred::OnRangeStored (const std::string& a_error)
+{
+    // ... (in)sanity checkpoint ...
+    CC_DEBUG_FAIL_IF_NOT_AT_MAIN_THREAD();
+    ranged_->in_flight_--;
+    if ( 0 != a_error.length() && false == ranged_->failed_ ) {
+        response_.Set(CC_EASY_HTTP_INTERNAL_SERVER_ERROR, a_error);
+        ranged_->failed_ = true;
+    }
+    // ... next ...
+    Next();
 }
 
 // MARK: - HTTP Client Callbacks
@@ -265,7 +1046,7 @@ void casper::proxy::worker::http::Deferred::OnHTTPRequestWillRunLogIt (const ::c
         ( ( HTTPOptions::Trace == ( HTTPOptions::Trace & a_options ) || ( HTTPOptions::Trace == ( HTTPOptions::Trace & http_options_ ) ) ) )
     ) {
         // ... must be done on 'looper' thread ...
-        const std::string tag = std::to_string(tracking_.bjid_) + "-" + tracking_.rjid_ + '-' + ::cc::ObjectHexAddr<::cc::easy::http::Client::Request>(&a_request) + "-log-http-oauth2-client-response";
+        const std::string tag = tags_(casper::proxy::worker::http::Tag::Hop::LogRequest);
         CallOnLooperThread(tag, [this, a_data, a_options] (const std::string&) {
             // ... log?
             if ( HTTPOptions::Log == ( HTTPOptions::Log & a_options ) ) {
@@ -297,7 +1078,7 @@ void casper::proxy::worker::http::Deferred::OnHTTPRequestSteppedLogIt (const ::c
     ) {
         const uint16_t code = a_value.code();
         // ... must be done on 'looper' thread ...
-        const std::string tag = std::to_string(tracking_.bjid_) + "-" + tracking_.rjid_ + '-' + ::cc::ObjectHexAddr<::cc::easy::http::Client::Value>(&a_value) + "-log-http-oauth2-step";
+        const std::string tag = tags_(casper::proxy::worker::http::Tag::Hop::LogStep);
         CallOnLooperThread(tag, [this, a_data, a_options, code] (const std::string&) {
             // ... log?
             if ( HTTPOptions::Log == ( HTTPOptions::Log & a_options ) ) {
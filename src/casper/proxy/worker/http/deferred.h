@@ -25,12 +25,16 @@
 #include "casper/job/deferrable/deferred.h"
 
 #include "casper/proxy/worker/http/types.h"
+#include "casper/proxy/worker/http/loops.h"
+#include "casper/proxy/worker/http/tag.h"
+#include "casper/proxy/worker/fs/writer.h"
 
 #include "cc/easy/http/client.h"
 
 #include "cc/bitwise_enum.h"
 
 #include <vector>
+#include <deque>
 
 namespace casper
 {
@@ -65,6 +69,32 @@ namespace casper
                         const std::string data_; //!< if code is NOT 0 it's request data otherwise it's response.
                     } HTTPTrace;
 
+                    typedef struct {
+                        uint64_t offset_;   //!< first byte
+                        uint64_t length_;   //!< number of bytes
+                        uint8_t  attempts_; //!< number of failed attempts
+                    } Range;
+
+                    typedef struct {
+                        uint64_t                               size_;      //!< file size, as announced by probe
+                        std::string                            validator_; //!< probe 'ETag' or 'Last-Modified', to detect changes between ranges
+                        std::deque<Range>                      pending_;   //!< ranges not requested yet, or to be resumed
+                        std::vector<::cc::easy::http::Client*> clients_;   //!< one per connection, reused by consecutive ranges
+                        std::vector<bool>                      busy_;      //!< true while client is performing a request
+                        size_t                                 in_flight_; //!< number of requests and writes in progress
+                        fs::Writer*                            writer_;    //!< preallocated file
+                        bool                                   failed_;    //!< true when no more ranges should be requested
+                        bool                                   looped_;    //!< true if ranges are requested using \link Loops \link, clients_ is empty
+                        bool                                   honoured_;  //!< true once a range was received, until then only one is requested at a time
+                    } Ranged;
+
+                public: // Static Const Data
+
+                    constexpr static const size_t   sk_base64_slice_size_     = 3 * 256 * 1024;   //!< multiple of 3, so only the last slice is padded
+                    constexpr static const uint8_t  sk_max_range_connections_ = 16;
+                    constexpr static const uint64_t sk_range_size_            = 8 * 1024 * 1024;  //!< default maximum range size, bounds memory to connections x range size
+                    constexpr static const uint8_t  sk_range_max_attempts_    = 3;                //!< per range
+
                 private: // Const Data
 
                     const ev::Loggable::Data& loggable_data_;
@@ -75,6 +105,17 @@ namespace casper
                     HTTPOptions               http_options_;
                     std::vector<HTTPTrace>    http_trace_;
 
+                private: // Data
+
+                    bool                      processed_; //!< True if post-processing was already attempted.
+                    bool                      prepared_;  //!< True if job payload was built by post-processing.
+                    Json::Value               payload_;   //!< Job payload, built by post-processing.
+                    std::string               error_;     //!< Post-processing error message, if any.
+                    Ranged*                   ranged_;    //!< Ranged download state, nullptr if not in use.
+                    bool                      written_;   //!< True if response body was already written to file, by ranges or by linking a previous download.
+                    bool                      revalidate_; //!< True while a previous download is being revalidated, see \link Index \link.
+                    casper::proxy::worker::http::Tag tags_; //!< Main / looper thread hop tags.
+
                 public: // Constructor(s) / Destructor
 
                     Deferred (const ::casper::job::deferrable::Tracking& a_tracking, const ev::Loggable::Data& a_loggable_data
@@ -88,12 +129,33 @@ namespace casper
                 private: // Method(s) / Function(s)
 
                     void Finalize               (const std::string& a_tag);
+                    void Conclude               (const std::string& a_tag);
+                    void Notify                 ();
+                    bool PostProcess            (const std::string& a_tag, const bool a_looper);
+                    void Perform                ();
+                    bool Offload                ();
+                    bool Loopable               () const;
+                    void Setup                  (::cc::easy::http::Client& a_client);
+                    void Unconditional          (::cc::easy::http::Client::Headers& io_headers) const;
+                    bool Revalidated            (const ::cc::easy::http::Client::Value& a_value);
+                    bool Revalidated            (const uint16_t a_code, std::map<std::string, std::string>& a_headers, const size_t a_rtt, const std::string& a_tag);
+
+                private: // Method(s) / Function(s) - Ranged Download
+
+                    void Probe                  ();
+                    void OnProbeCompleted       (const ::cc::easy::http::Client::Value& a_value);
+                    void Next                   ();
+                    void Fetch                  (const size_t a_slot, const Range a_range);
+                    void OnRangeCompleted       (const size_t a_slot, const Range a_range, const uint16_t a_code, const std::string& a_content_range, const std::string& a_body);
+                    void OnRangeFailed          (const size_t a_slot, Range a_range, const uint16_t a_code, const std::string& a_message);
+                    void OnRangeStored          (const std::string& a_error);
 
                 private: // Method(s) / Function(s) - HTTP Client Request(s) Callbacks
 
                     void OnHTTPRequestCompleted (const ::cc::easy::http::Client::Value& a_value);
                     void OnHTTPRequestError     (const ::cc::easy::http::Client::Error& a_error);
                     void OnHTTPRequestFailure   (const ::cc::Exception& a_exception);
+                    void OnLoopRequestCompleted (Loops::Result& a_result);
                     
                 private: // Method(s) / Function(s) - HTTP Client Logging Callbacks
 
@@ -105,6 +167,34 @@ namespace casper
                     void OnHTTPRequestWillRunLogIt (const ::cc::easy::http::Client::Request&, const std::string&, const HTTPOptions);
                     void OnHTTPRequestSteppedLogIt (const ::cc::easy::http::Client::Value&, const std::string&, const HTTPOptions);
 
+                public: // Method(s) / Function(s)
+
+                    void TakePayload (Json::Value& o_payload);
+
+                public: // Inline Method(s) / Function(s)
+
+                    /**
+                     * @return True if job payload was already built ( off the looper thread ), see \link TakePayload \link.
+                     */
+                    inline bool prepared () const
+                    {
+                        return prepared_;
+                    }
+
+                    /**
+                     * @return True if response body was already written to file, by a ranged download or by linking a previous download.
+                     */
+                    inline bool written () const
+                    {
+                        return written_;
+                    }
+
+                public: // Static Method(s) / Function(s)
+
+                    static void BuildPayload (const casper::proxy::worker::http::Parameters& a_parameters, const ::casper::job::deferrable::Response& a_response,
+                                              Json::Value& o_payload, const bool a_written = false);
+                    static void Write        (const casper::proxy::worker::http::Parameters::HTTPResponse& a_config, const std::string& a_body);
+
                 }; // end of class 'Deferred'
 
                 inline std::string MakeID (const ::casper::job::deferrable::Tracking& a_tracking)
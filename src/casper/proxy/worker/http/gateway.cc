@@ -0,0 +1,159 @@
+/**
+ * @file gateway.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/proxy/worker/http/gateway.h"
+
+#include "cc/exception.h"
+
+#include "cc/types.h"
+
+/**
+ * @brief Write a V2 frame body chunk.
+ *
+ * @param a_data   Chunk data.
+ * @param a_length Chunk length, in bytes, must fit in 32 bits and should not be 0 ( a 0 length chunk terminates the frame ).
+ * @param a_sink   Function to call to write data.
+ */
+void casper::proxy::worker::http::Gateway::Chunk (const char* const a_data, const size_t a_length, const casper::proxy::worker::http::Gateway::Sink& a_sink)
+{
+    if ( 0 == a_length ) {
+        return;
+    }
+    if ( a_length > 0xFFFFFFFF ) {
+        throw ::cc::Exception("Invalid gateway chunk: length " SIZET_FMT " out of bounds!", a_length);
+    }
+    char buffer[4];
+    BigEndian(buffer, a_length);
+    a_sink(buffer, sizeof(buffer));
+    a_sink(a_data, a_length);
+}
+
+/**
+ * @brief Write a V2 frame tail.
+ *
+ * @param a_sink Function to call to write data.
+ */
+void casper::proxy::worker::http::Gateway::Tail (const casper::proxy::worker::http::Gateway::Sink& a_sink)
+{
+    const char buffer[4] = { 0, 0, 0, 0 };
+    a_sink(buffer, sizeof(buffer));
+}
+
+/**
+ * @brief Decode a response in gateway format ( V1 or V2 ).
+ *
+ * @param a_data    Encoded response.
+ * @param o_message Decoded response.
+ */
+void casper::proxy::worker::http::Gateway::Decode (const std::string& a_data, casper::proxy::worker::http::Gateway::Message& o_message)
+{
+    const char*       p   = a_data.c_str();
+    const char* const end = p + a_data.length();
+    
+    // ... V2?
+    if ( a_data.length() >= 2 && '@' == p[0] && '2' == p[1] ) {
+        p += 2;
+        const auto u32 = [&p, &end] () -> size_t {
+            if ( static_cast<size_t>(end - p) < 4 ) {
+                throw ::cc::Exception("Invalid gateway data: truncated frame!");
+            }
+            const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+            p += 4;
+            return ( static_cast<size_t>(u[0]) << 24 ) | ( static_cast<size_t>(u[1]) << 16 ) | ( static_cast<size_t>(u[2]) << 8 ) | static_cast<size_t>(u[3]);
+        };
+        const auto bytes = [&p, &end] (const size_t a_length, std::string& o_value) {
+            if ( static_cast<size_t>(end - p) < a_length ) {
+                throw ::cc::Exception("Invalid gateway data: field length " SIZET_FMT " out of bounds!", a_length);
+            }
+            o_value.append(p, a_length);
+            p += a_length;
+        };
+        if ( static_cast<size_t>(end - p) < 2 ) {
+            throw ::cc::Exception("Invalid gateway data: truncated frame!");
+        }
+        o_message.code_ = static_cast<uint16_t>(( static_cast<uint16_t>(static_cast<unsigned char>(p[0])) << 8 ) | static_cast<unsigned char>(p[1]));
+        p += 2;
+        const size_t count = u32();
+        o_message.content_type_.clear();
+        bytes(u32(), o_message.content_type_);
+        o_message.headers_.clear();
+        for ( size_t idx = 0 ; idx < count ; ++idx ) {
+            std::string name, value;
+            bytes(u32(), name);
+            bytes(u32(), value);
+            o_message.headers_.push_back(std::make_pair(name, value));
+        }
+        o_message.body_.clear();
+        for ( size_t length = u32() ; 0 != length ; length = u32() ) {
+            bytes(length, o_message.body_);
+        }
+        if ( p != end ) {
+            throw ::cc::Exception("Invalid gateway data: unexpected data after frame tail!");
+        }
+        // ... done ...
+        return;
+    }
+    
+    // ... V1 ...
+    const auto number = [&p, &end, &a_data] () -> size_t {
+        const char* start = p;
+        size_t      value = 0;
+        while ( p < end && *p >= '0' && *p <= '9' ) {
+            value = ( value * 10 ) + static_cast<size_t>(*p - '0');
+            p++;
+        }
+        if ( start == p ) {
+            throw ::cc::Exception("Invalid gateway data: expecting a number at offset " SIZET_FMT "!", static_cast<size_t>(start - a_data.c_str()));
+        }
+        return value;
+    };
+    const auto field = [&p, &end, &a_data, &number] (std::string& o_value) {
+        if ( p >= end || ',' != *p ) {
+            throw ::cc::Exception("Invalid gateway data: expecting ',' at offset " SIZET_FMT "!", static_cast<size_t>(p - a_data.c_str()));
+        }
+        p++;
+        const size_t length = number();
+        if ( p >= end || ',' != *p || static_cast<size_t>(end - p - 1) < length ) {
+            throw ::cc::Exception("Invalid gateway data: field length " SIZET_FMT " out of bounds!", length);
+        }
+        p++;
+        o_value.assign(p, length);
+        p += length;
+    };
+    
+    if ( p >= end || '!' != *p ) {
+        throw ::cc::Exception("Invalid gateway data: expecting '!' at offset 0!");
+    }
+    p++;
+    o_message.code_ = static_cast<uint16_t>(number());
+    field(o_message.content_type_);
+    field(o_message.body_);
+    o_message.headers_.clear();
+    std::string header;
+    while ( p < end ) {
+        field(header);
+        const size_t colon = header.find(':');
+        if ( std::string::npos == colon ) {
+            throw ::cc::Exception("Invalid gateway data: invalid header '%s'!", header.c_str());
+        }
+        o_message.headers_.push_back(std::make_pair(header.substr(0, colon), header.substr(colon + 1)));
+    }
+}
@@ -0,0 +1,303 @@
+/**
+ * @file gateway.h
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#ifndef CASPER_PROXY_WORKER_HTTP_GATEWAY_H_
+#define CASPER_PROXY_WORKER_HTTP_GATEWAY_H_
+
+#include "casper/proxy/worker/fs/spill.h"
+#include "casper/proxy/worker/fs/writer.h"
+
+#include "cc/non-movable.h"
+#include "cc/exception.h"
+#include "cc/fs/file.h"
+
+#include "json/json.h"
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <utility> // std::pair
+#include <string.h> // memcpy
+
+namespace casper
+{
+
+    namespace proxy
+    {
+
+        namespace worker
+        {
+
+            namespace http
+            {
+
+                //
+                // Gateway ( a.k.a. 'primitive' ) response formats:
+                //
+                // V1 ( 'gateway' behaviour ), text:
+                //
+                // !<status-code-int-value>,<content-type-length-in-bytes>,<content-type-string-value>,<body-length-bytes>,<body>[,<header-length-bytes>,<header-name>:<header-value>]*
+                //
+                // V2 ( 'gateway-v2' behaviour ), binary, all integers are unsigned big-endian, all fields are raw bytes,
+                // delivered as a file in the tmp output area ( payload { "url": <string>, "size": <numeric> } ), never inlined in JSON:
+                //
+                // '@' '2' <status-code:u16> <headers-count:u32> <content-type-length:u32> <content-type>
+                //         [<header-name-length:u32> <header-name> <header-value-length:u32> <header-value>]*
+                //         [<chunk-length:u32> <chunk>]* <0:u32>
+                //
+                class Gateway final : public ::cc::NonMovable
+                {
+
+                public: // Data Type(s)
+
+                    enum class Format : uint8_t {
+                        V1 = 1,
+                        V2 = 2
+                    };
+
+                    typedef std::function<void(const char* const, const size_t)> Sink;
+
+                public: // Static Const Data
+
+                    constexpr static const size_t sk_v2_chunk_size_ = 1024 * 1024; //!< default V2 body chunk size, in bytes
+
+                    typedef struct {
+                        uint16_t                                         code_;
+                        std::string                                      content_type_;
+                        std::string                                      body_;
+                        std::vector<std::pair<std::string, std::string>> headers_;
+                    } Message;
+
+                public: // Constructor(s) / Destructor
+
+                    Gateway () = delete;
+                    Gateway (const Gateway&) = delete;
+
+                public: // Overloaded Operator(s)
+
+                    void operator = (Gateway const&) = delete;  // assignment is not allowed
+
+                public: // Static Method(s) / Function(s)
+
+                    static void Decode (const std::string& a_data, Message& o_message);
+                    static void Chunk  (const char* const a_data, const size_t a_length, const Sink& a_sink);
+                    static void Tail   (const Sink& a_sink);
+
+                public: // Static Template Method(s) / Function(s)
+
+                    /**
+                     * @brief Encode a response in gateway format.
+                     *
+                     * V1 is encoded to a single buffer, output size is computed first so only one buffer is allocated, and set as payload 'data'.
+                     * V2 is binary, so it can't be carried by a JSON payload: the frame is streamed to a file in the output directory and
+                     * payload 'url' and 'size' are set instead.
+                     *
+                     * @param a_format       One of \link Format \link.
+                     * @param a_code         Status code.
+                     * @param a_content_type Content-Type.
+                     * @param a_body         Body.
+                     * @param a_body_length  Body length, in bytes.
+                     * @param a_headers      Headers, any container of std::pair<std::string, std::string> like values.
+                     * @param a_output       Where V2 frames are written to, see \link fs::Spill \link.
+                     * @param o_payload      JSON object where 'data', or 'url' and 'size', will be set.
+                     */
+                    template <typename H>
+                    static void Encode (const Format a_format,
+                                        const uint16_t a_code, const std::string& a_content_type, const char* const a_body, const size_t a_body_length,
+                                        const H& a_headers, const fs::Spill::Config& a_output, Json::Value& o_payload)
+                    {
+                        // ... binary?
+                        if ( Format::V2 == a_format ) {
+                            if ( 0 == a_output.dir_.length() ) {
+                                throw ::cc::Exception("Unable to encode gateway V2 frame: output directory not set!");
+                            }
+                            // ... head is small, write it to a single buffer ...
+                            std::string head;
+                            Head(a_code, a_content_type, a_headers, [&head] (const char* const a_data, const size_t a_length) {
+                                head.append(a_data, a_length);
+                            });
+                            // ... compute exact size ...
+                            const size_t size = head.length() + ( ( a_body_length + sk_v2_chunk_size_ - 1 ) / sk_v2_chunk_size_ ) * 4 + a_body_length + 4;
+                            // ... stream it to file, body is written straight from it's buffer ...
+                            std::string uri;
+                            ::cc::fs::File::Unique(a_output.dir_, /* name */ "", "gw2", uri);
+                            fs::Writer writer(uri, size);
+                            const Sink sink = [&writer] (const char* const a_data, const size_t a_length) {
+                                writer.Append(reinterpret_cast<const unsigned char*>(a_data), a_length);
+                            };
+                            sink(head.c_str(), head.length());
+                            for ( size_t offset = 0 ; offset < a_body_length ; offset += sk_v2_chunk_size_ ) {
+                                Chunk(a_body + offset, ( a_body_length - offset > sk_v2_chunk_size_ ? sk_v2_chunk_size_ : a_body_length - offset ), sink);
+                            }
+                            Tail(sink);
+                            writer.Close();
+                            // ... set URL ...
+                            o_payload["url"]  = fs::Spill::URL(a_output, uri);
+                            o_payload["size"] = static_cast<Json::UInt64>(size);
+                            // ... done ...
+                            return;
+                        }
+                        // ... text, compute exact size ...
+                        size_t size = 1 + Digits(a_code) + Field(a_content_type.length()) + Field(a_body_length);
+                        for ( const auto& header : a_headers ) {
+                            size += Field(header.first.length() + 1 + header.second.length());
+                        }
+                        // ... write it ...
+                        std::string data;
+                        data.resize(size);
+                        char* p = &data[0];
+                        *(p++) = '!';
+                        p = Write(p, a_code);
+                        p = Write(p, a_content_type.c_str(), a_content_type.length());
+                        p = Write(p, a_body, a_body_length);
+                        for ( const auto& header : a_headers ) {
+                            p = Write(p, header.first.length() + 1 + header.second.length(), /* a_prefix */ true);
+                            memcpy(p, header.first.c_str(), header.first.length());
+                            p += header.first.length();
+                            *(p++) = ':';
+                            memcpy(p, header.second.c_str(), header.second.length());
+                            p += header.second.length();
+                        }
+                        // ... jsoncpp owns it's string buffers, so this is the only copy ...
+                        o_payload["data"] = Json::Value(data.c_str(), data.c_str() + data.length());
+                    }
+
+                    /**
+                     * @brief Write a V2 frame head, to be followed by zero or more \link Chunk \link calls and one \link Tail \link call.
+                     *
+                     * @param a_code         Status code.
+                     * @param a_content_type Content-Type.
+                     * @param a_headers      Headers, any container of std::pair<std::string, std::string> like values.
+                     * @param a_sink         Function to call to write data.
+                     */
+                    template <typename H>
+                    static void Head (const uint16_t a_code, const std::string& a_content_type, const H& a_headers, const Sink& a_sink)
+                    {
+                        char   buffer[12];
+                        size_t count = 0;
+                        for ( auto it = a_headers.begin() ; a_headers.end() != it ; ++it ) {
+                            count++;
+                        }
+                        buffer[0] = '@';
+                        buffer[1] = '2';
+                        buffer[2] = static_cast<char>(( a_code >> 8 ) & 0xFF);
+                        buffer[3] = static_cast<char>(a_code & 0xFF);
+                        BigEndian(buffer + 4, count);
+                        BigEndian(buffer + 8, a_content_type.length());
+                        a_sink(buffer, sizeof(buffer));
+                        a_sink(a_content_type.c_str(), a_content_type.length());
+                        for ( const auto& header : a_headers ) {
+                            BigEndian(buffer, header.first.length());
+                            a_sink(buffer, 4);
+                            a_sink(header.first.c_str(), header.first.length());
+                            BigEndian(buffer, header.second.length());
+                            a_sink(buffer, 4);
+                            a_sink(header.second.c_str(), header.second.length());
+                        }
+                    }
+
+                private: // Static Inline Method(s) / Function(s)
+
+                    /**
+                     * @brief Write a 32 bits unsigned big-endian value.
+                     */
+                    static inline void BigEndian (char* a_p, const size_t a_value)
+                    {
+                        a_p[0] = static_cast<char>(( a_value >> 24 ) & 0xFF);
+                        a_p[1] = static_cast<char>(( a_value >> 16 ) & 0xFF);
+                        a_p[2] = static_cast<char>(( a_value >>  8 ) & 0xFF);
+                        a_p[3] = static_cast<char>(a_value & 0xFF);
+                    }
+
+                    /**
+                     * @return Number of decimal digits required to represent a value.
+                     */
+                    static inline size_t Digits (size_t a_value)
+                    {
+                        size_t digits = 1;
+                        while ( a_value >= 10 ) {
+                            a_value /= 10;
+                            digits++;
+                        }
+                        return digits;
+                    }
+
+                    /**
+                     * @return Number of bytes required to write a ',<length>,<value>' field.
+                     */
+                    static inline size_t Field (const size_t a_length)
+                    {
+                        return 2 + Digits(a_length) + a_length;
+                    }
+
+                    /**
+                     * @brief Write a decimal value.
+                     *
+                     * @return Pointer to the next byte to write.
+                     */
+                    static inline char* Write (char* a_p, size_t a_value)
+                    {
+                        const size_t digits = Digits(a_value);
+                        for ( size_t idx = digits ; idx > 0 ; --idx ) {
+                            a_p[idx - 1] = static_cast<char>('0' + ( a_value % 10 ));
+                            a_value /= 10;
+                        }
+                        return a_p + digits;
+                    }
+
+                    /**
+                     * @brief Write a ',<length>,' prefix.
+                     *
+                     * @return Pointer to the next byte to write.
+                     */
+                    static inline char* Write (char* a_p, const size_t a_length, const bool /* a_prefix */)
+                    {
+                        *(a_p++) = ',';
+                        a_p = Write(a_p, a_length);
+                        *(a_p++) = ',';
+                        return a_p;
+                    }
+
+                    /**
+                     * @brief Write a ',<length>,<value>' field.
+                     *
+                     * @return Pointer to the next byte to write.
+                     */
+                    static inline char* Write (char* a_p, const char* const a_value, const size_t a_length)
+                    {
+                        a_p = Write(a_p, a_length, /* a_prefix */ true);
+                        if ( a_length > 0 ) {
+                            memcpy(a_p, a_value, a_length);
+                        }
+                        return a_p + a_length;
+                    }
+
+                }; // end of class 'Gateway'
+
+            } // end of namespace 'http'
+
+        } // end of namespace 'worker'
+
+    } // end of namespace 'proxy'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_PROXY_WORKER_HTTP_GATEWAY_H_
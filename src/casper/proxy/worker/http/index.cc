@@ -0,0 +1,167 @@
+/**
+ * @file index.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/proxy/worker/http/index.h"
+
+#include "cc/hash/sha256.h"
+
+#include <algorithm> // std::sort, std::transform, std::min_element
+#include <vector>
+
+#include <ctype.h>    // tolower
+#include <string.h>   // strcasecmp
+#include <sys/stat.h> // stat
+#include <time.h>     // time
+
+/**
+ * @brief Default constructor.
+ */
+casper::proxy::worker::http::Index::Index ()
+{
+    /* empty */
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::proxy::worker::http::Index::~Index ()
+{
+    /* empty */
+}
+
+/**
+ * @brief Find an unexpired download, whose file still exists.
+ *
+ * @param a_key   See \link Key \link.
+ * @param o_entry Entry to fill, only if found.
+ *
+ * @return True if found.
+ */
+bool casper::proxy::worker::http::Index::Find (const std::string& a_key, casper::proxy::worker::http::Index::Entry& o_entry)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = entries_.find(a_key);
+    if ( entries_.end() == it ) {
+        return false;
+    }
+    // ... expired or removed?
+    struct stat st;
+    if ( it->second.expires_ <= static_cast<int64_t>(time(nullptr)) || 0 != stat(it->second.uri_.c_str(), &st) || 0 == S_ISREG(st.st_mode) ) {
+        // ... forget it ...
+        entries_.erase(it);
+        return false;
+    }
+    o_entry = it->second;
+    return true;
+}
+
+/**
+ * @brief Keep track of a download, only if it can be revalidated.
+ *
+ * @param a_key      See \link Key \link.
+ * @param a_headers  Response headers.
+ * @param a_uri      Local file URI.
+ * @param a_validity Local file validity, in seconds.
+ */
+void casper::proxy::worker::http::Index::Set (const std::string& a_key, const std::map<std::string, std::string>& a_headers, const std::string& a_uri, const int64_t a_validity)
+{
+    Entry entry = {
+        /* uri_           */ a_uri,
+        /* etag_          */ Header(a_headers, "ETag"),
+        /* last_modified_ */ Header(a_headers, "Last-Modified"),
+        /* expires_       */ static_cast<int64_t>(time(nullptr)) + a_validity
+    };
+    // ... no validators or no validity, nothing to reuse ...
+    if ( a_validity <= 0 || ( 0 == entry.etag_.length() && 0 == entry.last_modified_.length() ) ) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    // ... full? make room, forgetting expired entries or, if none, the one closer to expire ...
+    if ( entries_.size() >= sk_max_entries_ && entries_.end() == entries_.find(a_key) ) {
+        const int64_t now = static_cast<int64_t>(time(nullptr));
+        for ( auto it = entries_.begin() ; entries_.end() != it ; ) {
+            if ( it->second.expires_ <= now ) {
+                it = entries_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        if ( entries_.size() >= sk_max_entries_ ) {
+            entries_.erase(std::min_element(entries_.begin(), entries_.end(), [] (const std::pair<const std::string, Entry>& a_lhs, const std::pair<const std::string, Entry>& a_rhs) {
+                return a_lhs.second.expires_ < a_rhs.second.expires_;
+            }));
+        }
+    }
+    entries_[a_key] = entry;
+}
+
+/**
+ * @brief Build a download key.
+ *
+ * @param a_method  HTTP method.
+ * @param a_url     URL, including query.
+ * @param a_headers Request headers, names are case insensitive and order is not relevant.
+ * @param a_base64  True if file is written base64 encoded.
+ *
+ * @return SHA256 of all provided data, so that credentials present in headers are not kept.
+ */
+std::string casper::proxy::worker::http::Index::Key (const ::cc::easy::http::Client::Method a_method, const std::string& a_url, const ::cc::easy::http::Client::Headers& a_headers,
+                                                     const bool a_base64)
+{
+    std::vector<std::string> headers;
+    for ( const auto& header : a_headers ) {
+        std::string line = header.first;
+        std::transform(line.begin(), line.end(), line.begin(), [] (const char a_char) { return static_cast<char>(tolower(a_char)); });
+        // ... revalidation headers are not part of the request identity ...
+        if ( 0 == strcasecmp(line.c_str(), "if-none-match") || 0 == strcasecmp(line.c_str(), "if-modified-since") ) {
+            continue;
+        }
+        line += ':';
+        for ( size_t idx = 0 ; idx < header.second.size() ; ++idx ) {
+            line += ( 0 == idx ? "" : "," ) + header.second[idx];
+        }
+        headers.push_back(line);
+    }
+    std::sort(headers.begin(), headers.end());
+    std::string data = std::to_string(static_cast<int>(a_method)) + '\n' + a_url + '\n' + ( true == a_base64 ? "base64" : "raw" ) + '\n';
+    for ( const auto& line : headers ) {
+        data += line + '\n';
+    }
+    return ::cc::hash::SHA256::Calculate(data);
+}
+
+/**
+ * @brief Case insensitive lookup of a response header.
+ *
+ * @param a_headers Response headers.
+ * @param a_name    Header name.
+ *
+ * @return Header value, empty if not present.
+ */
+std::string casper::proxy::worker::http::Index::Header (const std::map<std::string, std::string>& a_headers, const char* const a_name)
+{
+    for ( const auto& header : a_headers ) {
+        if ( 0 == strcasecmp(header.first.c_str(), a_name) ) {
+            return header.second;
+        }
+    }
+    return "";
+}
@@ -0,0 +1,119 @@
+/**
+ * @file index.h
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#ifndef CASPER_PROXY_WORKER_HTTP_INDEX_H_
+#define CASPER_PROXY_WORKER_HTTP_INDEX_H_
+
+#include "cc/non-movable.h"
+
+#include "cc/easy/http/client.h"
+
+#include <string>
+#include <map>
+#include <mutex>
+
+#include <stdint.h>
+
+namespace casper
+{
+
+    namespace proxy
+    {
+
+        namespace worker
+        {
+
+            namespace http
+            {
+
+                //
+                // Process wide index of recent 'to_file' downloads:
+                //
+                // - keyed by method, URL, request headers and output format, so a download is only reused by identical requests;
+                // - entries keep response validators so that a repeated request can be revalidated with a conditional GET and,
+                //   if unchanged ( 304 ), the previous file is hard linked instead of downloaded again;
+                // - entries expire with the file they point to.
+                //
+                class Index final : public ::cc::NonMovable
+                {
+
+                public: // Data Type(s)
+
+                    typedef struct {
+                        std::string uri_;           //!< local file URI
+                        std::string etag_;          //!< 'ETag' response header, if any
+                        std::string last_modified_; //!< 'Last-Modified' response header, if any
+                        int64_t     expires_;       //!< file expiration, in seconds since epoch
+                    } Entry;
+
+                public: // Static Const Data
+
+                    constexpr static const size_t sk_max_entries_ = 4096;
+
+                private: // Data
+
+                    std::mutex                   mutex_;
+                    std::map<std::string, Entry> entries_; //!< by key, see \link Key \link
+
+                private: // Constructor(s) / Destructor
+
+                    Index ();
+                    virtual ~Index ();
+
+                public: // Constructor(s) / Destructor
+
+                    Index (const Index&) = delete;
+
+                public: // Overloaded Operator(s)
+
+                    void operator = (Index const&) = delete;  // assignment is not allowed
+
+                public: // Method(s) / Function(s)
+
+                    bool Find (const std::string& a_key, Entry& o_entry);
+                    void Set  (const std::string& a_key, const std::map<std::string, std::string>& a_headers, const std::string& a_uri, const int64_t a_validity);
+
+                public: // Static Method(s) / Function(s)
+
+                    static std::string Key    (const ::cc::easy::http::Client::Method a_method, const std::string& a_url, const ::cc::easy::http::Client::Headers& a_headers,
+                                               const bool a_base64);
+                    static std::string Header (const std::map<std::string, std::string>& a_headers, const char* const a_name);
+
+                    /**
+                     * @return Process wide instance.
+                     */
+                    static Index& GetInstance ()
+                    {
+                        static Index instance;
+                        return instance;
+                    }
+
+                }; // end of class 'Index'
+
+            } // end of namespace 'http'
+
+        } // end of namespace 'worker'
+
+    } // end of namespace 'proxy'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_PROXY_WORKER_HTTP_INDEX_H_
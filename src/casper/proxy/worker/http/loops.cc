@@ -0,0 +1,379 @@
+/**
+ * @file loops.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/proxy/worker/http/loops.h"
+
+#include "cc/exception.h"
+#include "cc/types.h"
+
+#include <algorithm> // std::min, std::max, std::transform
+
+#include <ctype.h>  // tolower
+#include <string.h> // strncmp, memchr
+
+/**
+ * @brief Default constructor.
+ */
+casper::proxy::worker::http::Loops::Loops ()
+    : affinity_(casper::proxy::worker::http::Loops::Affinity::RoundRobin), spread_(1), count_(0), next_(0), stop_(false)
+{
+    /* empty */
+}
+
+/**
+ * @brief Destructor, requests in progress are abandoned ( callbacks are not called ).
+ */
+casper::proxy::worker::http::Loops::~Loops ()
+{
+    stop_ = true;
+    for ( auto loop : loops_ ) {
+        (void)curl_multi_wakeup(loop->multi_);
+        loop->thread_.join();
+        Transfer* pending = nullptr;
+        while ( true == loop->pending_.Pop(pending) ) {
+            delete pending;
+        }
+        for ( auto transfer : loop->active_ ) {
+            (void)curl_multi_remove_handle(loop->multi_, transfer->easy_);
+            curl_easy_cleanup(transfer->easy_);
+            curl_slist_free_all(transfer->headers_);
+            delete transfer;
+        }
+        (void)curl_multi_cleanup(loop->multi_);
+        delete loop;
+    }
+}
+
+/**
+ * @brief Start I/O loops, only the first call has effect.
+ *
+ * @param a_count    Number of loops, 0 keeps this pool disabled.
+ * @param a_affinity How requests are assigned to loops, one of \link Affinity \link.
+ * @param a_spread   Number of loops each host is spread over, \link Affinity::Host \link only, 0 or 1 pins a host to a single loop.
+ */
+void casper::proxy::worker::http::Loops::Start (const size_t a_count, const casper::proxy::worker::http::Loops::Affinity a_affinity, const size_t a_spread)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if ( 0 != loops_.size() ) {
+        return;
+    }
+    affinity_ = a_affinity;
+    spread_   = std::max(a_spread, static_cast<size_t>(1));
+    for ( size_t idx = 0 ; idx < std::min(a_count, static_cast<size_t>(sk_max_loops_)) ; ++idx ) {
+        Loop* loop = new Loop();
+        loop->multi_ = curl_multi_init();
+        if ( nullptr == loop->multi_ ) {
+            delete loop;
+            // ... loops already started are still usable ...
+            count_.store(loops_.size(), std::memory_order_release);
+            throw ::cc::Exception("Unable to initialize cURL multi handle for I/O loop #" SIZET_FMT "!", idx);
+        }
+        loop->thread_ = std::thread(&casper::proxy::worker::http::Loops::Run, this, loop);
+        loops_.push_back(loop);
+    }
+    // ... from now on loops_, affinity_ and spread_ are read only, submitters don't need to lock ...
+    count_.store(loops_.size(), std::memory_order_release);
+}
+
+/**
+ * @brief Submit an HTTP request to one of this pool loops.
+ *
+ * @param a_request  Request to perform.
+ * @param a_callback Function to call, @ loop thread, when it's done.
+ *
+ * @return True if request was accepted, false if this pool is disabled, if loop queue is full or if method is not supported - caller should perform it.
+ */
+bool casper::proxy::worker::http::Loops::Submit (const casper::proxy::worker::http::Loops::Request& a_request, casper::proxy::worker::http::Loops::Callback a_callback)
+{
+    if ( nullptr == Method(a_request.method_) ) {
+        return false;
+    }
+    const size_t count = count_.load(std::memory_order_acquire);
+    if ( true == stop_ || 0 == count ) {
+        return false;
+    }
+    Loop* loop;
+    // ... same host, same few loops, so it's connections can be reused without pinning all of it's traffic to one thread ...
+    if ( casper::proxy::worker::http::Loops::Affinity::Host == affinity_ ) {
+        const size_t spread = std::min(spread_, count);
+        loop = loops_[( std::hash<std::string>()(Host(a_request.url_)) + ( 1 == spread ? 0 : next_.fetch_add(1, std::memory_order_relaxed) % spread ) ) % count];
+    } else {
+        loop = loops_[next_.fetch_add(1, std::memory_order_relaxed) % count];
+    }
+    Transfer* transfer = new Transfer();
+    transfer->easy_          = nullptr;
+    transfer->headers_       = nullptr;
+    transfer->request_       = a_request;
+    transfer->result_.code_  = 0;
+    transfer->result_.rtt_   = 0;
+    transfer->result_.error_ = CURLE_OK;
+    transfer->callback_      = std::move(a_callback);
+    transfer->error_[0]      = '\0';
+    if ( false == loop->pending_.Push(transfer) ) {
+        // ... too many requests waiting to be started ...
+        delete transfer;
+        return false;
+    }
+    // ... loop might be waiting for sockets activity ...
+    (void)curl_multi_wakeup(loop->multi_);
+    return true;
+}
+
+/**
+ * @brief Loop thread.
+ *
+ * @param a_loop Loop to run.
+ */
+void casper::proxy::worker::http::Loops::Run (casper::proxy::worker::http::Loops::Loop* a_loop)
+{
+    int      running = 0;
+    int      left    = 0;
+    CURLMsg* message = nullptr;
+    while ( false == stop_ ) {
+        // ... start submitted requests ...
+        Transfer* transfer = nullptr;
+        while ( true == a_loop->pending_.Pop(transfer) ) {
+            Perform(a_loop, transfer);
+        }
+        // ... move data ...
+        (void)curl_multi_perform(a_loop->multi_, &running);
+        // ... and report completed requests ...
+        while ( nullptr != ( message = curl_multi_info_read(a_loop->multi_, &left) ) ) {
+            if ( CURLMSG_DONE != message->msg ) {
+                continue;
+            }
+            Transfer* completed = nullptr;
+            (void)curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, &completed);
+            Complete(a_loop, completed, message->data.result);
+        }
+        // ... wait for sockets activity, timeouts or submissions ...
+        (void)curl_multi_poll(a_loop->multi_, nullptr, 0, 1000, nullptr);
+    }
+}
+
+/**
+ * @brief Start performing a request, @ loop thread.
+ *
+ * @param a_loop     Loop that will perform it.
+ * @param a_transfer Request to perform.
+ */
+void casper::proxy::worker::http::Loops::Perform (casper::proxy::worker::http::Loops::Loop* a_loop, casper::proxy::worker::http::Loops::Transfer* a_transfer)
+{
+    const Request& request = a_transfer->request_;
+    a_transfer->easy_ = curl_easy_init();
+    if ( nullptr == a_transfer->easy_ ) {
+        Complete(a_loop, a_transfer, CURLE_FAILED_INIT);
+        return;
+    }
+    CURL* easy = a_transfer->easy_;
+    // ... headers ...
+    for ( const auto& header : request.headers_ ) {
+        for ( const auto& value : header.second ) {
+            // ... 'name;' is how cURL is told to send a header without value ...
+            a_transfer->headers_ = curl_slist_append(a_transfer->headers_, ( 0 != value.length() ? header.first + ": " + value : header.first + ";" ).c_str());
+        }
+    }
+    (void)curl_easy_setopt(easy, CURLOPT_PRIVATE       , a_transfer);
+    (void)curl_easy_setopt(easy, CURLOPT_URL           , request.url_.c_str());
+    (void)curl_easy_setopt(easy, CURLOPT_NOSIGNAL      , 1L);
+    (void)curl_easy_setopt(easy, CURLOPT_ERRORBUFFER   , a_transfer->error_);
+    (void)curl_easy_setopt(easy, CURLOPT_HTTPHEADER    , a_transfer->headers_);
+    (void)curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION , &casper::proxy::worker::http::Loops::OnBody);
+    (void)curl_easy_setopt(easy, CURLOPT_WRITEDATA     , a_transfer);
+    (void)curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION, &casper::proxy::worker::http::Loops::OnHeader);
+    (void)curl_easy_setopt(easy, CURLOPT_HEADERDATA    , a_transfer);
+    if ( 0 != request.user_agent_.length() ) {
+        (void)curl_easy_setopt(easy, CURLOPT_USERAGENT, request.user_agent_.c_str());
+    }
+    if ( true == request.follow_location_ ) {
+        (void)curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+    }
+    if ( request.timeouts_.connection_ > 0 ) {
+        (void)curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT, static_cast<long>(request.timeouts_.connection_));
+    }
+    if ( request.timeouts_.operation_ > 0 ) {
+        (void)curl_easy_setopt(easy, CURLOPT_TIMEOUT, static_cast<long>(request.timeouts_.operation_));
+    }
+    // ... announced size is checked by cURL, chunked bodies are checked by OnBody ...
+    if ( request.max_body_ > 0 ) {
+        (void)curl_easy_setopt(easy, CURLOPT_MAXFILESIZE_LARGE, static_cast<curl_off_t>(request.max_body_));
+    }
+    // ... method and body, ⚠️ body is not copied by cURL, it's kept alive by transfer ...
+    switch (request.method_) {
+        case ::cc::easy::http::Client::Method::HEAD:
+            (void)curl_easy_setopt(easy, CURLOPT_NOBODY, 1L);
+            break;
+        case ::cc::easy::http::Client::Method::GET:
+            (void)curl_easy_setopt(easy, CURLOPT_HTTPGET, 1L);
+            break;
+        case ::cc::easy::http::Client::Method::DELETE:
+            (void)curl_easy_setopt(easy, CURLOPT_CUSTOMREQUEST, Method(request.method_));
+            if ( 0 != request.body_.length() ) {
+                (void)curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(request.body_.length()));
+                (void)curl_easy_setopt(easy, CURLOPT_POSTFIELDS         , request.body_.c_str());
+            }
+            break;
+        default:
+            (void)curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(request.body_.length()));
+            (void)curl_easy_setopt(easy, CURLOPT_POSTFIELDS         , request.body_.c_str());
+            if ( ::cc::easy::http::Client::Method::POST != request.method_ ) {
+                (void)curl_easy_setopt(easy, CURLOPT_CUSTOMREQUEST, Method(request.method_));
+            }
+            break;
+    }
+    // ... go ...
+    const CURLMcode rv = curl_multi_add_handle(a_loop->multi_, easy);
+    if ( CURLM_OK != rv ) {
+        a_transfer->result_.message_ = curl_multi_strerror(rv);
+        Complete(a_loop, a_transfer, CURLE_FAILED_INIT);
+        return;
+    }
+    a_loop->active_.insert(a_transfer);
+}
+
+/**
+ * @brief Report a request result and release it, @ loop thread.
+ *
+ * @param a_loop     Loop that was performing it.
+ * @param a_transfer Request.
+ * @param a_code     cURL result code.
+ */
+void casper::proxy::worker::http::Loops::Complete (casper::proxy::worker::http::Loops::Loop* a_loop, casper::proxy::worker::http::Loops::Transfer* a_transfer, const CURLcode a_code)
+{
+    Result& result = a_transfer->result_;
+    result.error_ = a_code;
+    if ( nullptr != a_transfer->easy_ ) {
+        long   code  = 0;
+        double total = 0;
+        (void)curl_easy_getinfo(a_transfer->easy_, CURLINFO_RESPONSE_CODE, &code);
+        (void)curl_easy_getinfo(a_transfer->easy_, CURLINFO_TOTAL_TIME   , &total);
+        result.code_ = ( CURLE_OK == a_code ? static_cast<uint16_t>(code) : 0 );
+        result.rtt_  = static_cast<size_t>(total * 1000);
+        (void)curl_multi_remove_handle(a_loop->multi_, a_transfer->easy_);
+        curl_easy_cleanup(a_transfer->easy_);
+    }
+    curl_slist_free_all(a_transfer->headers_);
+    if ( CURLE_OK != a_code && 0 == result.message_.length() ) {
+        result.message_ = ( '\0' != a_transfer->error_[0] ? a_transfer->error_ : curl_easy_strerror(a_code) );
+    }
+    a_loop->active_.erase(a_transfer);
+    try {
+        a_transfer->callback_(result);
+    } catch (...) {
+        // ... callbacks must handle their own exceptions, never let one kill this thread ...
+    }
+    delete a_transfer;
+}
+
+// MARK: - Static Method(s) / Function(s)
+
+/**
+ * @brief cURL body callback.
+ */
+size_t casper::proxy::worker::http::Loops::OnBody (char* a_data, size_t a_size, size_t a_count, void* a_transfer)
+{
+    Transfer* transfer = static_cast<Transfer*>(a_transfer);
+    // ... too big? abort it ( CURLE_WRITE_ERROR ) ...
+    if ( transfer->request_.max_body_ > 0 && transfer->result_.body_.length() + a_size * a_count > transfer->request_.max_body_ ) {
+        transfer->result_.message_ = "Response body exceeds " + std::to_string(transfer->request_.max_body_) + " byte(s)!";
+        return 0;
+    }
+    transfer->result_.body_.append(a_data, a_size * a_count);
+    return a_size * a_count;
+}
+
+/**
+ * @brief cURL header callback, called once per header line.
+ */
+size_t casper::proxy::worker::http::Loops::OnHeader (char* a_data, size_t a_size, size_t a_count, void* a_transfer)
+{
+    const size_t length  = a_size * a_count;
+    auto&        headers = static_cast<Transfer*>(a_transfer)->result_.headers_;
+    // ... status line: a new response ( redirect or interim ), only the last one headers are kept ...
+    if ( length >= 5 && 0 == strncmp(a_data, "HTTP/", 5) ) {
+        headers.clear();
+        return length;
+    }
+    const char* const end   = a_data + length;
+    const char*       colon = static_cast<const char*>(memchr(a_data, ':', length));
+    if ( nullptr == colon ) {
+        return length;
+    }
+    const char* value = colon + 1;
+    while ( value < end && ( ' ' == *value || '\t' == *value ) ) {
+        value++;
+    }
+    const char* last = end;
+    while ( last > value && ( '\r' == *( last - 1 ) || '\n' == *( last - 1 ) || ' ' == *( last - 1 ) ) ) {
+        last--;
+    }
+    const std::string name = std::string(a_data, static_cast<size_t>(colon - a_data));
+    auto it = headers.find(name);
+    if ( headers.end() != it ) {
+        it->second += ", " + std::string(value, static_cast<size_t>(last - value));
+    } else {
+        headers[name] = std::string(value, static_cast<size_t>(last - value));
+    }
+    return length;
+}
+
+/**
+ * @param a_method One of \link ::cc::easy::http::Client::Method \link.
+ *
+ * @return Method name, nullptr if not supported.
+ */
+const char* casper::proxy::worker::http::Loops::Method (const ::cc::easy::http::Client::Method a_method)
+{
+    switch (a_method) {
+        case ::cc::easy::http::Client::Method::HEAD:
+            return "HEAD";
+        case ::cc::easy::http::Client::Method::GET:
+            return "GET";
+        case ::cc::easy::http::Client::Method::DELETE:
+            return "DELETE";
+        case ::cc::easy::http::Client::Method::POST:
+            return "POST";
+        case ::cc::easy::http::Client::Method::PUT:
+            return "PUT";
+        case ::cc::easy::http::Client::Method::PATCH:
+            return "PATCH";
+        default:
+            return nullptr;
+    }
+}
+
+/**
+ * @param a_url URL.
+ *
+ * @return URL host ( and port ), lowercased.
+ */
+std::string casper::proxy::worker::http::Loops::Host (const std::string& a_url)
+{
+    size_t start = a_url.find("://");
+    start = ( std::string::npos == start ? 0 : start + 3 );
+    std::string host = a_url.substr(start, a_url.find_first_of("/?#", start) - start);
+    const size_t at = host.rfind('@');
+    if ( std::string::npos != at ) {
+        host = host.substr(at + 1);
+    }
+    std::transform(host.begin(), host.end(), host.begin(), [] (const unsigned char a_char) { return static_cast<char>(tolower(a_char)); });
+    return host;
+}
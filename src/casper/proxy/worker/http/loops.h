@@ -0,0 +1,194 @@
+/**
+ * @file loops.h
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#ifndef CASPER_PROXY_WORKER_HTTP_LOOPS_H_
+#define CASPER_PROXY_WORKER_HTTP_LOOPS_H_
+
+#include "cc/non-movable.h"
+
+#include "cc/easy/http/client.h"
+
+#include "casper/proxy/worker/executor/ring.h"
+
+#include <curl/curl.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <functional>
+
+namespace casper
+{
+
+    namespace proxy
+    {
+
+        namespace worker
+        {
+
+            namespace http
+            {
+
+                //
+                // Process wide pool of I/O loop threads, each one with it's own cURL multi handle.
+                //
+                // - by default all HTTP requests are performed by \link ::cc::easy::http::Client \link @ MAIN thread, so every
+                //   upstream socket of every tube is multiplexed on a single thread, this pool allows plain requests to be spread;
+                // - requests are assigned to loops round-robin ( default ), or by upstream host, spread over a few loops so that
+                //   connections are mostly reused but a hot upstream doesn't saturate a single loop thread;
+                // - callbacks are called on the loop thread, owners must hop back to their own thread;
+                // - disabled ( 0 loops ) until \link Start \link is called.
+                //
+                class Loops final : public ::cc::NonMovable
+                {
+
+                public: // Data Type(s)
+
+                    enum class Affinity : uint8_t {
+                        RoundRobin = 0,
+                        Host            //!< each host is spread over \link spread_ \link consecutive loops
+                    };
+
+                    typedef struct {
+                        ::cc::easy::http::Client::Method   method_;
+                        std::string                        url_;
+                        ::cc::easy::http::Client::Headers  headers_;
+                        std::string                        body_;
+                        ::cc::easy::http::Client::Timeouts timeouts_;        //!< in seconds, -1 if not set
+                        bool                               follow_location_;
+                        std::string                        user_agent_;
+                        uint64_t                           max_body_;        //!< abort transfer if body exceeds it, 0 if not limited
+                    } Request;
+
+                    typedef struct {
+                        uint16_t                           code_;    //!< HTTP status code, 0 if request was not performed
+                        std::map<std::string, std::string> headers_;
+                        std::string                        body_;
+                        size_t                             rtt_;     //!< in milliseconds
+                        CURLcode                           error_;   //!< CURLE_OK if request was performed
+                        std::string                        message_; //!< error message, if any
+                    } Result;
+
+                    typedef std::function<void(Result&)> Callback; //!< result can be moved from
+
+                private: // Data Type(s)
+
+                    typedef struct {
+                        CURL*              easy_;
+                        struct curl_slist* headers_;
+                        Request            request_;
+                        Result             result_;
+                        Callback           callback_;
+                        char               error_[CURL_ERROR_SIZE];
+                    } Transfer;
+
+                public: // Static Const Data
+
+                    constexpr static const size_t sk_max_loops_   = 32;
+                    constexpr static const size_t sk_max_pending_ = 1024; //!< per loop, submitted but not started yet, power of 2
+
+                private: // Data Type(s)
+
+                    typedef struct {
+                        CURLM*                                         multi_;
+                        std::thread                                    thread_;
+                        executor::Ring<Transfer*, sk_max_pending_>     pending_; //!< submitted, not started yet
+                        std::set<Transfer*>                            active_;  //!< started, only accessed by loop thread
+                    } Loop;
+
+                private: // Data
+
+                    std::mutex          mutex_;  //!< serializes \link Start \link calls only
+                    std::vector<Loop*>  loops_;  //!< immutable once \link count_ \link is published
+                    Affinity            affinity_;
+                    size_t              spread_; //!< number of loops each host is spread over, \link Affinity::Host \link only
+                    std::atomic<size_t> count_;  //!< number of started loops, published by \link Start \link
+                    std::atomic<size_t> next_;   //!< round-robin cursor
+                    std::atomic<bool>   stop_;   //!< true when shutting down
+
+                private: // Constructor(s) / Destructor
+
+                    Loops ();
+                    virtual ~Loops ();
+
+                public: // Constructor(s) / Destructor
+
+                    Loops (const Loops&) = delete;
+
+                public: // Overloaded Operator(s)
+
+                    void operator = (Loops const&) = delete;  // assignment is not allowed
+
+                public: // Method(s) / Function(s)
+
+                    void Start  (const size_t a_count, const Affinity a_affinity, const size_t a_spread);
+                    bool Submit (const Request& a_request, Callback a_callback);
+
+                private: // Method(s) / Function(s)
+
+                    void Run      (Loop* a_loop);
+                    void Perform  (Loop* a_loop, Transfer* a_transfer);
+                    void Complete (Loop* a_loop, Transfer* a_transfer, const CURLcode a_code);
+
+                private: // Static Method(s) / Function(s)
+
+                    static size_t OnBody   (char* a_data, size_t a_size, size_t a_count, void* a_transfer);
+                    static size_t OnHeader (char* a_data, size_t a_size, size_t a_count, void* a_transfer);
+
+                public: // Static Method(s) / Function(s)
+
+                    static const char* Method (const ::cc::easy::http::Client::Method a_method);
+                    static std::string Host   (const std::string& a_url);
+
+                    /**
+                     * @return Process wide instance.
+                     */
+                    static Loops& GetInstance ()
+                    {
+                        static Loops instance;
+                        return instance;
+                    }
+
+                public: // Inline Method(s) / Function(s)
+
+                    /**
+                     * @return True if requests can be submitted.
+                     */
+                    inline bool enabled () const
+                    {
+                        return ( count_.load(std::memory_order_acquire) > 0 );
+                    }
+
+                }; // end of class 'Loops'
+
+            } // end of namespace 'http'
+
+        } // end of namespace 'worker'
+
+    } // end of namespace 'proxy'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_PROXY_WORKER_HTTP_LOOPS_H_
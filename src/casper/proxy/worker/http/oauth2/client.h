@@ -27,12 +27,17 @@
 #include "casper/proxy/worker/http/oauth2/types.h"
 #include "casper/proxy/worker/http/oauth2/deferred.h"
 
-#include "casper/proxy/worker/v8/script.h"
+#include "casper/proxy/worker/v8/pool.h"
+#include "casper/proxy/worker/native/plugins.h"
+#include "casper/proxy/worker/fs/sweeper.h"
 
 #include "cc/crypto/rsa.h"
 
 #include <string>
 #include <map>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
 
 namespace casper
 {
@@ -80,6 +85,11 @@ namespace casper
                         static           const Json::Value        sk_behaviour_;
                         static           const Json::Value        sk_tmp_validity_;
                         static           const Json::Value        sk_tmp_url_;
+                        static           const Json::Value        sk_tmp_spill_threshold_;
+                        static           const Json::Value        sk_tmp_dedupe_;
+                        static           const Json::Value        sk_tmp_bucket_;
+                        static           const Json::Value        sk_v8_isolates_;
+                        static           const Json::Value        sk_v8_heap_limit_;
                         static           const RejectedHeadersSet sk_rejected_headers_;
                         constexpr static const long               sk_storage_connection_timeout_ = 30;
                         constexpr static const long               sk_storage_operation_timeout_  = 60;
@@ -87,12 +97,23 @@ namespace casper
                     private: // Data
                         
                         std::map<std::string, proxy::worker::http::oauth2::Config*> providers_;
+                        std::map<std::string, proxy::worker::native::Plugins*>      plugins_;   //!< native interceptors, by provider
                         
                     private: // Data
                         
                         Json::Value* tmp_v8_data_;
                         Json::Value* tmp_body_;
                         
+                    private: // Data
+                        
+                        size_t                                    in_flight_;      //!< number of deferred requests in progress
+                        casper::proxy::worker::fs::Sweeper::Stats sweeper_stats_;  //!< last logged reclaimed tmp files stats
+                        std::mutex                                idle_mutex_;     //!< protects idling_, idle_stop_ and idle_log_
+                        std::condition_variable                   idle_condition_; //!< signalled when V8 GC work is done or cancelled
+                        bool                                      idling_;         //!< true while V8 GC work is queued or running, see \link Idle \link
+                        bool                                      idle_stop_;      //!< true when shutting down, queued V8 GC work is cancelled
+                        std::vector<std::string>                  idle_log_;       //!< V8 metrics collected by last idle pass, logged by the next one
+                        
                     public: // Constructor(s) / Destructor
                         
                         Client () = delete;
@@ -114,6 +135,8 @@ namespace casper
 
                         ::cc::easy::http::oauth2::Client::GrantType TranslatedGrantType        (const std::string& a_name);
                         ::cc::crypto::RSA::SignOutputFormat         TranslatedSignOutputFormat (const std::string& a_name);
+                        casper::proxy::worker::codec::Compressor::Policy TranslatedBodyCompression (const Json::Value& a_object) const;
+                        std::string                                      OutputDir                 (const int64_t a_validity, const int64_t a_bucket, const int64_t a_grace);
 
                         void SetupGrantRequest (const ::casper::job::deferrable::Tracking& a_tracking,
                                                 const casper::proxy::worker::http::oauth2::Config& a_provider, casper::proxy::worker::http::oauth2::Arguments& a_arguments, casper::proxy::worker::http::oauth2::Parameters::GrantAuthCodeRequest& a_auth_code,
@@ -129,7 +152,9 @@ namespace casper
                         void Evaluate      (const uint64_t& a_id   , const std::string& a_expression, const Json::Value& a_data, std::string& o_value, casper::proxy::worker::v8::Script& a_script) const;
                         void Evaluate      (const std::string& a_id, const std::string& a_expression, const Json::Value& a_data, std::string& o_value, casper::proxy::worker::v8::Script& a_script) const;
                         void Evaluate      (const std::string& a_id, const std::string& a_expression, const Json::Value& a_data, Json::Value& o_value, casper::proxy::worker::v8::Script& a_script) const;
+                        void Evaluate      (const std::string& a_id, const std::string& a_expression, const std::string& a_data, Json::Value& o_value, casper::proxy::worker::v8::Script& a_script) const;
                         void EvaluationLog (const std::string& a_message, const bool a_success) const;
+                        void Idle          ();
                         
                         void ValidateScopes (const std::string& a_requested, const std::string& a_allowed) const;
                         
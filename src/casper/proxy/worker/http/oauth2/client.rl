@@ -25,13 +25,17 @@
 
 #include "version.h"
 
+#include "casper/proxy/worker/codec/json.h"
+#include "casper/proxy/worker/codec/decompressor.h"
+#include "casper/proxy/worker/http/gateway.h"
+#include "casper/proxy/worker/executor/pool.h"
+
 #include "cc/ragel.h"
 
 #include "cc/pragmas.h"
 
 #include "cc/fs/file.h"
 #include "cc/fs/dir.h"
-#include "cc/zlib/deflate.h"
 
 #include "cc/v8/exception.h"
 
@@ -41,6 +45,11 @@ const char* const casper::proxy::worker::http::oauth2::Client::sk_tube_
 const Json::Value casper::proxy::worker::http::oauth2::Client::sk_behaviour_    = "default";
 const Json::Value casper::proxy::worker::http::oauth2::Client::sk_tmp_validity_ = 3600; // 1h
 const Json::Value casper::proxy::worker::http::oauth2::Client::sk_tmp_url_      = ""; // none
+const Json::Value casper::proxy::worker::http::oauth2::Client::sk_tmp_spill_threshold_ = 0; // disabled
+const Json::Value casper::proxy::worker::http::oauth2::Client::sk_tmp_dedupe_          = false; // disabled
+const Json::Value casper::proxy::worker::http::oauth2::Client::sk_tmp_bucket_          = 0; // disabled
+const Json::Value casper::proxy::worker::http::oauth2::Client::sk_v8_isolates_  = 1;
+const Json::Value casper::proxy::worker::http::oauth2::Client::sk_v8_heap_limit_ = 0; // MB, none
 const casper::proxy::worker::http::oauth2::Client::RejectedHeadersSet casper::proxy::worker::http::oauth2::Client::sk_rejected_headers_ = {
     "Authorization", "User-Agent", "X-CASPER-ROLE-MASK"
 };
@@ -56,6 +65,10 @@ casper::proxy::worker::http::oauth2::Client::Client (const ev::Loggable::Data& a
 {
     tmp_v8_data_ = nullptr;
     tmp_body_    = nullptr;
+    in_flight_   = 0;
+    sweeper_stats_ = { /* buckets_ */ 0, /* files_ */ 0, /* bytes_ */ 0 };
+    idling_      = false;
+    idle_stop_   = false;
 }
 
 /**
@@ -63,10 +76,20 @@ casper::proxy::worker::http::oauth2::Client::Client (const ev::Loggable::Data& a
  */
 casper::proxy::worker::http::oauth2::Client::~Client ()
 {
+    // ... V8 GC work still queued or in progress? it uses providers isolates ...
+    {
+        std::unique_lock<std::mutex> lock(idle_mutex_);
+        idle_stop_ = true;
+        idle_condition_.wait(lock, [this] { return false == idling_; });
+    }
     for ( const auto& it : providers_ ) {
         delete it.second;
     }
     providers_.clear();
+    for ( const auto& it : plugins_ ) {
+        delete it.second;
+    }
+    plugins_.clear();
     if ( nullptr != tmp_v8_data_ ) {
         delete tmp_v8_data_;
     }
@@ -145,6 +168,14 @@ void casper::proxy::worker::http::oauth2::Client::InnerSetup ()
                     }
                 }
             }
+            // ... request body compression, disabled by default ...
+            casper::proxy::worker::codec::Compressor::Policy body_compression = { casper::proxy::worker::codec::Compressor::Codec::None, -1, 0 };
+            {
+                const Json::Value& body_compression_ref = json.Get(provider_ref, "body_compression", Json::ValueType::objectValue, &Json::Value::null);
+                if ( false == body_compression_ref.isNull() ) {
+                    body_compression = TranslatedBodyCompression(body_compression_ref);
+                }
+            }
             // ...
             proxy::worker::http::oauth2::Config* p_config = nullptr;
             try {
@@ -162,6 +193,20 @@ void casper::proxy::worker::http::oauth2::Client::InnerSetup ()
                 }
                 Json::Value interceptor = json.Get(provider_ref, "interceptor", Json::ValueType::objectValue, &Json::Value::null);
                 if ( false == interceptor.isNull() ) {
+                    // ... native interceptors ...
+                    const Json::Value& plugins = json.Get(interceptor, "plugins", Json::ValueType::arrayValue, &Json::Value::null);
+                    if ( false == plugins.isNull() ) {
+                        // ... one registry per provider, interceptors names only have to be unique within it ...
+                        auto& registry = plugins_[name];
+                        if ( nullptr == registry ) {
+                            registry = new proxy::worker::native::Plugins();
+                        }
+                        for ( Json::ArrayIndex idx = 0 ; idx < plugins.size() ; ++idx ) {
+                            const std::string uri = cc::fs::Dir::RealPath(plugins[idx].asString());
+                            LogMessage(CC_JOB_LOG_LEVEL_INF, CC_JOB_LOG_STEP_INFO, ( "Loading '" + uri + "' for provider '" + name + "'..." ));
+                            registry->Load(uri);
+                        }
+                    }
                     Json::Value scripts = json.Get(interceptor, "scripts", Json::ValueType::objectValue, &Json::Value::null);
                     if ( true == scripts.isObject() && true == scripts.isMember("directory") ) {
                         if ( true == scripts["directory"].isString() ) {
@@ -192,9 +237,13 @@ void casper::proxy::worker::http::oauth2::Client::InnerSetup ()
                         /* headers_per_method_ */ headers_per_method,
                         /* signing_            */ signing,
                         /* tmp_config_         */ {
-                            /* validity_ */ static_cast<int64_t>(json.Get(tmp_config, "validity", Json::ValueType::intValue, &sk_tmp_validity_).asInt64()),
-                            /* base_url_ */ json.Get(tmp_config, "base_url", Json::ValueType::stringValue, &sk_tmp_url_).asString()
+                            /* validity_        */ static_cast<int64_t>(json.Get(tmp_config, "validity", Json::ValueType::intValue, &sk_tmp_validity_).asInt64()),
+                            /* base_url_        */ json.Get(tmp_config, "base_url", Json::ValueType::stringValue, &sk_tmp_url_).asString(),
+                            /* spill_threshold_ */ static_cast<size_t>(json.Get(tmp_config, "spill_threshold", Json::ValueType::uintValue, &sk_tmp_spill_threshold_).asUInt64()),
+                            /* dedupe_          */ json.Get(tmp_config, "dedupe", Json::ValueType::booleanValue, &sk_tmp_dedupe_).asBool(),
+                            /* bucket_          */ static_cast<int64_t>(json.Get(tmp_config, "bucket", Json::ValueType::uintValue, &sk_tmp_bucket_).asUInt())
                         },
+                        /* body_compression_   */ body_compression,
                         /* storage_ */
                         proxy::worker::http::oauth2::Config::Storage({
                             /* endpoints_ */ {
@@ -215,9 +264,13 @@ void casper::proxy::worker::http::oauth2::Client::InnerSetup ()
                         /* headers_per_method_ */ headers_per_method,
                         /* signing_            */ signing,
                         /* tmp_config_         */ {
-                            /* validity_ */ static_cast<int64_t>(json.Get(tmp_config, "validity", Json::ValueType::intValue, &sk_tmp_validity_).asInt64()),
-                            /* base_url_ */ json.Get(tmp_config, "base_url", Json::ValueType::stringValue, &sk_tmp_url_).asString()
+                            /* validity_        */ static_cast<int64_t>(json.Get(tmp_config, "validity", Json::ValueType::intValue, &sk_tmp_validity_).asInt64()),
+                            /* base_url_        */ json.Get(tmp_config, "base_url", Json::ValueType::stringValue, &sk_tmp_url_).asString(),
+                            /* spill_threshold_ */ static_cast<size_t>(json.Get(tmp_config, "spill_threshold", Json::ValueType::uintValue, &sk_tmp_spill_threshold_).asUInt64()),
+                            /* dedupe_          */ json.Get(tmp_config, "dedupe", Json::ValueType::booleanValue, &sk_tmp_dedupe_).asBool(),
+                            /* bucket_          */ static_cast<int64_t>(json.Get(tmp_config, "bucket", Json::ValueType::uintValue, &sk_tmp_bucket_).asUInt())
                         },
+                        /* body_compression_   */ body_compression,
                         /* storage_ */
                         proxy::worker::http::oauth2::Config::Storageless({
                             /* headers_ */ {},
@@ -237,17 +290,28 @@ void casper::proxy::worker::http::oauth2::Client::InnerSetup ()
                 // ... v8 script ...
                 const Json::Value& scripts_dir = ( false == interceptor.isNull() ? interceptor["scripts"]["directory"] : Json::Value::null);
                 const std::string  scripts_uri = ( false == scripts_dir.isNull() ? scripts_dir.asString() : "thin air");
+                // ... number of isolates ...
+                const Json::Value& v8_ref      = json.Get(provider_ref, "v8", Json::ValueType::objectValue, &Json::Value::null);
+                const size_t       isolates    = static_cast<size_t>(json.Get(v8_ref, "isolates", Json::ValueType::uintValue, &sk_v8_isolates_).asUInt());
+                const size_t       heap_limit  = static_cast<size_t>(json.Get(v8_ref, "heap_limit", Json::ValueType::uintValue, &sk_v8_heap_limit_).asUInt()) * 1024 * 1024;
+                // ... compiled code cache is not a log, it lives next to other generated files unless configured ...
+                const Json::Value& cache_ref   = json.Get(v8_ref, "cache_dir", Json::ValueType::stringValue, &Json::Value::null);
+                const std::string  cache_dir   = ( false == cache_ref.isNull() ? cache_ref.asString() : ::cc::fs::Dir::Normalize(output_dir_prefix()) + "v8cc/" );
                 if ( false == signing.isNull() && true == signing.isMember("output_format") ) {
                     const Json::Value& sign_out_fmt = json.Get(signing, "output_format", Json::ValueType::stringValue, nullptr);
                     // ... load script ...
-                    p_config->script(loggable_data_, /* a_owner */ tube_, /* a_name */ config_.log_token() + "-" + name + "-v8",  /* a_uri */ scripts_uri, /* a_out_path */ logs_directory(), TranslatedSignOutputFormat(sign_out_fmt.asString()))
+                    p_config->scripts(loggable_data_, /* a_owner */ tube_, /* a_name */ config_.log_token() + "-" + name + "-v8",  /* a_uri */ scripts_uri, /* a_out_path */ logs_directory(), /* a_cache_dir */ cache_dir, TranslatedSignOutputFormat(sign_out_fmt.asString()), isolates)
                                 .Load(/* a_external_scripts */ scripts_dir, /* a_expressions */ {});
                 } else {
                     // ... load script ...
-                    p_config->script(loggable_data_, /* a_owner */ tube_, /* a_name */ config_.log_token() + "-" + name + "-v8",  /* a_uri */ scripts_uri, /* a_out_path */ logs_directory(), ::cc::crypto::RSA::SignOutputFormat::BASE64_RFC4648)
+                    p_config->scripts(loggable_data_, /* a_owner */ tube_, /* a_name */ config_.log_token() + "-" + name + "-v8",  /* a_uri */ scripts_uri, /* a_out_path */ logs_directory(), /* a_cache_dir */ cache_dir, ::cc::crypto::RSA::SignOutputFormat::BASE64_RFC4648, isolates)
                                 .Load(/* a_external_scripts */ scripts_dir, /* a_expressions */ {});
                 }
-                p_config->script().Register(std::bind(&worker::http::oauth2::Client::EvaluationLog, this, std::placeholders::_1, std::placeholders::_2));
+                p_config->scripts().ForEach([this] (casper::proxy::worker::v8::Script& a_script) {
+                    a_script.Register(std::bind(&worker::http::oauth2::Client::EvaluationLog, this, std::placeholders::_1, std::placeholders::_2));
+                });
+                // ... GC metrics and per isolate heap limit ...
+                p_config->scripts().Watch(heap_limit);
                 // ... save it ...
                 providers_[name] = p_config;
                 // ... forget it ...
@@ -260,6 +324,18 @@ void casper::proxy::worker::http::oauth2::Client::InnerSetup ()
             }
         }
     }    
+    // ... number of post-processing threads, process wide, first tube to setup wins ...
+    //
+    // "executor": {
+    //     "threads": <number>, - optional, post-processing ( payload building ) threads
+    //     "v8": <number>       - optional, V8 interceptors evaluation and GC threads, bounded by provider isolates anyway
+    // }
+    //
+    const Json::Value& executor_ref = json.Get(config, "executor", Json::ValueType::objectValue, &Json::Value::null);
+    if ( false == executor_ref.isNull() ) {
+        casper::proxy::worker::executor::Pool::GetInstance().Setup(static_cast<size_t>(json.Get(executor_ref, "threads", Json::ValueType::uintValue, &Json::Value::null).asUInt()));
+        casper::proxy::worker::executor::Pool::GetV8Instance().Setup(static_cast<size_t>(json.Get(executor_ref, "v8", Json::ValueType::uintValue, &Json::Value::null).asUInt()));
+    }
     // ... for debug purposes only ...
     CC_DEBUG_LOG_PRINT("dump-config", "----\n%s----\n", config.toStyledString().c_str());
 }
@@ -325,7 +401,8 @@ void casper::proxy::worker::http::oauth2::Client::InnerRun (const uint64_t& a_id
             /* a_id         */ provider_it->first,
             /* a_type       */ provider_it->second->type_,
             /* a_data       */ what_obj,
-            /* a_primitive  */ ( true == broker && 0 == strcasecmp("gateway", behaviour.asCString()) ),
+            /* a_primitive  */ ( true == broker && ( 0 == strcasecmp("gateway", behaviour.asCString()) || 0 == strcasecmp("gateway-v2", behaviour.asCString()) ) ),
+            /* a_gateway    */ ( 0 == strcasecmp("gateway-v2", behaviour.asCString()) ? casper::proxy::worker::http::Gateway::Format::V2 : casper::proxy::worker::http::Gateway::Format::V1 ),
             /* a_log_level  */ config_.log_level(),
             /* a_log_redact */ config_.log_redact()
         }
@@ -333,7 +410,10 @@ void casper::proxy::worker::http::oauth2::Client::InnerRun (const uint64_t& a_id
     
     const auto& provider_cfg = *provider_it->second;
     
-    auto& script = provider_it->second->script();
+    // ... same job, same isolate ...
+    // ... any free isolate, never wait for other jobs interceptors ...
+    const casper::proxy::worker::v8::Pool::Lease lease(provider_it->second->scripts(), a_id, casper::proxy::worker::v8::Pool::Mode::Looper);
+    auto& script = lease.script();
     
     // ... patch OAuth2 'scope' field ...
     arguments.parameters().config(provider_it->second->http_, [this, &json, &arguments, &provider_it] (::cc::easy::http::oauth2::Client::Config& config) {
@@ -377,10 +457,22 @@ void casper::proxy::worker::http::oauth2::Client::InnerRun (const uint64_t& a_id
             }
         }
     };
+    // ... tmp files must outlive the request(s) that will write them ...
+    ::cc::easy::http::oauth2::Client::Timeouts timeouts = { -1, -1 };
+    set_timeouts(json.Get(arguments.parameters().data_, "timeouts", Json::ValueType::objectValue, &Json::Value::null), timeouts);
+    const int64_t grace = casper::proxy::worker::fs::Sweeper::Grace(timeouts.connection_, timeouts.operation_);
+    // ... binary gateway frames are written to file, see \link Gateway \link ...
+    if ( true == arguments.parameters().primitive_ && casper::proxy::worker::http::Gateway::Format::V2 == arguments.parameters().gateway_ ) {
+        (void)arguments.parameters().spill([this, &provider_cfg, grace](casper::proxy::worker::fs::Spill::Config& spill) {
+            spill.dir_      = OutputDir(provider_cfg.tmp_config_.validity_, provider_cfg.tmp_config_.bucket_, grace);
+            spill.prefix_   = output_dir_prefix();
+            spill.base_url_ = provider_cfg.tmp_config_.base_url_;
+        });
+    }
     //
     // STORAGE
     //
-    const auto set_storage = [this, &tracking, &arguments, provider_cfg, &script] (::cc::easy::http::oauth2::Client::Tokens* o_tokens) {
+    const auto set_storage = [this, &tracking, &arguments, &provider_cfg, &script] (::cc::easy::http::oauth2::Client::Tokens* o_tokens) {
         // ... storageless?
         if ( proxy::worker::http::oauth2::Config::Type::Storageless == arguments.parameters().type_ ) {
             // ... copy latest tokens available?..
@@ -439,7 +531,7 @@ void casper::proxy::worker::http::oauth2::Client::InnerRun (const uint64_t& a_id
             });
         });
     } else if ( 0 == strcasecmp(what_ref.asCString(), "http") ) {
-        (void)arguments.parameters().http_request([this, &set_timeouts, &set_storage, &json, tracking, &provider_cfg, &arguments, &script](proxy::worker::http::oauth2::Parameters::HTTPRequest& request) {
+        (void)arguments.parameters().http_request([this, &set_timeouts, &set_storage, &json, tracking, &provider_cfg, &provider_it, &arguments, &script, grace](proxy::worker::http::oauth2::Parameters::HTTPRequest& request) {
             // ... set timeouts ...
             set_timeouts(json.Get(arguments.parameters().data_, "timeouts", Json::ValueType::objectValue, &Json::Value::null), request.timeouts_);
             // ... set storage ...
@@ -447,13 +539,31 @@ void casper::proxy::worker::http::oauth2::Client::InnerRun (const uint64_t& a_id
             // .. set response ...
             (void)arguments.parameters().http_response([&](proxy::worker::http::oauth2::Parameters::HTTPResponse& response) {
                 SetupHTTPRequest(tracking, provider_cfg, arguments, request, script, (*tmp_v8_data_), response);
+                // ... V8 interceptors can be evaluated by any isolate, from executor threads ...
+                if ( 0 != response.interceptor_.v8_expr_.length() ) {
+                    response.interceptor_.scripts_ = &provider_it->second->scripts();
+                }
             });
+            // ... oversized bodies, not written to file by request, should be written to file anyway?
+            if ( provider_cfg.tmp_config_.spill_threshold_ > 0 && false == arguments.parameters().primitive_ && 0 == arguments.parameters().http_response().uri_.length() ) {
+                (void)arguments.parameters().spill([this, &provider_cfg, grace](casper::proxy::worker::fs::Spill::Config& spill) {
+                    spill.threshold_ = provider_cfg.tmp_config_.spill_threshold_;
+                    spill.dir_       = OutputDir(provider_cfg.tmp_config_.validity_, provider_cfg.tmp_config_.bucket_, grace);
+                    spill.prefix_    = output_dir_prefix();
+                    spill.base_url_  = provider_cfg.tmp_config_.base_url_;
+                    spill.store_     = ( true == provider_cfg.tmp_config_.dedupe_ ? ::cc::fs::Dir::Normalize(output_dir_prefix()) + "cas/" : "" );
+                    if ( 0 != spill.store_.length() ) {
+                        casper::proxy::worker::fs::Sweeper::GetInstance().Watch(spill.store_);
+                    }
+                });
+            }
         });
     } else { // ... WTF?
         throw ::cc::BadRequest("Don't know how to process '%s' - unknown operation!", what_ref.asCString());
     }
     // ... schedule deferred HTTP request ...
     dynamic_cast<casper::proxy::worker::http::oauth2::Dispatcher*>(d_.dispatcher_)->Push(tracking, arguments);
+    in_flight_++;
     // ... publish progress ...
     ClientBaseClass::Publish(tracking.bjid_, tracking.rcid_, tracking.rjid_, ClientStep::DoingIt, ClientBaseClass::Status::InProgress,
                              I18NInProgress()
@@ -493,6 +603,8 @@ void casper::proxy::worker::http::oauth2::Client::InnerCleanUp ()
  */
 uint16_t casper::proxy::worker::http::oauth2::Client::OnDeferredRequestCompleted (const ::casper::job::deferrable::Deferred<casper::proxy::worker::http::oauth2::Arguments>* a_deferred, Json::Value& o_payload)
 {
+    // ... one less ...
+    in_flight_ -= ( in_flight_ > 0 ? 1 : 0 );
     // ...
     const auto& params = a_deferred->arguments().parameters();
     {
@@ -503,6 +615,19 @@ uint16_t casper::proxy::worker::http::oauth2::Client::OnDeferredRequestCompleted
             });
         }
     }
+    // ... payload already built ( off the looper thread ) by deferred request?
+    {
+        auto deferred = const_cast<casper::proxy::worker::http::oauth2::Deferred*>(static_cast<const casper::proxy::worker::http::oauth2::Deferred*>(a_deferred));
+        if ( true == deferred->prepared() ) {
+            deferred->TakePayload(o_payload);
+            // ... nothing else to do?
+            if ( 0 == in_flight_ ) {
+                Idle();
+            }
+            // ... done ...
+            return deferred->response().code();
+        }
+    }
     const ::cc::easy::JSON<::cc::Exception> json;
     // ... handle response interception ( if required ) ...
     InterceptResponse(a_deferred);
@@ -510,72 +635,32 @@ uint16_t casper::proxy::worker::http::oauth2::Client::OnDeferredRequestCompleted
     const auto&    response = a_deferred->response();
     const uint16_t code     = response.code();
     // ... lets call it a 'feature' ...
+    Json::Value body;
     if ( Parameters::RequestType::OAuth2Grant == params.request_type() && true == params.auth_code_request().expose_ ) {
         // ... if succeeded and response is JSON ...
         if ( 200 == code && true == ::cc::easy::JSON<::cc::Exception>::IsJSON(response.content_type()) ) {
-            // ... parse ...
-            json.Parse(response.body(), o_payload["body"]);
+            // ... parse, decoding it first if upstream compression was negotiated ...
+            std::string                                         decoded;
+            casper::proxy::worker::codec::Decompressor::Headers headers;
+            const std::string& data = ( true == params.accept_encoding() ? casper::proxy::worker::codec::Decompressor::Decoded(response.headers(), response.body(), decoded) : response.body() );
+            if ( &data == &decoded ) {
+                casper::proxy::worker::codec::Decompressor::Stripped(response.headers(), headers);
+            } else {
+                headers = response.headers();
+            }
+            casper::proxy::worker::codec::JSON::Parse(data, body);
             // ... expose access token ... as requested ....
-            o_payload["body"]["access_token"] = params.tokens().access_;
+            body["access_token"] = params.tokens().access_;
             // ... override response ...
             const_cast<::casper::job::deferrable::Deferred<casper::proxy::worker::http::oauth2::Arguments>*>(a_deferred)
-                ->OverrideResponse(code, response.content_type(), response.headers(), json.Write(o_payload["body"]), /* a_parse */ false);
-            (void)o_payload.removeMember("body");
+                ->OverrideResponse(code, response.content_type(), headers, json.Write(body), /* a_parse */ false);
         }
     }
-    // ... set payload ...
-    o_payload = Json::Value(Json::ValueType::objectValue);
-    // ... primitive or default?
-    if ( true == params.primitive_ ) {
-        // ... gateway response mode ....
-        // !<status-code-int-value>,<content-type-length-in-bytes>,<content-type-string-value>,<headers-length-bytes>,<headers>,<body-length-bytes>,<body>
-        std::stringstream ss;
-        ss << '!' << response.code() << ',' << response.content_type().length() << ',' << response.content_type();
-        ss << ',' << response.body().length() << ',' << response.body();
-        {
-            std::string v = "";
-            for ( auto header : a_deferred->response().headers() ) {
-                v = header.first + ":" + header.second;
-                ss << ',' << v.length() << ',' << v;
-            }
-        }
-        // ... data ...
-        o_payload["data"] = ss.str();
-    } else {
-        // ...
-        if ( 200 == response.code() && 0 != a_deferred->arguments().parameters().http_response().uri_.length() ) {
-            const unsigned char* const data = reinterpret_cast<const unsigned char*>(response.body().c_str());
-            const size_t               size = response.body().size();
-            ::cc::fs::File file;
-            file.Open(a_deferred->arguments().parameters().http_response().uri_, ::cc::fs::File::Mode::Write);
-            // ... deflate it?
-            if ( true == a_deferred->arguments().parameters().http_response().deflated_ ) {
-                ::cc::zlib::Deflate deflate;
-                deflate.Do(data, size, [&file] (const unsigned char* const a_data, const size_t a_size) {
-                    file.Write(a_data, a_size);
-                });
-            } else {
-                file.Write(data, size);
-            }
-            file.Close();
-            o_payload["url"] = a_deferred->arguments().parameters().http_response().url_;
-        } else {
-            // ... body ...
-            if ( true == ::cc::easy::JSON<::cc::Exception>::IsJSON(response.content_type()) ) {
-                json.Parse(response.body(), o_payload["body"]);
-            } else {
-                o_payload["body"] = response.body();
-            }
-            // ... headers ...
-            if ( response.headers().size() > 0 ) {
-                o_payload["headers"] = Json::Value(Json::ValueType::objectValue);
-                for ( auto header : response.headers() ) {
-                    o_payload["headers"][header.first] = header.second;
-                }
-            }
-            // ... code ...
-            o_payload["code"] = response.code();
-        }
+    // ... set payload, already parsed body ( if any ) is moved, not parsed again ...
+    casper::proxy::worker::http::oauth2::Deferred::BuildPayload(params, response, o_payload, ( true == body.isNull() ? nullptr : &body ));
+    // ... nothing else to do?
+    if ( 0 == in_flight_ ) {
+        Idle();
     }
     // ... done ...
     return code;
@@ -593,6 +678,8 @@ uint16_t casper::proxy::worker::http::oauth2::Client::OnDeferredRequestCompleted
  */
 uint16_t casper::proxy::worker::http::oauth2::Client::OnDeferredRequestFailed (const ::casper::job::deferrable::Deferred<casper::proxy::worker::http::oauth2::Arguments>* a_deferred, Json::Value& o_payload)
 {
+    // ... one less ...
+    in_flight_ -= ( in_flight_ > 0 ? 1 : 0 );
     const auto& params = a_deferred->arguments().parameters();
     // ...
     {
@@ -603,6 +690,19 @@ uint16_t casper::proxy::worker::http::oauth2::Client::OnDeferredRequestFailed (c
             });
         }
     }
+    // ... payload already built ( off the looper thread ) by deferred request?
+    {
+        auto deferred = const_cast<casper::proxy::worker::http::oauth2::Deferred*>(static_cast<const casper::proxy::worker::http::oauth2::Deferred*>(a_deferred));
+        if ( true == deferred->prepared() ) {
+            deferred->TakePayload(o_payload);
+            // ... nothing else to do?
+            if ( 0 == in_flight_ ) {
+                Idle();
+            }
+            // ... done ...
+            return deferred->response().code();
+        }
+    }
     // ... exception?
     {
         const auto exception = a_deferred->response().exception();
@@ -613,50 +713,13 @@ uint16_t casper::proxy::worker::http::oauth2::Client::OnDeferredRequestFailed (c
     // ... handle response interception ( if required ) ...
     InterceptResponse(a_deferred);
     // ...
-    const auto     response = a_deferred->response();
+    const auto&    response = a_deferred->response();
     const uint16_t code     = response.code();
     // ... set payload ...
-    o_payload = Json::Value(Json::ValueType::objectValue);
-    // ... primitive or default?
-    if ( true == a_deferred->arguments().parameters().primitive_ ) {
-        // ... gateway response mode ....
-        // !<status-code-int-value>,<content-type-length-in-bytes>,<content-type-string-value>,<headers-length-bytes>,<headers>,<body-length-bytes>,<body>
-        std::stringstream ss;
-        ss << '!' << response.code() << ',' << response.content_type().length() << ',' << response.content_type();
-        // ... body ...
-        const auto exception = a_deferred->response().exception();
-        if ( nullptr != exception ) {
-            ss << ',' << strlen(exception->what()) << ',' << exception->what();
-        } else {
-            ss << ',' << response.body().length() << ',' << response.body();
-        }
-        // ... headers ...
-        {
-            std::string v = "";
-            for ( auto header : a_deferred->response().headers() ) {
-                v = header.first + ":" + header.second;
-                ss << ',' << v.length() << ',' << v;
-            }
-        }
-        // ... data ...
-        o_payload["data"] = ss.str();
-    } else {
-        // ... body ...
-        if ( true == ::cc::easy::JSON<::cc::Exception>::IsJSON(response.content_type()) ) {
-            const ::cc::easy::JSON<::cc::Exception> json;
-            json.Parse(response.body(), o_payload["body"]);
-        } else {
-            o_payload["body"] = response.body();
-        }
-        // ... headers ...
-        if ( response.headers().size() > 0 ) {
-            o_payload["headers"] = Json::Value(Json::ValueType::objectValue);
-            for ( auto header : response.headers() ) {
-                o_payload["headers"][header.first] = header.second;
-            }
-        }
-        // ... code ...
-        o_payload["code"] = response.code();
+    casper::proxy::worker::http::oauth2::Deferred::BuildPayload(params, response, o_payload);
+    // ... nothing else to do?
+    if ( 0 == in_flight_ ) {
+        Idle();
     }
     // ... done ...
     return code;
@@ -744,6 +807,59 @@ uint16_t casper::proxy::worker::http::oauth2::Client::OnDeferredRequestFailed (c
     return format;
 }
 
+/**
+ * @brief Translate a request body compression policy.
+ *
+ * @param a_object JSON object: { "codec": <string>, "level": <integer>, "threshold": <unsigned integer> }.
+ *
+ * @return Request body compression policy, see \link codec::Compressor::Policy \link.
+ */
+casper::proxy::worker::codec::Compressor::Policy casper::proxy::worker::http::oauth2::Client::TranslatedBodyCompression (const Json::Value& a_object) const
+{
+    const ::cc::easy::JSON<::cc::BadRequest> json;
+    casper::proxy::worker::codec::Compressor::Policy policy = {
+        /* codec_     */ casper::proxy::worker::codec::Compressor::Translated(json.Get(a_object, "codec", Json::ValueType::stringValue, nullptr).asString()),
+        /* level_     */ -1,
+        /* threshold_ */ 0
+    };
+    const Json::Value& level = json.Get(a_object, "level", Json::ValueType::intValue, &Json::Value::null);
+    if ( false == level.isNull() ) {
+        casper::proxy::worker::codec::Compressor::ValidateLevel(policy.codec_, level.asInt());
+        policy.level_ = static_cast<int8_t>(level.asInt());
+    }
+    const Json::Value& threshold = json.Get(a_object, "threshold", Json::ValueType::uintValue, &Json::Value::null);
+    if ( false == threshold.isNull() ) {
+        policy.threshold_ = static_cast<size_t>(threshold.asUInt64());
+    }
+    return policy;
+}
+
+/**
+ * @brief Obtain ( creating it if needed ) the directory where tmp files should be written.
+ *
+ * @param a_validity Files validity, in seconds.
+ * @param a_bucket   Time bucket size, in seconds, 0 to keep files where \link EnsureOutputDir \link places them.
+ * @param a_grace    Grace period, in seconds, see \link fs::Sweeper::Dir \link.
+ *
+ * @return Directory URI.
+ */
+std::string casper::proxy::worker::http::oauth2::Client::OutputDir (const int64_t a_validity, const int64_t a_bucket, const int64_t a_grace)
+{
+    if ( a_bucket <= 0 ) {
+        return EnsureOutputDir(a_validity);
+    }
+    auto& sweeper = casper::proxy::worker::fs::Sweeper::GetInstance();
+    // ... report what was reclaimed since last time ( if anything ) ...
+    const casper::proxy::worker::fs::Sweeper::Stats stats = sweeper.stats();
+    if ( stats.files_ != sweeper_stats_.files_ || stats.buckets_ != sweeper_stats_.buckets_ ) {
+        LogMessage(CC_JOB_LOG_LEVEL_INF, CC_JOB_LOG_STEP_INFO,
+                   "TMP sweeper: reclaimed " + std::to_string(stats.bytes_) + " byte(s), " + std::to_string(stats.files_) + " file(s), " + std::to_string(stats.buckets_) + " bucket(s)"
+        );
+        sweeper_stats_ = stats;
+    }
+    return sweeper.Dir(output_dir_prefix(), a_validity, a_bucket, a_grace);
+}
+
 /**
  * @brief Setup a 'grant_type' operation.
  *
@@ -860,29 +976,40 @@ void casper::proxy::worker::http::oauth2::Client::SetupHTTPRequest (const ::casp
         );
         // ... copy body ...
         tmp_body_ = new Json::Value(body_ref);
-        // ... traverse JSON and evaluate 'String' fields ...
-        a_script.PatchObject(*tmp_body_, [&] (const std::string& a_expression) -> Json::Value {
-            value.SetNull();
-            a_script.Evaluate(data, a_expression, value);
-            switch(value.type()) {
-                case ::cc::v8::Value::Type::Int32:
-                    return Json::Value(value.operator int());
-                case ::cc::v8::Value::Type::UInt32:
-                    return Json::Value(value.operator unsigned int());
-                case ::cc::v8::Value::Type::Double:
-                    return Json::Value(value.operator double());
-                case ::cc::v8::Value::Type::String:
-                    return Json::Value(value.AsString());
-                case ::cc::v8::Value::Type::Boolean:
-                    return Json::Value(value.operator const bool());
-                case ::cc::v8::Value::Type::Object:
-                    return value.operator const Json::Value &();
-                case ::cc::v8::Value::Type::Date:
-                case ::cc::v8::Value::Type::Undefined:
-                case ::cc::v8::Value::Type::Null:
-                    return Json::Value(Json::Value::null);
+        // ... traverse JSON and collect 'String' fields expressions, leaving them untouched ...
+        std::string batch = "({\"values\":[";
+        size_t      count = 0;
+        a_script.PatchObject(*tmp_body_, [&batch, &count] (const std::string& a_expression) -> Json::Value {
+            if ( count++ > 0 ) {
+                batch += ',';
             }
+            // ... newline: an expression might end with a '//' comment ...
+            batch += '(' + a_expression + "\n)";
+            return Json::Value(a_expression);
         });
+        batch += "]})";
+        // ... evaluate all of them in a single V8 call ...
+        if ( 0 == count ) {
+            data.Reset();
+        } else {
+            a_script.Evaluate(data, batch, value);
+            data.Reset();
+            if ( true == a_script.IsExceptionSet() ) {
+                throw ::cc::BadRequest("%s", a_script.exception().what());
+            }
+            if ( ::cc::v8::Value::Type::Object != value.type() ) {
+                throw ::cc::BadRequest("Unexpected // unsupported v8 evaluation ( of body ), result type %u ", value.type());
+            }
+            const Json::Value& values = value.operator const Json::Value &()["values"];
+            if ( false == values.isArray() || count != static_cast<size_t>(values.size()) ) {
+                throw ::cc::BadRequest("Unexpected // unsupported v8 evaluation ( of body ), expecting " SIZET_FMT " values!", count);
+            }
+            // ... traverse JSON again, same order, and replace 'String' fields with evaluation results ...
+            Json::ArrayIndex index = 0;
+            a_script.PatchObject(*tmp_body_, [&values, &index] (const std::string& /* a_expression */) -> Json::Value {
+                return values[index++];
+            });
+        }
         a_request.body_ = json.Write(*tmp_body_);
     } else {
         // ... default behaviour ...
@@ -961,6 +1088,24 @@ void casper::proxy::worker::http::oauth2::Client::SetupHTTPRequest (const ::casp
                 }
             }
         }
+        // ... negotiate upstream compression? body will only be decoded when needed ...
+        const Json::Value& accept_encoding = json.Get(http, "accept_encoding", Json::ValueType::booleanValue, &Json::Value::null);
+        if ( false == accept_encoding.isNull() && true == accept_encoding.asBool() ) {
+            // ... unless it was explicitly set, it's body will be delivered as received ...
+            if ( a_request.headers_.end() == std::find_if(a_request.headers_.begin(), a_request.headers_.end(), ::cc::easy::http::Client::HeaderMapKeyComparator("Accept-Encoding")) ) {
+                a_request.headers_["Accept-Encoding"] = { casper::proxy::worker::codec::Decompressor::sk_accept_encoding_ };
+                o_v8_data["headers"]["Accept-Encoding"] = casper::proxy::worker::codec::Decompressor::sk_accept_encoding_;
+                a_arguments.parameters().accept_encoding(true);
+            }
+        }
+        // ... compress body? payload policy takes precedence over provider's one ...
+        if ( a_request.headers_.end() == std::find_if(a_request.headers_.begin(), a_request.headers_.end(), ::cc::easy::http::Client::HeaderMapKeyComparator("Content-Encoding")) ) {
+            const Json::Value& body_compression = json.Get(http, "body_compression", Json::ValueType::objectValue, &Json::Value::null);
+            const casper::proxy::worker::codec::Compressor::Policy policy = ( true == body_compression.isNull() ? a_provider.body_compression_ : TranslatedBodyCompression(body_compression) );
+            if ( true == casper::proxy::worker::codec::Compressor::Compress(policy, a_request.body_) ) {
+                a_request.headers_["Content-Encoding"] = { casper::proxy::worker::codec::Compressor::Encoding(policy.codec_) };
+            }
+        }
     }
     // ... debug stuff ...
 #ifdef CC_DEBUG_ON
@@ -991,14 +1136,21 @@ void casper::proxy::worker::http::oauth2::Client::SetupHTTPRequest (const ::casp
         // ... write to file?
         const Json::Value& to_file_ref = json.Get(response_ref, "to_file", Json::ValueType::booleanValue, &Json::Value::null);
         if ( false == to_file_ref.isNull() && true == to_file_ref.asBool() ) {
-            // ... deflate it?
-            const Json::Value& deflated_ref = json.Get(response_ref, "deflated", Json::ValueType::booleanValue, &Json::Value::null);
-            if ( false == deflated_ref.isNull() ) {
-                o_response.deflated_ = deflated_ref.asBool();
+            // ... compress it?
+            const Json::Value& compression_ref = json.Get(response_ref, "compression", Json::ValueType::stringValue, &Json::Value::null);
+            if ( false == compression_ref.isNull() ) {
+                o_response.compression_ = casper::proxy::worker::codec::Compressor::Translated(compression_ref.asString());
+            } else {
+                // ... legacy: deflate it?
+                const Json::Value& deflated_ref = json.Get(response_ref, "deflated", Json::ValueType::booleanValue, &Json::Value::null);
+                if ( false == deflated_ref.isNull() && true == deflated_ref.asBool() ) {
+                    o_response.compression_ = casper::proxy::worker::codec::Compressor::Codec::Deflate;
+                }
             }
             // ... compression level?
             const Json::Value& level = json.Get(response_ref, "level", Json::ValueType::intValue, &Json::Value::null);
             if ( false == level.isNull() ) {
+                casper::proxy::worker::codec::Compressor::ValidateLevel(o_response.compression_, level.asInt());
                 o_response.level_ = static_cast<int8_t>(level.asInt());
             }
             // ... read validity ...
@@ -1009,22 +1161,36 @@ void casper::proxy::worker::http::oauth2::Client::SetupHTTPRequest (const ::casp
                 o_response.validity_ = a_provider.tmp_config_.validity_;
             }
             // ... make unique file ...
-            ::cc::fs::File::Unique(EnsureOutputDir(o_response.validity_), /* name */ "", "ohc", o_response.uri_);
+            ::cc::fs::File::Unique(OutputDir(o_response.validity_, a_provider.tmp_config_.bucket_, casper::proxy::worker::fs::Sweeper::Grace(a_request.timeouts_.connection_, a_request.timeouts_.operation_)),
+                                   /* name */ "", "ohc", o_response.uri_);
             // ... set URL ...
             o_response.url_ = a_provider.tmp_config_.base_url_;
             if ( '/' != o_response.url_[o_response.url_.length() - 1] ) {
                 o_response.url_ += '/';
             }
             o_response.url_ += std::string(o_response.uri_.c_str() + output_dir_prefix().length());
+            // ... store identical files once?
+            if ( true == a_provider.tmp_config_.dedupe_ ) {
+                o_response.store_ = ::cc::fs::Dir::Normalize(output_dir_prefix()) + "cas/";
+                casper::proxy::worker::fs::Sweeper::GetInstance().Watch(o_response.store_);
+            }
         }
         // ... intercept?
         const Json::Value& interceptor_ref = json.Get(response_ref, "interceptor", Json::ValueType::objectValue, &Json::Value::null);
         if ( false == interceptor_ref.isNull() ) {
-            const Json::Value& expr_ref = json.Get(interceptor_ref, "expr", Json::ValueType::stringValue, &Json::Value::null);
-            if ( false == expr_ref.isNull() ) {
+            const Json::Value& expr_ref   = json.Get(interceptor_ref, "expr"  , Json::ValueType::stringValue, &Json::Value::null);
+            const Json::Value& native_ref = json.Get(interceptor_ref, "native", Json::ValueType::stringValue, &Json::Value::null);
+            if ( false == native_ref.isNull() ) {
+                const auto registry = plugins_.find(a_arguments.parameters().id_);
+                if ( plugins_.end() == registry || false == registry->second->Has(native_ref.asString()) ) {
+                    throw ::cc::BadRequest("Unknown native interceptor '%s' for provider '%s'!", native_ref.asCString(), a_arguments.parameters().id_.c_str());
+                }
+                o_response.interceptor_.native_  = native_ref.asString();
+                o_response.interceptor_.v8_data_ = interceptor_ref["data"];
+            } else if ( false == expr_ref.isNull() ) {
                 o_response.interceptor_.v8_expr_ = expr_ref.asString();
                 o_response.interceptor_.v8_data_ = interceptor_ref["data"];
-            }            
+            }
         }
     }
 }
@@ -1094,6 +1260,7 @@ void casper::proxy::worker::http::oauth2::Client::Evaluate (const std::string& a
                      /* a_key    */ nullptr
     );
     a_script.Evaluate(v8_value, a_expression, cc_value);
+    v8_value.Reset();
     if ( true == a_script.IsExceptionSet() ) {
         throw ::cc::BadRequest("%s", a_script.exception().what());
     }
@@ -1123,26 +1290,22 @@ void casper::proxy::worker::http::oauth2::Client::Evaluate (const std::string& a
 {
     const ::cc::easy::JSON<::cc::BadRequest> json;
     
-    o_value.clear();
-    
-    ::v8::Persistent<::v8::Value> v8_value; ::cc::v8::Value cc_value;
-    a_script.SetData(/* a_name  */ a_id.c_str(),
-                     /* a_data   */ json.Write(a_data).c_str(),
-                     /* o_object */ nullptr,
-                     /* o_value  */ &v8_value,
-                     /* a_key    */ nullptr
-    );
-    a_script.Evaluate(v8_value, a_expression, cc_value);
-    if ( true == a_script.IsExceptionSet() ) {
-        throw ::cc::BadRequest("%s", a_script.exception().what());
-    }
-    switch(cc_value.type()) {
-        case ::cc::v8::Value::Type::Object:
-            o_value = cc_value;
-            break;
-        default:
-            throw ::cc::BadRequest("Unexpected // unsupported v8 evaluation ( of %s ), result type %u ", a_expression.c_str(), cc_value.type());
-    }
+    Evaluate(a_id, a_expression, json.Write(a_data), o_value, a_script);
+}
+
+/**
+ * @brief Evaluate a V8 expression.
+ *
+ * @param a_id         ID.
+ * @param a_expression Expression to evaluate.
+ * @param a_data       Data to load ( to be used during expression evaluation ), already serialized as a JSON object string.
+ * @param o_value      Evaluation result.
+ * @param a_script     V8 script instance to use.
+ */
+void casper::proxy::worker::http::oauth2::Client::Evaluate (const std::string& a_id, const std::string& a_expression, const std::string& a_data, Json::Value& o_value,
+                                                            casper::proxy::worker::v8::Script& a_script) const
+{
+    a_script.Evaluate(a_id, a_expression, a_data, o_value);
 }
 
 /**
@@ -1160,6 +1323,57 @@ void casper::proxy::worker::http::oauth2::Client::EvaluationLog (const std::stri
     }
 }
 
+/**
+ * @brief Called when there are no deferred requests in progress, so V8 GC work can be done now.
+ *
+ * @discussion GC work is done by a V8 \link executor::Pool \link thread, so it doesn't delay the payload that is being delivered nor post-processing.
+ */
+void casper::proxy::worker::http::oauth2::Client::Idle ()
+{
+    // ... log metrics collected by previous pass ...
+    {
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+        for ( const auto& line : idle_log_ ) {
+            LogMessage(CC_JOB_LOG_LEVEL_VBS, CC_JOB_LOG_STEP_V8, line);
+        }
+        idle_log_.clear();
+        // ... previous pass still queued or running?
+        if ( true == idling_ || true == idle_stop_ ) {
+            return;
+        }
+        idling_ = true;
+    }
+    // ... always signalled, so destructor can wait for it ...
+    const auto done = [this] () {
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+        idling_ = false;
+        idle_condition_.notify_all();
+    };
+    // ... do GC work off the looper thread, if executor is busy skip it, we'll be idle again ...
+    const bool submitted = casper::proxy::worker::executor::Pool::GetV8Instance().Submit([this, done] () {
+        for ( const auto& provider : providers_ ) {
+            // ... shutting down? cancel what's left ...
+            {
+                std::lock_guard<std::mutex> lock(idle_mutex_);
+                if ( true == idle_stop_ ) {
+                    break;
+                }
+            }
+            provider.second->scripts().Idle([this, &provider] (const size_t a_index, const casper::proxy::worker::v8::Script::Stats& a_stats) {
+                const std::string line = provider.first + "[" + std::to_string(a_index) + "]: heap " + std::to_string(a_stats.used_heap_size_) + "/" + std::to_string(a_stats.total_heap_size_) + " byte(s)"
+                    + ", gc " + std::to_string(a_stats.gc_count_) + " cycle(s), pause total " + std::to_string(a_stats.gc_pause_total_us_) + "us, max " + std::to_string(a_stats.gc_pause_max_us_) + "us"
+                    + ", near heap limit " + std::to_string(a_stats.near_heap_limit_) + ", terminated " + std::to_string(a_stats.terminations_) + ", low memory " + std::to_string(a_stats.low_memory_);
+                std::lock_guard<std::mutex> lock(idle_mutex_);
+                idle_log_.push_back(line);
+            });
+        }
+        done();
+    });
+    if ( false == submitted ) {
+        done();
+    }
+}
+
 /**
  * @brief Validate requested scopes(s) against configured ones.
  *
@@ -1199,77 +1413,114 @@ void casper::proxy::worker::http::oauth2::Client::InterceptResponse (const ::cas
 {
     const auto& params = a_deferred->arguments().parameters();
     const auto& provider = providers_.find(params.id_);
+    const auto& interceptor = params.http_response().interceptor_;
     // ... intercept ?
-    if ( not ( params.http_response().interceptor_.v8_expr_.length() > 0 ) ) {
-        // ... no - expression is NOT set ...
+    if ( not ( interceptor.v8_expr_.length() > 0 || interceptor.native_.length() > 0 ) ) {
+        // ... no - expression or native interceptor is NOT set ...
         return;
     }
-    const std::string& expr = params.http_response().interceptor_.v8_expr_;
+    const bool         native = ( interceptor.native_.length() > 0 );
+    const std::string& expr   = ( true == native ? interceptor.native_ : interceptor.v8_expr_ );
+    const char* const  kind   = ( true == native ? "native interceptor" : "V8 expression" );
     
     // ... log interception intent ...
-    LogResponseInterception("RESPONSE INTERCEPTION INTENT REQUESTED BY EVALUATION OF EXPRESSION:");
+    if ( true == native ) {
+        LogResponseInterception("RESPONSE INTERCEPTION INTENT REQUESTED BY NATIVE INTERCEPTOR:");
+    } else {
+        LogResponseInterception("RESPONSE INTERCEPTION INTENT REQUESTED BY EVALUATION OF EXPRESSION:");
+    }
     LogResponseInterception(expr);
     
     const ::cc::easy::JSON<::cc::Exception> json;
     auto         deferred  = const_cast<::casper::job::deferrable::Deferred<casper::proxy::worker::http::oauth2::Arguments>*>(a_deferred);
     Json::Value  response  = Json::Value::null;
-    Json::Value* data      = nullptr;
     bool         overriden = false;
     
-    casper::job::deferrable::Response* original  = nullptr;
     try {
-        // ... prepare data ...
-        data = new Json::Value(Json::ValueType::objectValue);
-        (*data)["code"]           = a_deferred->response().code();
-        (*data)["content_type"]   = a_deferred->response().content_type();
-        (*data)["content_length"] = static_cast<Json::UInt64>(a_deferred->response().body().length());
-        if ( true == json.IsJSON(a_deferred->response().content_type()) ) {
-            json.Parse(a_deferred->response().body(), (*data)["body"]);
-        } else {
-            (*data)["body"] = a_deferred->response().body();
+        // ... upstream compression negotiated? interceptors inspect body, decode it now ( no-op if already decoded by \link Deferred::Intercept \link ) ...
+        if ( true == params.accept_encoding() ) {
+            const auto encoding = casper::proxy::worker::codec::Decompressor::Encoding(a_deferred->response().headers());
+            if ( casper::proxy::worker::codec::Compressor::Codec::None != encoding ) {
+                const std::string                                   content_type = a_deferred->response().content_type();
+                std::string                                         decoded;
+                casper::proxy::worker::codec::Decompressor::Headers stripped;
+                casper::proxy::worker::codec::Decompressor::Do(encoding, reinterpret_cast<const unsigned char*>(a_deferred->response().body().c_str()), a_deferred->response().body().length(), decoded);
+                casper::proxy::worker::codec::Decompressor::Stripped(a_deferred->response().headers(), stripped);
+                deferred->OverrideResponse(a_deferred->response().code(), content_type, stripped, decoded, /* a_parse */ false);
+            }
         }
-        (*data)["data"] = params.http_response().interceptor_.v8_data_;
-        //
-        // ⚠️ ☠️ calling 'non-trusted' function(s) ☠️ ⚠️
-        //
-        Evaluate((std::to_string(a_deferred->tracking_.bjid_) + "-response"), expr, (*data), response, provider->second->script());
-        //
-        // EXPECTED:
-        //  - JSON Object: { code:<numeric>, content_type:<string>, body:<string> }
-        //     or
-        //  - JSON Object: { intercepted: false }
-        //
-        // ... override?
-        if ( not ( true == response.isMember("intercepted") && false == response["intercepted"].asBool() ) ) {
-            // ... yes ...
-            overriden = true;
-            original  = new casper::job::deferrable::Response(deferred->response());
-            deferred->OverrideResponse(static_cast<uint16_t>(response["code"].asUInt()), response["content_type"].asString(), json.Write(response["body"]), /* a_parse */ false);
+        // ... native?
+        if ( true == native ) {
+            //
+            // ... prepare data ...
+            //
+            // ⚠️ body is NOT parsed here, it's passed as a string ⚠️
+            //
+            const std::string& body    = a_deferred->response().body();
+            const std::string  v8_data = json.Write(interceptor.v8_data_);
+            const auto registry = plugins_.find(params.id_);
+            if ( plugins_.end() == registry ) {
+                throw ::cc::Exception("No native interceptors loaded for provider '%s'!", params.id_.c_str());
+            }
+            casper::proxy::worker::native::Plugins::Result result;
+            registry->second->Intercept(expr, a_deferred->response().code(), a_deferred->response().content_type(), body, v8_data, result);
+            // ... override?
+            if ( true == result.intercepted_ ) {
+                // ... yes ...
+                overriden = true;
+                // ... log original response now, instead of keeping a copy of it ...
+                LogResponseOverride(a_deferred->response().code(), a_deferred->response().content_type(), a_deferred->response().body(), /* a_original */ true);
+                deferred->OverrideResponse(result.code_, result.content_type_, result.body_, /* a_parse */ false);
+            } else {
+                // ... log interception intent cancellation ...
+                LogResponseInterception("INTERCEPTION INTENT CANCELLED BY NATIVE INTERCEPTOR");
+            }
         } else {
-            // ... log interception intent cancellation ...
-            LogResponseInterception("INTERCEPTION INTENT CANCELLED DUE TO REPLY: " + json.Write(response));
+            // ... evaluated by an executor thread? if not ( executor busy ), evaluate it now ...
+            auto v8_deferred = static_cast<casper::proxy::worker::http::oauth2::Deferred*>(deferred);
+            if ( false == v8_deferred->intercepted() ) {
+                v8_deferred->Intercept(/* a_looper */ true);
+            }
+            if ( 0 != v8_deferred->interception_error().length() ) {
+                throw ::cc::Exception("%s", v8_deferred->interception_error().c_str());
+            }
+            response = v8_deferred->interception();
+            //
+            // EXPECTED:
+            //  - JSON Object: { code:<numeric>, content_type:<string>, body:<string> }
+            //     or
+            //  - JSON Object: { intercepted: false }
+            //
+            // ... override?
+            if ( not ( true == response.isMember("intercepted") && false == response["intercepted"].asBool() ) ) {
+                // ... yes ...
+                overriden = true;
+                // ... log original response now, instead of keeping a copy of it ...
+                LogResponseOverride(a_deferred->response().code(), a_deferred->response().content_type(), a_deferred->response().body(), /* a_original */ true);
+                // ... string bodies are used as-is, other values are serialized ...
+                const Json::Value& r_body = response["body"];
+                if ( true == r_body.isString() ) {
+                    deferred->OverrideResponse(static_cast<uint16_t>(response["code"].asUInt()), response["content_type"].asString(), r_body.asString(), /* a_parse */ false);
+                } else {
+                    deferred->OverrideResponse(static_cast<uint16_t>(response["code"].asUInt()), response["content_type"].asString(), json.Write(r_body), /* a_parse */ false);
+                }
+            } else {
+                // ... log interception intent cancellation ...
+                LogResponseInterception("INTERCEPTION INTENT CANCELLED DUE TO REPLY: " + json.Write(response));
+            }
         }
     } catch (const ::cc::Exception& a_cc_exception) {
-        if ( nullptr != data ) {
-            delete data;
-        }
-        deferred->OverrideResponse(CC_EASY_HTTP_INTERNAL_SERVER_ERROR, ::cc::Exception("An error ocurred while evaluating an 'interceptor' V8 expression '%s': %s",
-                                                                                       expr.c_str(), a_cc_exception.what()));
+        deferred->OverrideResponse(CC_EASY_HTTP_INTERNAL_SERVER_ERROR, ::cc::Exception("An error ocurred while evaluating an 'interceptor' %s '%s': %s",
+                                                                                       kind, expr.c_str(), a_cc_exception.what()));
     } catch (const Json::Exception& a_json_exception) {
-        if ( nullptr != data ) {
-            delete data;
-        }
-        deferred->OverrideResponse(CC_EASY_HTTP_INTERNAL_SERVER_ERROR, ::cc::Exception("An error ocurred while evaluating an 'interceptor' V8 expression '%s': %s",
-                                                                                       expr.c_str(), a_json_exception.what()));
+        deferred->OverrideResponse(CC_EASY_HTTP_INTERNAL_SERVER_ERROR, ::cc::Exception("An error ocurred while evaluating an 'interceptor' %s '%s': %s",
+                                                                                       kind, expr.c_str(), a_json_exception.what()));
     } catch (...) {
-        if ( nullptr != data ) {
-            delete data;
-        }
         try {
             ::cc::Exception::Rethrow(/* a_unhandled */ false, __FILE__, __LINE__, __FUNCTION__);
         } catch (const ::cc::Exception& a_cc_exception) {
-            deferred->OverrideResponse(CC_EASY_HTTP_INTERNAL_SERVER_ERROR, ::cc::Exception("An error ocurred while evaluating an 'interceptor' V8 expression '%s': %s",
-                                                                                           expr.c_str(), a_cc_exception.what()));
+            deferred->OverrideResponse(CC_EASY_HTTP_INTERNAL_SERVER_ERROR, ::cc::Exception("An error ocurred while evaluating an 'interceptor' %s '%s': %s",
+                                                                                           kind, expr.c_str(), a_cc_exception.what()));
         }
     }
     // ... if an exception ocurred ...
@@ -1283,10 +1534,6 @@ void casper::proxy::worker::http::oauth2::Client::InterceptResponse (const ::cas
     }
     // ... log ...
     if ( true == overriden ) {
-        if ( nullptr != original ) {
-            LogResponseOverride(original->code(), original->content_type(), original->body(), /* a_original */ true);
-            delete original;
-        }
         LogResponseOverride(a_deferred->response().code(), a_deferred->response().content_type(), a_deferred->response().body(), /* a_original */ false);
     }
 }
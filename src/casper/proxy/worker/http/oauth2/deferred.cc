@@ -25,6 +25,18 @@
 
 #include "cc/hash/sha256.h"
 
+#include "casper/proxy/worker/codec/json.h"
+#include "casper/proxy/worker/codec/decompressor.h"
+#include "casper/proxy/worker/executor/pool.h"
+#include "casper/proxy/worker/fs/writer.h"
+#include "casper/proxy/worker/fs/store.h"
+#include "casper/proxy/worker/fs/spill.h"
+#include "casper/proxy/worker/http/gateway.h"
+
+#include "cc/easy/json.h"
+
+#include <string.h> // strlen
+
 extern std::string ede (const std::string&);
 extern std::string edd (const std::string&);
 
@@ -43,7 +55,11 @@ casper::proxy::worker::http::oauth2::Deferred::Deferred (const casper::job::defe
 {
     http_options_         = HTTPOptions::OAuth2 | HTTPOptions::Trace | HTTPOptions::Redact;
     current_              = Deferred::Operation::NotSet;
+    kept_                 = Deferred::Operation::NotSet;
     allow_oauth2_restart_ = false;
+    processed_            = false;
+    prepared_             = false;
+    intercepted_          = false;
 }
 
 /**
@@ -424,6 +440,10 @@ void casper::proxy::worker::http::oauth2::Deferred::Finalize (const std::string&
 {
     // ... (in)sanity checkpoint ...
     CC_DEBUG_FAIL_IF_NOT_AT_MAIN_THREAD();
+    // ... build job payload off the looper thread, we'll be back here when it's done ...
+    if ( true == PostProcess(a_tag) ) {
+        return;
+    }
     // ... must be done on 'looper' thread ...
     CallOnLooperThread(a_tag, [this] (const std::string&) {
         // ... if request failed, and if we're tracing and did not log HTTP calls, should we do it now?
@@ -439,6 +459,244 @@ void casper::proxy::worker::http::oauth2::Deferred::Finalize (const std::string&
     }, /* a_daredevil */ true);
 }
 
+/**
+ * @brief Build job payload using \link executor::Pool \link, so that CPU or disk bound work ( files, compression, JSON parsing, gateway encoding ) doesn't stall the looper thread.
+ *
+ * @param a_tag Callback tag.
+ *
+ * @return True if it was submitted, \link Finalize \link will be called again when done.
+ */
+bool casper::proxy::worker::http::oauth2::Deferred::PostProcess (const std::string& a_tag)
+{
+    // ... (in)sanity checkpoint ...
+    CC_DEBUG_FAIL_IF_NOT_AT_MAIN_THREAD();
+    // ... only once ...
+    if ( true == processed_ || nullptr == arguments_ ) {
+        return false;
+    }
+    processed_ = true;
+    const auto& params = arguments_->parameters();
+    // ... exceptions, native interceptors and exposed grants require client ( looper thread ) data, so payload must be built there ...
+    if ( nullptr != response_.exception() || 0 != params.http_response().interceptor_.native_.length()
+            || ( casper::proxy::worker::http::oauth2::Parameters::RequestType::OAuth2Grant == params.request_type() && true == params.auth_code_request().expose_ ) ) {
+        return false;
+    }
+    // ... V8 interceptor?
+    if ( 0 != params.http_response().interceptor_.v8_expr_.length() ) {
+        // ... evaluate it on V8 executor, payload is still built on looper thread where interception is logged and applied ...
+        if ( nullptr == params.http_response().interceptor_.scripts_ ) {
+            return false;
+        }
+        return casper::proxy::worker::executor::Pool::GetV8Instance().Submit([this, a_tag] () {
+            Intercept(/* a_looper */ false);
+            // ... back to main thread, to finalize ...
+            CallOnMainThread([this, a_tag] () {
+                Finalize(a_tag);
+            });
+        });
+    }
+    // ... submit it, or fallback to looper thread if busy ...
+    return casper::proxy::worker::executor::Pool::GetInstance().Submit([this, a_tag] () {
+        try {
+            BuildPayload(arguments_->parameters(), response_, payload_);
+        } catch (const ::cc::Exception& a_exception) {
+            error_ = a_exception.what();
+        } catch (...) {
+            try {
+                ::cc::Exception::Rethrow(/* a_unhandled */ true, __FILE__, __LINE__, __FUNCTION__);
+            } catch (const ::cc::Exception& a_exception) {
+                error_ = a_exception.what();
+            }
+        }
+        prepared_ = true;
+        // ... back to main thread, to finalize ...
+        CallOnMainThread([this, a_tag] () {
+            Finalize(a_tag);
+        });
+    });
+}
+
+/**
+ * @brief Evaluate V8 response interceptor, from a V8 executor thread or from looper thread.
+ *
+ * @param a_looper True when called from looper thread, see \link v8::Pool::Mode \link.
+ *
+ * @discussion Only the V8 isolate is shared, it's leased by job id, so interceptors of different jobs are evaluated in parallel.
+ *             Upstream compressed bodies are decoded first, as interceptors inspect the body.
+ */
+void casper::proxy::worker::http::oauth2::Deferred::Intercept (const bool a_looper)
+{
+    // ... (in)sanity checkpoint ...
+    CC_DEBUG_ASSERT(false == intercepted_ && nullptr != arguments_);
+    const ::cc::easy::JSON<::cc::Exception> json;
+    const auto& params      = arguments_->parameters();
+    const auto& interceptor = params.http_response().interceptor_;
+    try {
+        // ... upstream compression negotiated? decode it now ...
+        if ( true == params.accept_encoding() ) {
+            const auto encoding = casper::proxy::worker::codec::Decompressor::Encoding(response_.headers());
+            if ( casper::proxy::worker::codec::Compressor::Codec::None != encoding ) {
+                const std::string                                   content_type = response_.content_type();
+                std::string                                         decoded;
+                casper::proxy::worker::codec::Decompressor::Headers stripped;
+                casper::proxy::worker::codec::Decompressor::Do(encoding, reinterpret_cast<const unsigned char*>(response_.body().c_str()), response_.body().length(), decoded);
+                casper::proxy::worker::codec::Decompressor::Stripped(response_.headers(), stripped);
+                OverrideResponse(response_.code(), content_type, stripped, decoded, /* a_parse */ false);
+            }
+        }
+        //
+        // ... prepare data ...
+        //
+        // ⚠️ body is NOT parsed here, it's passed as a string, interceptors should JSON.parse($.body) only if needed ⚠️
+        //
+        const std::string& body    = response_.body();
+        const std::string  v8_data = json.Write(interceptor.v8_data_);
+        std::string        data;
+        data.reserve(body.length() + v8_data.length() + response_.content_type().length() + 128);
+        data += "{\"code\":"           + std::to_string(response_.code());
+        data += ",\"content_type\":"   + json.Write(Json::Value(response_.content_type()));
+        data += ",\"content_length\":" + std::to_string(body.length());
+        data += ",\"data\":"           + v8_data;
+        data += ",\"body\":";
+        // ... escaped using it's full length, body might contain NUL bytes ...
+        data += json.Write(Json::Value(body.c_str(), body.c_str() + body.length()));
+        data += "}";
+        //
+        // ⚠️ ☠️ calling 'non-trusted' function(s) ☠️ ⚠️
+        //
+        const casper::proxy::worker::v8::Pool::Lease lease(*interceptor.scripts_, tracking_.bjid_,
+                                                           ( true == a_looper ? casper::proxy::worker::v8::Pool::Mode::Looper : casper::proxy::worker::v8::Pool::Mode::Executor ));
+        lease.script().Evaluate((std::to_string(tracking_.bjid_) + "-response"), interceptor.v8_expr_, data, interception_);
+    } catch (const ::cc::Exception& a_cc_exception) {
+        interception_error_ = a_cc_exception.what();
+    } catch (const Json::Exception& a_json_exception) {
+        interception_error_ = a_json_exception.what();
+    } catch (...) {
+        try {
+            ::cc::Exception::Rethrow(/* a_unhandled */ false, __FILE__, __LINE__, __FUNCTION__);
+        } catch (const ::cc::Exception& a_cc_exception) {
+            interception_error_ = a_cc_exception.what();
+        }
+    }
+    intercepted_ = true;
+}
+
+/**
+ * @brief Hand over job payload built by post-processing.
+ *
+ * @param o_payload JSON response to fill.
+ */
+void casper::proxy::worker::http::oauth2::Deferred::TakePayload (Json::Value& o_payload)
+{
+    // ... (in)sanity checkpoint ...
+    CC_DEBUG_ASSERT(true == prepared_);
+    // ... failed? report it as if it happened now ...
+    if ( 0 != error_.length() ) {
+        throw ::cc::Exception("%s", error_.c_str());
+    }
+    o_payload.swap(payload_);
+}
+
+/**
+ * @brief Build job payload.
+ *
+ * @param a_parameters Job parameters.
+ * @param a_response   Deferred request response.
+ * @param o_payload    JSON response to fill.
+ * @param a_body       Optional, already parsed JSON body, when set it will be moved into payload instead of parsing response body.
+ */
+void casper::proxy::worker::http::oauth2::Deferred::BuildPayload (const casper::proxy::worker::http::oauth2::Parameters& a_parameters, const ::casper::job::deferrable::Response& a_response,
+                                                                  Json::Value& o_payload, Json::Value* a_body)
+{
+    // ... set payload ...
+    o_payload = Json::Value(Json::ValueType::objectValue);
+    const bool to_file = ( false == a_parameters.primitive_ && 200 == a_response.code() && 0 != a_parameters.http_response().uri_.length() );
+    // ... upstream compression negotiated?
+    const auto encoding = ( true == a_parameters.accept_encoding() ? casper::proxy::worker::codec::Decompressor::Encoding(a_response.headers()) : casper::proxy::worker::codec::Compressor::Codec::None );
+    // ... if writing to file with the same compression, body is written as received, otherwise it's only decoded now, when it's needed ...
+    const bool passthrough = ( true == to_file && encoding == a_parameters.http_response().compression_ );
+    const bool decode      = ( casper::proxy::worker::codec::Compressor::Codec::None != encoding && false == passthrough );
+    std::string                                         decoded;
+    casper::proxy::worker::codec::Decompressor::Headers stripped;
+    if ( true == decode ) {
+        casper::proxy::worker::codec::Decompressor::Do(encoding, reinterpret_cast<const unsigned char*>(a_response.body().c_str()), a_response.body().length(), decoded);
+        casper::proxy::worker::codec::Decompressor::Stripped(a_response.headers(), stripped);
+    }
+    const std::string& body    = ( true == decode ? decoded  : a_response.body()    );
+    const auto&        headers = ( true == decode ? stripped : a_response.headers() );
+    // ... primitive or default?
+    if ( true == a_parameters.primitive_ ) {
+        // ... gateway response mode ....
+        // ... V1 or V2 format, see \link Gateway \link ...
+        const auto exception = a_response.exception();
+        if ( nullptr != exception ) {
+            casper::proxy::worker::http::Gateway::Encode(a_parameters.gateway_, a_response.code(), a_response.content_type(), exception->what(), strlen(exception->what()),
+                                                         headers, a_parameters.spill(), o_payload);
+        } else {
+            casper::proxy::worker::http::Gateway::Encode(a_parameters.gateway_, a_response.code(), a_response.content_type(), body.c_str(), body.length(),
+                                                         headers, a_parameters.spill(), o_payload);
+        }
+    } else if ( true == to_file ) {
+        const auto& config = a_parameters.http_response();
+        Write(config, body, /* a_encoded */ passthrough);
+        o_payload["url"] = config.url_;
+        // ... compressed?
+        const char* const content_type = casper::proxy::worker::codec::Compressor::ContentType(config.compression_);
+        if ( nullptr != content_type ) {
+            o_payload["content_type"] = content_type;
+        }
+    } else {
+        // ... body ...
+        if ( nullptr != a_body ) {
+            o_payload["body"].swap(*a_body);
+        } else if ( true == casper::proxy::worker::fs::Spill::Do(a_parameters.spill(), body, o_payload) ) {
+            // ... oversized, written to file ...
+        } else if ( true == ::cc::easy::JSON<::cc::Exception>::IsJSON(a_response.content_type()) ) {
+            casper::proxy::worker::codec::JSON::Parse(body, o_payload["body"]);
+        } else {
+            o_payload["body"] = body;
+        }
+        // ... headers ...
+        if ( headers.size() > 0 ) {
+            o_payload["headers"] = Json::Value(Json::ValueType::objectValue);
+            for ( const auto& header : headers ) {
+                o_payload["headers"][header.first] = header.second;
+            }
+        }
+        // ... code ...
+        o_payload["code"] = a_response.code();
+    }
+}
+
+/**
+ * @brief Compress ( if requested ) and write a response body to file.
+ *
+ * @param a_config  HTTP response config.
+ * @param a_body    Response body.
+ * @param a_encoded True if body is already compressed as requested, it will be written as-is.
+ */
+void casper::proxy::worker::http::oauth2::Deferred::Write (const casper::proxy::worker::http::oauth2::Parameters::HTTPResponse& a_config, const std::string& a_body,
+                                                           const bool a_encoded)
+{
+    const auto codec = ( true == a_encoded ? casper::proxy::worker::codec::Compressor::Codec::None : a_config.compression_ );
+    const auto write = [&a_config, &a_body, codec] () {
+        // ... body is fully buffered, so it's length is Content-Length: when not compressing reserve it ...
+        casper::proxy::worker::fs::Writer writer(a_config.uri_, ( casper::proxy::worker::codec::Compressor::Codec::None == codec ? a_body.length() : 0 ));
+        const casper::proxy::worker::codec::Compressor compressor(codec, a_config.level_);
+        compressor.Do(reinterpret_cast<const unsigned char*>(a_body.c_str()), a_body.length(), [&writer] (const unsigned char* const a_data, const size_t a_size) {
+            writer.Append(a_data, a_size);
+        });
+        writer.Close();
+    };
+    // ... same content, compressed the same way, is only written once ...
+    if ( 0 != a_config.store_.length() ) {
+        const std::string variant = ( casper::proxy::worker::codec::Compressor::Codec::None == codec ? "" : std::to_string(static_cast<int>(codec)) + "." + std::to_string(static_cast<int>(a_config.level_)) );
+        (void)casper::proxy::worker::fs::Store::Put(a_config.store_, casper::proxy::worker::fs::Store::Key(a_body, variant), a_config.uri_, write);
+    } else {
+        write();
+    }
+}
+
 // MARK: - HTTP && OAuth2 HTTP Clients
 
 /**
@@ -469,7 +727,7 @@ void casper::proxy::worker::http::oauth2::Deferred::OnHTTPRequestCompleted (cons
         std::map<std::string, std::string> headers;
         response_.Set(a_value.code(), content_type, a_value.headers_as_map(headers), a_value.body(), a_value.rtt());
     }
-    const std::string tag = std::to_string(tracking_.bjid_) + "-" + tracking_.rjid_ + "-" + '-' + ::cc::ObjectHexAddr<::cc::easy::http::oauth2::Client::Value>(&a_value) + operation_str_ + ( CC_EASY_HTTP_OK == response_.code() ? "-succeeded-" : "-failed-" );
+    const std::string tag = tags_(casper::proxy::worker::http::Tag::Hop::Completed);
     // ... parse response?
     bool acceptable = ( CC_EASY_HTTP_OK == response_.code() );
     if ( ::cc::easy::JSON<::cc::InternalServerError>::IsJSON(content_type) ) {
@@ -589,31 +847,44 @@ void casper::proxy::worker::http::oauth2::Deferred::OnHTTPRequestCompleted (cons
             }
         }
     }
-    // ... save response ...
-    responses_[current_] = response_;
+    // ... 'main' target is 'PerformRequest' operation response ...
+    const auto priority = [] (const Deferred::Operation a_operation) -> uint8_t {
+        switch (a_operation) {
+            case Deferred::Operation::PerformRequest: return 4;
+            case Deferred::Operation::SaveTokens    : return 3;
+            case Deferred::Operation::RestartOAuth2 : return 2;
+            case Deferred::Operation::LoadTokens    : return 1;
+            default                                 : return 0;
+        }
+    };
     // ... finalize now or still work to do?
     bool finalize = ( false == acceptable || 0 == operations_.size() );
     if ( finalize == false ) {
-        const std::string tag2 = std::to_string(tracking_.bjid_) + "-" + tracking_.rjid_ + "-";
+        // ... keep this response only if it might be the one to deliver, a later response of the same operation replaces it:
+        //     e.g. PerformRequest ( 401 ) -> RestartOAuth2 -> PerformRequest ( 200 ) -> SaveTokens must deliver the retry response ...
+        if ( priority(current_) >= priority(kept_) ) {
+            kept_          = current_;
+            kept_response_ = response_;
+        }
         // ... no, more work to do ...
         const auto next = operations_.front();
         operations_.erase(operations_.begin());
         switch(next) {
             case Deferred::Operation::RestartOAuth2:
             {
-                CallOnLooperThread(tag2 + "-restart-oauth2", [this](const std::string&) {
+                CallOnLooperThread(tags_(casper::proxy::worker::http::Tag::Hop::Restart), [this](const std::string&) {
                     allow_oauth2_restart_ = false;
                     ScheduleAuthorization(false, nullptr, 0);
                 });
             }
                 break;
             case Deferred::Operation::PerformRequest:
-                CallOnLooperThread(tag2 + "-perform-request", [this](const std::string&) {
+                CallOnLooperThread(tags_(casper::proxy::worker::http::Tag::Hop::Perform), [this](const std::string&) {
                     SchedulePerformRequest(false, nullptr, 0);
                 });
                 break;
             case Deferred::Operation::SaveTokens:
-                CallOnLooperThread(tag2 + "-save-tokens", [this](const std::string&) {
+                CallOnLooperThread(tags_(casper::proxy::worker::http::Tag::Hop::SaveTokens), [this](const std::string&) {
                     ScheduleSaveTokens(false, nullptr, 0);
                 });
                 break;
@@ -626,20 +897,9 @@ void casper::proxy::worker::http::oauth2::Deferred::OnHTTPRequestCompleted (cons
         // ... exception: override 302 responses ...
         if ( CC_EASY_HTTP_MOVED_TEMPORARILY == a_value.code() && Deferred::Operation::RestartOAuth2 == current_ ) {
             response_.Set(CC_EASY_HTTP_INTERNAL_SERVER_ERROR, "application/json", "{\"error\":\"unsupported_response\",\"error_description\":\"302 - 302 Moved Temporarily\"}", a_value.rtt());
-        } else if ( true == acceptable ) {
-            // ... 'main' target is 'PerformRequest' operation response ...
-            const std::vector<Deferred::Operation> priority = {
-                Deferred::Operation::PerformRequest, Deferred::Operation::SaveTokens, Deferred::Operation::RestartOAuth2, Deferred::Operation::LoadTokens
-            };
-            for ( const auto& p : priority ) {
-                const auto it = std::find_if(responses_.begin(), responses_.end(), [&p](const std::pair<Operation, job::deferrable::Response>& a_result) {
-                    return ( p == a_result.first );
-                });
-                if ( it != responses_.end() ) {
-                    response_ = it->second;
-                    break;
-                }
-            }
+        } else if ( true == acceptable && priority(kept_) > priority(current_) ) {
+            // ... a previous operation response takes precedence over this one, unless it's from the same operation ( latest wins ) ...
+            response_ = kept_response_;
         }
         // ... finalize ...
         Finalize(tag);
@@ -667,7 +927,7 @@ void casper::proxy::worker::http::oauth2::Deferred::OnHTTPRequestError (const ::
             break;
     }
     // ... finalize ...
-    Finalize(std::to_string(tracking_.bjid_) + "-" + tracking_.rjid_ + '-' + ::cc::ObjectHexAddr<::cc::easy::http::oauth2::Client::Error>(&a_value) + '-' + operation_str_ + "-error-");
+    Finalize(tags_(casper::proxy::worker::http::Tag::Hop::Error));
 }
 
 /**
@@ -682,7 +942,7 @@ void casper::proxy::worker::http::oauth2::Deferred::OnHTTPRequestFailure (const
     // ... set response ...
     response_.Set(CC_EASY_HTTP_INTERNAL_SERVER_ERROR, a_exception);
     // ... finalize ...
-    Finalize(std::to_string(tracking_.bjid_) + "-" + tracking_.rjid_ + '-' + ::cc::ObjectHexAddr<::cc::Exception>(&a_exception) + '-' + operation_str_ + "-failure-");
+    Finalize(tags_(casper::proxy::worker::http::Tag::Hop::Failure));
 }
 
 // MARK: - HTTP Client Callbacks
@@ -784,7 +1044,7 @@ void casper::proxy::worker::http::oauth2::Deferred::OnHTTPRequestWillRunLogIt (c
         )
     ) {
         // ... must be done on 'looper' thread ...
-        const std::string tag = std::to_string(tracking_.bjid_) + "-" + tracking_.rjid_ + '-' + ::cc::ObjectHexAddr<::cc::easy::http::oauth2::Client::Request>(&a_request) + "-log-http-oauth2-client-response";
+        const std::string tag = tags_(casper::proxy::worker::http::Tag::Hop::LogRequest);
         CallOnLooperThread(tag, [this, a_data, a_options] (const std::string&) {
             // ... log?
             if ( HTTPOptions::Log == ( HTTPOptions::Log & a_options ) ) {
@@ -822,7 +1082,7 @@ void casper::proxy::worker::http::oauth2::Deferred::OnHTTPRequestSteppedLogIt (c
     ) {
         const uint16_t code = a_value.code();
         // ... must be done on 'looper' thread ...
-        const std::string tag = std::to_string(tracking_.bjid_) + "-" + tracking_.rjid_ + '-' + ::cc::ObjectHexAddr<::cc::easy::http::oauth2::Client::Value>(&a_value) + "-log-http-oauth2-step";
+        const std::string tag = tags_(casper::proxy::worker::http::Tag::Hop::LogStep);
         CallOnLooperThread(tag, [this, a_data, a_options, code] (const std::string&) {
             // ... log?
             if ( HTTPOptions::Log == ( HTTPOptions::Log & a_options ) ) {
@@ -25,6 +25,7 @@
 #include "casper/job/deferrable/deferred.h"
 
 #include "casper/proxy/worker/http/oauth2/types.h"
+#include "casper/proxy/worker/http/tag.h"
 
 #include "cc/easy/http/client.h"
 #include "cc/easy/http/oauth2/client.h"
@@ -95,8 +96,17 @@ namespace casper
                         Operation                                       current_;               //!< Current operation.
                         std::vector<Operation>                          operations_;            //!< Chained operations.
                         std::string                                     operation_str_;         //!< Current operation, string representation.
-                        std::map<Operation, job::deferrable::Response>  responses_;             //!< Operations responses.
+                        Operation                                       kept_;                  //!< Operation whose response was kept, see \link kept_response_ \link.
+                        job::deferrable::Response                       kept_response_;         //!< Best ( by priority ) response of a previous operation, only while more work is pending.
                         bool                                            allow_oauth2_restart_;  //!< Mainly for grant_type 'client_credentials' or 'authorization_code-auto'.
+                        bool                                            processed_;             //!< True if post-processing was already attempted.
+                        bool                                            prepared_;              //!< True if job payload was built by post-processing.
+                        Json::Value                                     payload_;               //!< Job payload, built by post-processing.
+                        std::string                                     error_;                 //!< Post-processing error message, if any.
+                        bool                                            intercepted_;           //!< True if V8 interceptor was already evaluated, see \link Intercept \link.
+                        Json::Value                                     interception_;          //!< V8 interceptor evaluation result.
+                        std::string                                     interception_error_;    //!< V8 interceptor evaluation error message, if any.
+                        casper::proxy::worker::http::Tag                tags_;                  //!< Main / looper thread hop tags.
 
                     public: // Constructor(s) / Destructor
 
@@ -115,6 +125,7 @@ namespace casper
                         void ScheduleAuthorization  (const bool a_track, const char* const a_origin, const size_t a_delay);
                         void SchedulePerformRequest (const bool a_track, const char* const a_origin, const size_t a_delay);
                         void Finalize               (const std::string& a_tag);
+                        bool PostProcess            (const std::string& a_tag);
 
                     private: // Method(s) / Function(s) - HTTP && OAuth2 HTTP Client Request(s) Callbacks
 
@@ -143,6 +154,52 @@ namespace casper
                         void OnHTTPRequestWillRunLogIt (const ::cc::easy::http::oauth2::Client::Request&, const std::string&, const HTTPOptions);
                         void OnHTTPRequestSteppedLogIt (const ::cc::easy::http::oauth2::Client::Value&, const std::string&, const HTTPOptions);
 
+                    public: // Method(s) / Function(s)
+
+                        void TakePayload (Json::Value& o_payload);
+                        void Intercept   (const bool a_looper);
+
+                    public: // Inline Method(s) / Function(s)
+
+                        /**
+                         * @return True if job payload was already built ( off the looper thread ), see \link TakePayload \link.
+                         */
+                        inline bool prepared () const
+                        {
+                            return prepared_;
+                        }
+
+                        /**
+                         * @return True if V8 interceptor was already evaluated, see \link Intercept \link.
+                         */
+                        inline bool intercepted () const
+                        {
+                            return intercepted_;
+                        }
+
+                        /**
+                         * @return V8 interceptor evaluation result, only valid if \link intercepted \link and \link interception_error \link is empty.
+                         */
+                        inline const Json::Value& interception () const
+                        {
+                            return interception_;
+                        }
+
+                        /**
+                         * @return V8 interceptor evaluation error message, empty if none.
+                         */
+                        inline const std::string& interception_error () const
+                        {
+                            return interception_error_;
+                        }
+
+                    public: // Static Method(s) / Function(s)
+
+                        static void BuildPayload (const casper::proxy::worker::http::oauth2::Parameters& a_parameters, const ::casper::job::deferrable::Response& a_response,
+                                                  Json::Value& o_payload, Json::Value* a_body = nullptr);
+                        static void Write        (const casper::proxy::worker::http::oauth2::Parameters::HTTPResponse& a_config, const std::string& a_body,
+                                                  const bool a_encoded = false);
+
                     }; // end of class 'Deferred'
 
                     inline std::string MakeID (const ::casper::job::deferrable::Tracking& a_tracking)
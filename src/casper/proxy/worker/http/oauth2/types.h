@@ -29,7 +29,10 @@
 #include "cc/non-movable.h"
 
 #include "cc/easy/http/oauth2/client.h"
-#include "casper/proxy/worker/v8/script.h"
+#include "casper/proxy/worker/v8/pool.h"
+#include "casper/proxy/worker/http/gateway.h"
+#include "casper/proxy/worker/codec/compressor.h"
+#include "casper/proxy/worker/fs/spill.h"
 
 #include <string>
 #include <map>
@@ -84,6 +87,9 @@ namespace casper
                         typedef struct {
                             int64_t     validity_;
                             std::string base_url_;
+                            size_t      spill_threshold_; //!< response bodies larger than this, in bytes, are written to file, 0 disables it
+                            bool        dedupe_;          //!< when true, identical files are stored once, see \link fs::Store \link
+                            int64_t     bucket_;          //!< when > 0, files are written to time bucketed directories of this size, in seconds, see \link fs::Sweeper \link
                         } TMPConfig;
                         
                     public: // Const Data
@@ -94,12 +100,13 @@ namespace casper
                         const ::cc::easy::http::oauth2::Client::HeadersPerMethod headers_per_method_; //!< additional headers per request per method
                         const Signing                                            signing_;            //!< signing configs
                         const TMPConfig                                          tmp_config_;         //!< TMP files config.
+                        const codec::Compressor::Policy                          body_compression_;   //!< request body compression
                         
                     private: // Data
                         
                         Storage*     storage_;     //!< storage config
                         Storageless* storageless_; //!< storageless config
-                        v8::Script*  script_;      //!< v8 script
+                        v8::Pool*    scripts_;     //!< v8 scripts, one per isolate
 
                     public: // Constructor(s) / Destructor
                         
@@ -113,15 +120,17 @@ namespace casper
                          * @param a_headers_per_method Additional headers per request per method.
                          * @param a_signing            Signing config.
                          * @param a_tmp_config         TMP config.
+                         * @param a_body_compression   Request body compression policy.
                          * @param a_storage            Storage config.
                          */
                         Config (const ::cc::easy::http::oauth2::Client::Config& a_config, const ::cc::easy::http::oauth2::Client::Headers& a_headers,
-                                const ::cc::easy::http::oauth2::Client::HeadersPerMethod& a_headers_per_method, const Signing& a_signing, const TMPConfig& a_tmp_config, const Storage& a_storage)
-                         : type_(Type::Storage), http_(a_config), headers_(a_headers), headers_per_method_(a_headers_per_method), signing_(a_signing), tmp_config_(a_tmp_config)
+                                const ::cc::easy::http::oauth2::Client::HeadersPerMethod& a_headers_per_method, const Signing& a_signing, const TMPConfig& a_tmp_config,
+                                const codec::Compressor::Policy& a_body_compression, const Storage& a_storage)
+                         : type_(Type::Storage), http_(a_config), headers_(a_headers), headers_per_method_(a_headers_per_method), signing_(a_signing), tmp_config_(a_tmp_config), body_compression_(a_body_compression)
                         {
                             storage_     = new Storage(a_storage);
                             storageless_ = nullptr;
-                            script_      = nullptr;
+                            scripts_     = nullptr;
                         }
 
                         /**
@@ -132,15 +141,17 @@ namespace casper
                          * @param a_headers_per_method Additional headers per request per method.
                          * @param a_signing            Signing config.
                          * @param a_tmp_config         TMP config.
+                         * @param a_body_compression   Request body compression policy.
                          * @param a_storageless        Storageless config.
                          */
                         Config (const ::cc::easy::http::oauth2::Client::Config& a_config, const ::cc::easy::http::oauth2::Client::Headers& a_headers,
-                                const ::cc::easy::http::oauth2::Client::HeadersPerMethod& a_headers_per_method, const Signing& a_signing, const TMPConfig& a_tmp_config, const Storageless& a_storageless)
-                         : type_(Type::Storageless), http_(a_config), headers_(a_headers), headers_per_method_(a_headers_per_method), signing_(a_signing), tmp_config_(a_tmp_config)
+                                const ::cc::easy::http::oauth2::Client::HeadersPerMethod& a_headers_per_method, const Signing& a_signing, const TMPConfig& a_tmp_config,
+                                const codec::Compressor::Policy& a_body_compression, const Storageless& a_storageless)
+                         : type_(Type::Storageless), http_(a_config), headers_(a_headers), headers_per_method_(a_headers_per_method), signing_(a_signing), tmp_config_(a_tmp_config), body_compression_(a_body_compression)
                         {
                             storage_                          = nullptr;
                             storageless_                      = new Storageless(a_storageless);
-                            script_                           = nullptr;
+                            scripts_                          = nullptr;
                             storageless_->tokens_.type_       = "";
                             storageless_->tokens_.access_     = "";
                             storageless_->tokens_.refresh_    = "";
@@ -155,11 +166,11 @@ namespace casper
                          * @param a_config Object to copy.
                          */
                         Config (const Config& a_config)
-                        : type_(a_config.type_), http_(a_config.http_), headers_(a_config.headers_), headers_per_method_(a_config.headers_per_method_), signing_(a_config.signing_), tmp_config_(a_config.tmp_config_)
+                        : type_(a_config.type_), http_(a_config.http_), headers_(a_config.headers_), headers_per_method_(a_config.headers_per_method_), signing_(a_config.signing_), tmp_config_(a_config.tmp_config_), body_compression_(a_config.body_compression_)
                         {
                             storage_     = ( nullptr != a_config.storage_     ? new Storage(*a_config.storage_)         : nullptr );
                             storageless_ = ( nullptr != a_config.storageless_ ? new Storageless(*a_config.storageless_) : nullptr );
-                            script_      = ( nullptr != a_config.script_      ? new v8::Script(*a_config.script_)       : nullptr );
+                            scripts_     = ( nullptr != a_config.scripts_     ? new v8::Pool(*a_config.scripts_)        : nullptr );
                         }
 
                         /**
@@ -173,8 +184,8 @@ namespace casper
                             if ( nullptr != storageless_ ) {
                                 delete storageless_;
                             }
-                            if ( nullptr != script_ ) {
-                                delete script_;
+                            if ( nullptr != scripts_ ) {
+                                delete scripts_;
                             }
                         }
                         
@@ -219,29 +230,31 @@ namespace casper
                         }
                         
                         /**
-                         * @brief Prepare v8 script, exception for better tracking of variables write acccess.
+                         * @brief Prepare v8 scripts pool, exception for better tracking of variables write acccess.
                          *
                          * @param a_loggable_data TO BE COPIED
+                         * @param a_size          Number of isolates.
                          *
-                         * @return R/W access to v8 script.
+                         * @return R/W access to v8 scripts pool.
                          */
-                        inline v8::Script& script (const ::ev::Loggable::Data& a_loggable_data,
-                                                   const std::string& a_owner, const std::string& a_name, const std::string& a_uri,
-                                                   const std::string& a_out_path, const ::cc::crypto::RSA::SignOutputFormat a_signature_output_format)
+                        inline v8::Pool& scripts (const ::ev::Loggable::Data& a_loggable_data,
+                                                  const std::string& a_owner, const std::string& a_name, const std::string& a_uri,
+                                                  const std::string& a_out_path, const std::string& a_cache_dir, const ::cc::crypto::RSA::SignOutputFormat a_signature_output_format,
+                                                  const size_t a_size)
                         {
-                            if ( nullptr == script_ ) {
-                                script_ = new casper::proxy::worker::v8::Script(a_loggable_data, a_owner, a_name, a_uri, a_out_path, a_signature_output_format);
+                            if ( nullptr == scripts_ ) {
+                                scripts_ = new casper::proxy::worker::v8::Pool(a_loggable_data, a_owner, a_name, a_uri, a_out_path, a_cache_dir, a_signature_output_format, a_size);
                             }
-                            return *script_;
+                            return *scripts_;
                         }
 
                         /**
-                         * @return R/W access to v8 script.
+                         * @return R/W access to v8 scripts pool.
                          */
-                        inline v8::Script& script ()
+                        inline v8::Pool& scripts ()
                         {
-                            if ( nullptr != script_ ) {
-                                return *script_;
+                            if ( nullptr != scripts_ ) {
+                                return *scripts_;
                             }
                             throw cc::InternalServerError("Invalid call to %s!", __PRETTY_FUNCTION__);
                         }
@@ -289,15 +302,18 @@ namespace casper
                         typedef struct {
                             std::string v8_expr_;
                             Json::Value v8_data_;
+                            std::string native_;  //!< native interceptor name, if set takes precedence over V8 expression
+                            v8::Pool*   scripts_; //!< provider isolates, when set V8 expression is evaluated off the looper thread
                         } ResponseInterceptor;
                         
                         typedef struct {
-                            std::string         uri_;         //!< local file URI.
-                            std::string         url_;         //!< URL to access file
-                            bool                deflated_;    //!< if true, will deflated data
-                            int8_t              level_;       //!< ZLib ccompression level, -1...9, Z_DEFAULT_COMPRESSION ( -1 )
-                            int64_t             validity_;    //!< local file validity
-                            ResponseInterceptor interceptor_; //!< response interception: if set response will be intercepted via V8 expression evaluation
+                            std::string              uri_;         //!< local file URI.
+                            std::string              url_;         //!< URL to access file
+                            codec::Compressor::Codec compression_; //!< output compression, 'deflated' is kept as an alias of 'deflate'
+                            int8_t                   level_;       //!< compression level, -1 for codec's default, see \link codec::Compressor::ValidateLevel \link
+                            int64_t                  validity_;    //!< local file validity
+                            ResponseInterceptor      interceptor_; //!< response interception: if set response will be intercepted via V8 expression evaluation or native interceptor
+                            std::string              store_;       //!< content addressed store directory, empty if disabled, see \link fs::Store \link
                         } HTTPResponse;
                         
                         typedef struct {
@@ -316,6 +332,7 @@ namespace casper
                         const Config::Type                              type_;
                         const Json::Value&                              data_;
                         const bool                                      primitive_;
+                        const Gateway::Format                           gateway_;
                         const size_t                                    log_level_;
                         const bool                                      log_redact_;
                         
@@ -326,6 +343,8 @@ namespace casper
                         HTTPRequest*                                http_req_;      //!< Evaluated HTTP request data.
                         HTTPResponse*                               http_resp_;     //!< Evaluated HTTP response config.
                         GrantAuthCodeRequest*                       auth_code_req_; //!< Evaludated authorization code request
+                        fs::Spill::Config                           spill_;         //!< Oversized bodies config.
+                        bool                                        accept_encoding_; //!< True if upstream compression was negotiated.
                         
                     public: // Constructor(s) / Destructor
                         
@@ -338,14 +357,16 @@ namespace casper
                          * @param a_type       One of \link Config::Type \link.
                          * @param a_data       JSON object.
                          * @param a_primitive  True when response should be done in 'primitive' mode.
+                         * @param a_gateway    'primitive' mode format, one of \link Gateway::Format \link.
                          * @param a_log_level  Log level.
                          * @param a_log_redact Log redact flag.
                          */
                         Parameters (const std::string& a_id,
                                     const Config::Type a_type,
-                                    const Json::Value& a_data, const bool a_primitive, const size_t a_log_level, const bool a_log_redact)
-                         : id_(a_id), type_(a_type), data_(a_data), primitive_(a_primitive), log_level_(a_log_level), log_redact_(a_log_redact),
-                            config_(nullptr), storage_(nullptr), http_req_(nullptr), http_resp_(nullptr), auth_code_req_(nullptr)
+                                    const Json::Value& a_data, const bool a_primitive, const Gateway::Format a_gateway, const size_t a_log_level, const bool a_log_redact)
+                         : id_(a_id), type_(a_type), data_(a_data), primitive_(a_primitive), gateway_(a_gateway), log_level_(a_log_level), log_redact_(a_log_redact),
+                            config_(nullptr), storage_(nullptr), http_req_(nullptr), http_resp_(nullptr), auth_code_req_(nullptr),
+                            spill_({ /* threshold_ */ 0, /* dir_ */ "", /* prefix_ */ "", /* base_url_ */ "", /* store_ */ "" }), accept_encoding_(false)
                         {
                             /* empty */
                         }
@@ -356,8 +377,9 @@ namespace casper
                          * @param a_parameters Object to copy.
                          */
                         Parameters (const Parameters& a_parameters)
-                         : id_(a_parameters.id_), type_(a_parameters.type_), data_(a_parameters.data_), primitive_(a_parameters.primitive_), log_level_(a_parameters.log_level_), log_redact_(a_parameters.log_redact_),
-                            config_(nullptr), storage_(nullptr), http_req_(nullptr), http_resp_(nullptr), auth_code_req_(nullptr)
+                         : id_(a_parameters.id_), type_(a_parameters.type_), data_(a_parameters.data_), primitive_(a_parameters.primitive_), gateway_(a_parameters.gateway_), log_level_(a_parameters.log_level_), log_redact_(a_parameters.log_redact_),
+                            config_(nullptr), storage_(nullptr), http_req_(nullptr), http_resp_(nullptr), auth_code_req_(nullptr),
+                            spill_(a_parameters.spill_), accept_encoding_(a_parameters.accept_encoding_)
                         {
                             if ( nullptr != a_parameters.config_ ) {
                                 config_ = new ::cc::easy::http::oauth2::Client::Config(*a_parameters.config_);
@@ -584,13 +606,16 @@ namespace casper
                                 http_resp_ = new HTTPResponse({
                                     /* uri_               */ "",
                                     /* url_               */ "",
-                                    /* deflated_          */ false,
+                                    /* compression_       */ codec::Compressor::Codec::None,
                                     /* level_             */ -1,
                                     /* validity_          */ -1,
                                     /* interceptor */ {
                                         /* v8_expr_ */ "",
-                                        /* v8_data_ */ Json::nullValue
-                                    }
+                                        /* v8_data_ */ Json::nullValue,
+                                        /* native_  */ "",
+                                        /* scripts_ */ nullptr
+                                    },
+                                    /* store_             */ ""
                                 });
                             }
                             // ... callback ...
@@ -598,6 +623,43 @@ namespace casper
                             // ... done ...
                             return *http_resp_;
                         }
+
+                        /**
+                         * @return R/O access to spill config, see \link fs::Spill \link.
+                         */
+                        inline const fs::Spill::Config& spill () const
+                        {
+                            return spill_;
+                        }
+                        
+                        /**
+                         * @brief Prepare spill config, exception for better tracking of variables write acccess.
+                         *
+                         * @return R/O access to spill config.
+                         */
+                        inline const fs::Spill::Config& spill (const std::function<void(fs::Spill::Config&)>& a_callback)
+                        {
+                            a_callback(spill_);
+                            return spill_;
+                        }
+
+                        /**
+                         * @return True if upstream compression was negotiated, see \link codec::Decompressor \link.
+                         */
+                        inline bool accept_encoding () const
+                        {
+                            return accept_encoding_;
+                        }
+                        
+                        /**
+                         * @brief Set upstream compression negotiation flag.
+                         *
+                         * @param a_value True if 'Accept-Encoding' header was set by us.
+                         */
+                        inline void accept_encoding (const bool a_value)
+                        {
+                            accept_encoding_ = a_value;
+                        }
                         
                         /**
                          * @brief Prepare request tokens data, exception for better tracking of variables write acccess.
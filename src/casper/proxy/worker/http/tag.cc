@@ -0,0 +1,63 @@
+/**
+ * @file tag.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/proxy/worker/http/tag.h"
+
+std::atomic<uint32_t> casper::proxy::worker::http::Tag::s_next_serial_(0);
+
+/**
+ * @brief Default constructor.
+ */
+casper::proxy::worker::http::Tag::Tag ()
+: serial_(s_next_serial_++), hop_(0)
+{
+    /* empty */
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::proxy::worker::http::Tag::~Tag ()
+{
+    /* empty */
+}
+
+/**
+ * @brief Make a new tag, from any thread.
+ *
+ * @param a_hop Why thread is being changed, one of \link Hop \link.
+ *
+ * @return Tag.
+ */
+std::string casper::proxy::worker::http::Tag::operator () (const casper::proxy::worker::http::Tag::Hop a_hop)
+{
+    static const char* const k_digits_ = "0123456789abcdef";
+    const uint16_t hop = hop_++;
+    char           buffer[13];
+    for ( size_t idx = 0 ; idx < 8 ; ++idx ) {
+        buffer[idx] = k_digits_[( serial_ >> ( 28 - 4 * idx ) ) & 0xF];
+    }
+    for ( size_t idx = 0 ; idx < 4 ; ++idx ) {
+        buffer[8 + idx] = k_digits_[( hop >> ( 12 - 4 * idx ) ) & 0xF];
+    }
+    buffer[12] = static_cast<char>(a_hop);
+    return std::string(buffer, sizeof(buffer) / sizeof(buffer[0]));
+}
@@ -0,0 +1,112 @@
+/**
+ * @file tag.h
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#ifndef CASPER_PROXY_WORKER_HTTP_TAG_H_
+#define CASPER_PROXY_WORKER_HTTP_TAG_H_
+
+#include "cc/non-movable.h"
+
+#include <atomic>
+#include <string>
+
+#include <stdint.h>
+
+namespace casper
+{
+
+    namespace proxy
+    {
+
+        namespace worker
+        {
+
+            namespace http
+            {
+
+                //
+                // Compact, unique, thread hop tags for deferred requests.
+                //
+                // - '<serial><hop><kind>', 13 characters, short enough to never allocate ( small string optimization );
+                // - serial is unique per deferred request ( process wide ), hop is incremented per tag, so tags are never reused while in use;
+                // - only meant to identify callbacks, job and request IDs are available from the deferred request itself when logging.
+                //
+                class Tag final : public ::cc::NonMovable
+                {
+
+                public: // Data Type(s)
+
+                    enum class Hop : char {
+                        Completed   = 'c',
+                        Error       = 'e',
+                        Failure     = 'f',
+                        Revalidated = 'r',
+                        Ranged      = 'g',
+                        LogRequest  = 'q',
+                        LogStep     = 's',
+                        Restart     = 'o',
+                        Perform     = 'p',
+                        SaveTokens  = 't'
+                    };
+
+                private: // Static Data
+
+                    static std::atomic<uint32_t> s_next_serial_;
+
+                private: // Const Data
+
+                    const uint32_t        serial_;
+
+                private: // Data
+
+                    std::atomic<uint16_t> hop_;
+
+                public: // Constructor(s) / Destructor
+
+                    Tag ();
+                    Tag (const Tag&) = delete;
+                    virtual ~Tag ();
+
+                public: // Overloaded Operator(s)
+
+                    void        operator = (Tag const&) = delete;  // assignment is not allowed
+                    std::string operator () (const Hop a_hop);
+
+                public: // Inline Method(s) / Function(s)
+
+                    /**
+                     * @return Process wide unique ID.
+                     */
+                    inline uint32_t serial () const
+                    {
+                        return serial_;
+                    }
+
+                }; // end of class 'Tag'
+
+            } // end of namespace 'http'
+
+        } // end of namespace 'worker'
+
+    } // end of namespace 'proxy'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_PROXY_WORKER_HTTP_TAG_H_
@@ -24,6 +24,10 @@
 
 #include "casper/job/deferrable/arguments.h"
 
+#include "casper/proxy/worker/http/gateway.h"
+#include "casper/proxy/worker/http/index.h"
+#include "casper/proxy/worker/fs/spill.h"
+
 #include "cc/non-movable.h"
 
 #include "cc/easy/http/client.h"
@@ -71,12 +75,18 @@ namespace casper
                         std::string         url_;         //!< URL to access file
                         bool                base64_;      //!< if true will convert do base64
                         int64_t             validity_;    //!< local file validity
+                        uint8_t             connections_; //!< when > 1, number of concurrent ranges to download file with
+                        uint64_t            range_size_;  //!< maximum range size, in bytes
+                        std::string         key_;         //!< download index key, empty if downloads should not be reused
+                        Index::Entry        cached_;      //!< previous download being revalidated, empty URI if none
+                        std::string         store_;       //!< content addressed store directory, empty if disabled, see \link fs::Store \link
                     } HTTPResponse;
                     
                 public: // Const Data
                     
                     const Json::Value&                       data_;
                     const bool                               primitive_;
+                    const Gateway::Format                    gateway_;
                     const size_t                             log_level_;
                     const bool                               log_redact_;
                     
@@ -84,6 +94,8 @@ namespace casper
                     
                     HTTPRequest*                             http_req_;      //!< Evaluated HTTP request data.
                     HTTPResponse*                            http_resp_;     //!< Evaluated HTTP response config.
+                    fs::Spill::Config                        spill_;         //!< Oversized bodies config.
+                    bool                                     accept_encoding_; //!< True if upstream compression was negotiated.
                     
                 public: // Constructor(s) / Destructor
                     
@@ -94,12 +106,14 @@ namespace casper
                      *
                      * @param a_data       JSON object.
                      * @param a_primitive  True when response should be done in 'primitive' mode.
+                     * @param a_gateway    'primitive' mode format, one of \link Gateway::Format \link.
                      * @param a_log_level  Log level.
                      * @param a_log_redact Log redact flag.
                      */
-                    Parameters (const Json::Value& a_data, const bool a_primitive, const size_t a_log_level, const bool a_log_redact)
-                     : data_(a_data), primitive_(a_primitive), log_level_(a_log_level), log_redact_(a_log_redact),
-                       http_req_(nullptr), http_resp_(nullptr)
+                    Parameters (const Json::Value& a_data, const bool a_primitive, const Gateway::Format a_gateway, const size_t a_log_level, const bool a_log_redact)
+                     : data_(a_data), primitive_(a_primitive), gateway_(a_gateway), log_level_(a_log_level), log_redact_(a_log_redact),
+                       http_req_(nullptr), http_resp_(nullptr), spill_({ /* threshold_ */ 0, /* dir_ */ "", /* prefix_ */ "", /* base_url_ */ "", /* store_ */ "" }),
+                       accept_encoding_(false)
                     {
                         /* empty */
                     }
@@ -110,8 +124,9 @@ namespace casper
                      * @param a_parameters Object to copy.
                      */
                     Parameters (const Parameters& a_parameters)
-                     : data_(a_parameters.data_), primitive_(a_parameters.primitive_), log_level_(a_parameters.log_level_), log_redact_(a_parameters.log_redact_),
-                       http_req_(nullptr), http_resp_(nullptr)
+                     : data_(a_parameters.data_), primitive_(a_parameters.primitive_), gateway_(a_parameters.gateway_), log_level_(a_parameters.log_level_), log_redact_(a_parameters.log_redact_),
+                       http_req_(nullptr), http_resp_(nullptr), spill_(a_parameters.spill_),
+                       accept_encoding_(a_parameters.accept_encoding_)
                     {
                         if ( nullptr != a_parameters.http_req_ ) {
                             http_req_ = new HTTPRequest(*a_parameters.http_req_);
@@ -212,7 +227,12 @@ namespace casper
                                 /* uri_               */ "",
                                 /* url_               */ "",
                                 /* base64_            */ false,
-                                /* validity_          */ -1
+                                /* validity_          */ -1,
+                                /* connections_       */ 1,
+                                /* range_size_        */ 0,
+                                /* key_               */ "",
+                                /* cached_            */ { /* uri_ */ "", /* etag_ */ "", /* last_modified_ */ "", /* expires_ */ 0 },
+                                /* store_             */ ""
                             });
                         }
                         // ... callback ...
@@ -221,6 +241,43 @@ namespace casper
                         return *http_resp_;
                     }
 
+                    /**
+                     * @return R/O access to spill config, see \link fs::Spill \link.
+                     */
+                    inline const fs::Spill::Config& spill () const
+                    {
+                        return spill_;
+                    }
+                    
+                    /**
+                     * @brief Prepare spill config, exception for better tracking of variables write acccess.
+                     *
+                     * @return R/O access to spill config.
+                     */
+                    inline const fs::Spill::Config& spill (const std::function<void(fs::Spill::Config&)>& a_callback)
+                    {
+                        a_callback(spill_);
+                        return spill_;
+                    }
+
+                    /**
+                     * @return True if upstream compression was negotiated, see \link codec::Decompressor \link.
+                     */
+                    inline bool accept_encoding () const
+                    {
+                        return accept_encoding_;
+                    }
+                    
+                    /**
+                     * @brief Set upstream compression negotiation flag.
+                     *
+                     * @param a_value True if 'Accept-Encoding' header was set by us.
+                     */
+                    inline void accept_encoding (const bool a_value)
+                    {
+                        accept_encoding_ = a_value;
+                    }
+
                 }; // end of class 'Parameters'
             
                 // MARK: -
@@ -0,0 +1,80 @@
+/**
+ * @file interceptor.h
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#ifndef CASPER_PROXY_WORKER_NATIVE_INTERCEPTOR_H_
+#define CASPER_PROXY_WORKER_NATIVE_INTERCEPTOR_H_
+
+//
+// Native response interceptors - stable C ABI.
+//
+// A plugin is a shared object that exports:
+//
+//   int  casper_proxy_worker_plugin_load   (unsigned a_abi, void* a_registry, casper_proxy_worker_interceptor_register_t a_register);
+//   void casper_proxy_worker_plugin_unload (void);                                                                         ( optional )
+//
+// 'load' is called once, at tube setup, and should call a_register for each interceptor it provides, returning 0 on success.
+// Interceptors receive the same input as V8 interceptors ( code, content type, raw body and 'data' as JSON ) and must honor the same
+// contract: leave 'intercepted' as 0 to keep the original response, or set it to 1 and fill code, content type and body.
+// Output buffers are owned by the plugin and are released by calling the provided release function ( if any ).
+//
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CASPER_PROXY_WORKER_INTERCEPTOR_ABI 1
+
+typedef struct {
+    uint16_t    code;
+    const char* content_type;
+    size_t      content_type_length;
+    const char* body;
+    size_t      body_length;
+    const char* data;        /* JSON */
+    size_t      data_length;
+} casper_proxy_worker_interceptor_input_t;
+
+typedef struct {
+    int         intercepted; /* 0 - keep original response, 1 - override it */
+    uint16_t    code;
+    const char* content_type;
+    size_t      content_type_length;
+    const char* body;
+    size_t      body_length;
+    const char* error;       /* set on failure, NULL terminated */
+} casper_proxy_worker_interceptor_output_t;
+
+typedef int  (*casper_proxy_worker_interceptor_t)          (void* a_context, const casper_proxy_worker_interceptor_input_t* a_input, casper_proxy_worker_interceptor_output_t* o_output);
+typedef void (*casper_proxy_worker_interceptor_release_t)  (void* a_context, casper_proxy_worker_interceptor_output_t* a_output);
+typedef int  (*casper_proxy_worker_interceptor_register_t) (void* a_registry, const char* a_name,
+                                                            casper_proxy_worker_interceptor_t a_function, casper_proxy_worker_interceptor_release_t a_release, void* a_context);
+
+typedef int  (*casper_proxy_worker_plugin_load_t)   (unsigned a_abi, void* a_registry, casper_proxy_worker_interceptor_register_t a_register);
+typedef void (*casper_proxy_worker_plugin_unload_t) (void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CASPER_PROXY_WORKER_NATIVE_INTERCEPTOR_H_
@@ -0,0 +1,155 @@
+/**
+ * @file plugins.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/proxy/worker/native/plugins.h"
+
+#include "cc/exception.h"
+
+#include <dlfcn.h> // dlopen, dlsym, dlclose
+
+/**
+ * @brief Default constructor.
+ */
+casper::proxy::worker::native::Plugins::Plugins ()
+{
+    /* empty */
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::proxy::worker::native::Plugins::~Plugins ()
+{
+    interceptors_.clear();
+    for ( const auto& it : handles_ ) {
+        const auto unload = reinterpret_cast<casper_proxy_worker_plugin_unload_t>(dlsym(it.second, "casper_proxy_worker_plugin_unload"));
+        if ( nullptr != unload ) {
+            unload();
+        }
+        dlclose(it.second);
+    }
+    handles_.clear();
+}
+
+/**
+ * @brief Load a plugin and let it register it's interceptors.
+ *
+ * @param a_uri Shared object URI.
+ */
+void casper::proxy::worker::native::Plugins::Load (const std::string& a_uri)
+{
+    // ... already loaded?
+    if ( handles_.end() != handles_.find(a_uri) ) {
+        return;
+    }
+    void* handle = dlopen(a_uri.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if ( nullptr == handle ) {
+        throw ::cc::InternalServerError("Unable to load plugin '%s': %s!", a_uri.c_str(), dlerror());
+    }
+    const auto load = reinterpret_cast<casper_proxy_worker_plugin_load_t>(dlsym(handle, "casper_proxy_worker_plugin_load"));
+    if ( nullptr == load ) {
+        dlclose(handle);
+        throw ::cc::InternalServerError("Unable to load plugin '%s': missing 'casper_proxy_worker_plugin_load' symbol!", a_uri.c_str());
+    }
+    // ... keep track of it now, so it's released even if registration fails ...
+    handles_[a_uri] = handle;
+    loading_        = a_uri;
+    const int rv = load(CASPER_PROXY_WORKER_INTERCEPTOR_ABI, this, casper::proxy::worker::native::Plugins::Register);
+    loading_        = "";
+    if ( 0 != rv ) {
+        throw ::cc::InternalServerError("Unable to load plugin '%s': initialization failed with code %d!", a_uri.c_str(), rv);
+    }
+}
+
+/**
+ * @brief Call a native interceptor.
+ *
+ * @param a_name         Interceptor name.
+ * @param a_code         Original response status code.
+ * @param a_content_type Original response content type.
+ * @param a_body         Original response body.
+ * @param a_data         Interceptor data, as JSON string.
+ * @param o_result       Interception result.
+ */
+void casper::proxy::worker::native::Plugins::Intercept (const std::string& a_name,
+                                                        const uint16_t a_code, const std::string& a_content_type, const std::string& a_body, const std::string& a_data,
+                                                        casper::proxy::worker::native::Plugins::Result& o_result) const
+{
+    const auto it = interceptors_.find(a_name);
+    if ( interceptors_.end() == it ) {
+        throw ::cc::BadRequest("Unknown native interceptor '%s'!", a_name.c_str());
+    }
+    const casper_proxy_worker_interceptor_input_t input = {
+        /* code                */ a_code,
+        /* content_type        */ a_content_type.c_str(),
+        /* content_type_length */ a_content_type.length(),
+        /* body                */ a_body.c_str(),
+        /* body_length         */ a_body.length(),
+        /* data                */ a_data.c_str(),
+        /* data_length         */ a_data.length()
+    };
+    casper_proxy_worker_interceptor_output_t output = { 0, 0, nullptr, 0, nullptr, 0, nullptr };
+    // ... call it ...
+    const int rv = it->second.function_(it->second.context_, &input, &output);
+    // ... copy result ...
+    o_result.intercepted_ = ( 0 == rv && 0 != output.intercepted );
+    if ( true == o_result.intercepted_ ) {
+        o_result.code_ = output.code;
+        o_result.content_type_.assign(( nullptr != output.content_type ? output.content_type : "" ), ( nullptr != output.content_type ? output.content_type_length : 0 ));
+        o_result.body_.assign(( nullptr != output.body ? output.body : "" ), ( nullptr != output.body ? output.body_length : 0 ));
+    }
+    const std::string error = ( nullptr != output.error ? output.error : "" );
+    // ... release plugin owned data ...
+    if ( nullptr != it->second.release_ ) {
+        it->second.release_(it->second.context_, &output);
+    }
+    // ... failed?
+    if ( 0 != rv ) {
+        throw ::cc::InternalServerError("Native interceptor '%s' failed with code %d: %s", a_name.c_str(), rv, ( error.length() > 0 ? error.c_str() : "???" ));
+    }
+}
+
+/**
+ * @brief Called by plugins to register an interceptor.
+ *
+ * @param a_registry Plugins instance.
+ * @param a_name     Interceptor name.
+ * @param a_function Interceptor function.
+ * @param a_release  Interceptor output release function, optional.
+ * @param a_context  Plugin context, passed to function and release calls.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int casper::proxy::worker::native::Plugins::Register (void* a_registry, const char* a_name,
+                                                      casper_proxy_worker_interceptor_t a_function, casper_proxy_worker_interceptor_release_t a_release, void* a_context)
+{
+    casper::proxy::worker::native::Plugins* instance = static_cast<casper::proxy::worker::native::Plugins*>(a_registry);
+    // ... can't throw exceptions here ...
+    if ( nullptr == instance || nullptr == a_name || nullptr == a_function) {
+        return -1;
+    }
+    // ... names must be unique ...
+    if ( instance->interceptors_.end() != instance->interceptors_.find(a_name) ) {
+        return -1;
+    }
+    instance->interceptors_[a_name] = { a_function, a_release, a_context, instance->loading_ };
+    return 0;
+}
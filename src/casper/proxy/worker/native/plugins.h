@@ -0,0 +1,113 @@
+/**
+ * @file plugins.h
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#ifndef CASPER_PROXY_WORKER_NATIVE_PLUGINS_H_
+#define CASPER_PROXY_WORKER_NATIVE_PLUGINS_H_
+
+#include "casper/proxy/worker/native/interceptor.h"
+
+#include "cc/non-movable.h"
+
+#include <string>
+#include <map>
+
+namespace casper
+{
+
+    namespace proxy
+    {
+
+        namespace worker
+        {
+
+            namespace native
+            {
+
+                class Plugins final : public ::cc::NonMovable
+                {
+
+                public: // Data Type(s)
+
+                    typedef struct {
+                        bool        intercepted_;
+                        uint16_t    code_;
+                        std::string content_type_;
+                        std::string body_;
+                    } Result;
+
+                private: // Data Type(s)
+
+                    typedef struct {
+                        casper_proxy_worker_interceptor_t         function_;
+                        casper_proxy_worker_interceptor_release_t release_;
+                        void*                                     context_;
+                        std::string                               uri_;
+                    } Interceptor;
+
+                private: // Data
+
+                    std::map<std::string, void*>       handles_;      //!< dlopen handles, by plugin URI
+                    std::map<std::string, Interceptor> interceptors_; //!< by name
+                    std::string                        loading_;      //!< URI of the plugin being loaded
+
+                public: // Constructor(s) / Destructor
+
+                    Plugins ();
+                    Plugins (const Plugins&) = delete;
+                    virtual ~Plugins ();
+
+                public: // Overloaded Operator(s)
+
+                    void operator = (Plugins const&) = delete;  // assignment is not allowed
+
+                public: // Method(s) / Function(s)
+
+                    void Load      (const std::string& a_uri);
+                    void Intercept (const std::string& a_name,
+                                    const uint16_t a_code, const std::string& a_content_type, const std::string& a_body, const std::string& a_data,
+                                    Result& o_result) const;
+
+                public: // Inline Method(s) / Function(s)
+
+                    /**
+                     * @return True if an interceptor is registered with the provided name.
+                     */
+                    inline bool Has (const std::string& a_name) const
+                    {
+                        return interceptors_.end() != interceptors_.find(a_name);
+                    }
+
+                private: // Static Method(s) / Function(s)
+
+                    static int Register (void* a_registry, const char* a_name,
+                                         casper_proxy_worker_interceptor_t a_function, casper_proxy_worker_interceptor_release_t a_release, void* a_context);
+
+                }; // end of class 'Plugins'
+
+            } // end of namespace 'native'
+
+        } // end of namespace 'worker'
+
+    } // end of namespace 'proxy'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_PROXY_WORKER_NATIVE_PLUGINS_H_
@@ -0,0 +1,210 @@
+/**
+ * @file cache.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/proxy/worker/v8/cache.h"
+
+#include "cc/v8/exception.h"
+
+#include "cc/fs/dir.h"
+#include "cc/hash/sha256.h"
+
+#include <fstream>
+#include <sstream>
+
+#include <stdio.h>    // rename
+#include <stdlib.h>   // mkstemp
+#include <string.h>   // strerror
+#include <unistd.h>   // write, close, unlink
+#include <errno.h>    // errno
+#include <sys/stat.h> // fchmod, mkdir
+
+/**
+ * @brief Default constructor.
+ */
+casper::proxy::worker::v8::Cache::Cache ()
+{
+    /* empty */
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::proxy::worker::v8::Cache::~Cache ()
+{
+    /* empty */
+}
+
+/**
+ * @brief Obtain external scripts sources, reading them from disk only once per directory.
+ *
+ * @param a_directory External scripts directory.
+ * @param a_log       Function to call to log a message.
+ *
+ * @return R/O access to cached entry.
+ */
+const casper::proxy::worker::v8::Cache::Entry& casper::proxy::worker::v8::Cache::Sources (const std::string& a_directory,
+                                                                                         const std::function<void(const std::string&)>& a_log)
+{
+    const std::string directory = cc::fs::Dir::Normalize(a_directory);
+    // ... already loaded?
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = entries_.find(directory);
+    if ( entries_.end() != it ) {
+        // ... yes, done ...
+        return it->second;
+    }
+    // ... no, load it now ...
+    Entry entry;
+    std::stringstream ss;
+    cc::fs::Dir::ListFiles(directory, /* a_pattern */ "*.js", [&a_log, &ss, &entry] (const std::string& a_uri) -> bool {
+        // ... log ...
+        a_log("Loading '" + a_uri + "'...");
+        // ... load ...
+        ss << "\n\n//\n// " << a_uri << "\n//\n";
+        std::ifstream file(a_uri);
+        if ( file ) {
+            ss << file.rdbuf();
+            file.close();
+        } else {
+            throw ::cc::v8::Exception("Unable to load file %s: check permissions!", a_uri.c_str());
+        }
+        entry.files_.push_back(a_uri);
+        // ... next ...
+        return true;
+    });
+    entry.source_ = ss.str();
+    entry.hash_   = ::cc::hash::SHA256::Calculate(entry.source_);
+    // ... keep track of it ...
+    return ( entries_[directory] = entry );
+}
+
+/**
+ * @brief Compile and run external scripts in the current context of the provided isolate, using V8 code cache when available.
+ *
+ * @param a_isolate   Isolate where scripts should be loaded.
+ * @param a_directory External scripts directory.
+ * @param a_cache_dir Writable directory, created if needed, where code cache will be persisted - empty to keep it in memory only.
+ * @param a_log       Function to call to log a message.
+ *
+ * @return True if scripts were loaded, false if there's no current context - caller should load sources by other means.
+ */
+bool casper::proxy::worker::v8::Cache::Run (::v8::Isolate* a_isolate, const std::string& a_directory, const std::string& a_cache_dir,
+                                            const std::function<void(const std::string&)>& a_log)
+{
+    // ... no isolate, nothing to do here ...
+    if ( nullptr == a_isolate ) {
+        return false;
+    }
+    const ::v8::HandleScope handle_scope(a_isolate);
+    const ::v8::Local<::v8::Context> context = a_isolate->GetCurrentContext();
+    // ... no context, nothing to do here ...
+    if ( true == context.IsEmpty() ) {
+        return false;
+    }
+    const Entry& entry = Sources(a_directory, a_log);
+    const std::string uri = ( 0 != a_cache_dir.length() ? CodeCacheURI(a_cache_dir, entry) : "" );
+    // ... grab code cache ( from memory or from disk ) ...
+    std::vector<uint8_t> code;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        code = entry.code_;
+    }
+    if ( 0 == code.size() && 0 != uri.length() ) {
+        std::ifstream file(uri, std::ios::binary);
+        if ( file ) {
+            code.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            file.close();
+        }
+    }
+    // ... compile ...
+    const ::v8::TryCatch try_catch(a_isolate);
+    const ::v8::Local<::v8::String> source = ::v8::String::NewFromUtf8(a_isolate, entry.source_.c_str(), ::v8::NewStringType::kNormal, static_cast<int>(entry.source_.length())).ToLocalChecked();
+    ::v8::ScriptCompiler::Source compiler_source(source, ( code.size() > 0 ? new ::v8::ScriptCompiler::CachedData(code.data(), static_cast<int>(code.size())) : nullptr ));
+    ::v8::Local<::v8::Script> script;
+    if ( false == ::v8::ScriptCompiler::Compile(context, &compiler_source, ( code.size() > 0 ? ::v8::ScriptCompiler::kConsumeCodeCache : ::v8::ScriptCompiler::kNoCompileOptions )).ToLocal(&script) ) {
+        const ::v8::String::Utf8Value exception(a_isolate, try_catch.Exception());
+        throw ::cc::v8::Exception("Unable to compile scripts from %s: %s!", a_directory.c_str(), ( nullptr != *exception ? *exception : "???" ));
+    }
+    const bool produce = ( 0 == code.size() || ( nullptr != compiler_source.GetCachedData() && true == compiler_source.GetCachedData()->rejected ) );
+    // ... run it, functions will be available in this context ...
+    ::v8::Local<::v8::Value> result;
+    if ( false == script->Run(context).ToLocal(&result) ) {
+        const ::v8::String::Utf8Value exception(a_isolate, try_catch.Exception());
+        throw ::cc::v8::Exception("Unable to run scripts from %s: %s!", a_directory.c_str(), ( nullptr != *exception ? *exception : "???" ));
+    }
+    // ... log ...
+    a_log(std::string(true == produce ? "Compiled" : "Loaded code cache for") + " scripts from '" + a_directory + "' ( " + entry.hash_ + " )");
+    // ... produce code cache?
+    if ( true == produce ) {
+        ::v8::ScriptCompiler::CachedData* data = ::v8::ScriptCompiler::CreateCodeCache(script->GetUnboundScript());
+        if ( nullptr != data ) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                const_cast<Entry&>(entry).code_.assign(data->data, data->data + data->length);
+            }
+            // ... persist it, unless in memory only ...
+            if ( 0 != uri.length() ) {
+                // ... best effort: unique temporary file, so concurrent processes don't write to the same one, ...
+                // ... and rename is atomic, so a partially written file is never consumed ...
+                std::vector<char> tmp(uri.begin(), uri.end());
+                tmp.insert(tmp.end(), { '.', 'X', 'X', 'X', 'X', 'X', 'X', '\0' });
+                const int fd = ( ( 0 == mkdir(a_cache_dir.c_str(), 0755) || EEXIST == errno ) ? mkstemp(tmp.data()) : -1 );
+                if ( -1 != fd ) {
+                    const uint8_t* ptr     = data->data;
+                    size_t         missing = static_cast<size_t>(data->length);
+                    while ( missing > 0 ) {
+                        const ssize_t rv = write(fd, ptr, missing);
+                        if ( rv > 0 ) {
+                            ptr     += rv;
+                            missing -= static_cast<size_t>(rv);
+                        } else if ( EINTR != errno ) {
+                            break;
+                        }
+                    }
+                    // ... mkstemp creates it as 0600, other workers might be running as another user ...
+                    const bool written = ( 0 == missing && 0 == fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) );
+                    if ( 0 != close(fd) || false == written || 0 != rename(tmp.data(), uri.c_str()) ) {
+                        (void)unlink(tmp.data());
+                        a_log("Unable to persist code cache to '" + uri + "'!");
+                    }
+                } else {
+                    a_log("Unable to persist code cache to '" + uri + "': " + strerror(errno) + "!");
+                }
+            }
+            delete data;
+        }
+    }
+    // ... done ...
+    return true;
+}
+
+/**
+ * @brief Build code cache file URI.
+ *
+ * @param a_cache_dir Code cache directory.
+ * @param a_entry     Cached entry.
+ *
+ * @return Code cache file URI, keyed by scripts content and V8 version.
+ */
+std::string casper::proxy::worker::v8::Cache::CodeCacheURI (const std::string& a_cache_dir, const casper::proxy::worker::v8::Cache::Entry& a_entry) const
+{
+    return cc::fs::Dir::Normalize(a_cache_dir) + a_entry.hash_ + "-" + ::v8::V8::GetVersion() + ".v8cc";
+}
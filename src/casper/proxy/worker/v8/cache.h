@@ -0,0 +1,115 @@
+/**
+ * @file cache.h
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#ifndef CASPER_PROXY_WORKER_V8_CACHE_H_
+#define CASPER_PROXY_WORKER_V8_CACHE_H_
+
+#include "cc/non-movable.h"
+
+#include "v8.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <functional>
+
+namespace casper
+{
+
+    namespace proxy
+    {
+
+        namespace worker
+        {
+
+            namespace v8
+            {
+
+                //
+                // Process wide cache for external scripts:
+                //
+                // - sources are read from disk once per directory, no matter how many providers / isolates load them;
+                // - V8 code cache is produced on first compilation, keyed by sources content hash and V8 version, and
+                //   persisted so that later starts, additional providers and additional isolates skip parse & compile.
+                //
+                class Cache final : public ::cc::NonMovable
+                {
+
+                public: // Data Type(s)
+
+                    typedef struct {
+                        std::string                 hash_;   //!< SHA256 of all sources, in load order
+                        std::string                 source_; //!< concatenated sources
+                        std::vector<uint8_t>        code_;   //!< V8 code cache, empty if not produced yet
+                        std::vector<std::string>    files_;  //!< loaded files URIs
+                    } Entry;
+
+                private: // Data
+
+                    std::mutex                   mutex_;
+                    std::map<std::string, Entry> entries_; //!< by normalized directory
+
+                private: // Constructor(s) / Destructor
+
+                    Cache ();
+                    virtual ~Cache ();
+
+                public: // Constructor(s) / Destructor
+
+                    Cache (const Cache&) = delete;
+
+                public: // Overloaded Operator(s)
+
+                    void operator = (Cache const&) = delete;  // assignment is not allowed
+
+                public: // Method(s) / Function(s)
+
+                    const Entry& Sources (const std::string& a_directory, const std::function<void(const std::string&)>& a_log);
+                    bool         Run     (::v8::Isolate* a_isolate, const std::string& a_directory, const std::string& a_cache_dir,
+                                          const std::function<void(const std::string&)>& a_log);
+
+                private: // Method(s) / Function(s)
+
+                    std::string CodeCacheURI (const std::string& a_cache_dir, const Entry& a_entry) const;
+
+                public: // Static Method(s) / Function(s)
+
+                    /**
+                     * @return Process wide instance.
+                     */
+                    static Cache& GetInstance ()
+                    {
+                        static Cache instance;
+                        return instance;
+                    }
+
+                }; // end of class 'Cache'
+
+            } // end of namespace 'v8'
+
+        } // end of namespace 'worker'
+
+    } // end of namespace 'proxy'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_PROXY_WORKER_V8_CACHE_H_
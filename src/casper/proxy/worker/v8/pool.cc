@@ -0,0 +1,205 @@
+/**
+ * @file pool.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/proxy/worker/v8/pool.h"
+
+#include "cc/exception.h"
+
+#include <algorithm> // std::max
+
+// MARK: - Lease
+
+/**
+ * @brief Default constructor, blocks until an isolate is available, see \link Pool::Mode \link.
+ *
+ * @param a_pool Pool to lease an isolate from.
+ * @param a_id   Usually a beanstalkd job id, see \link Pool::Affinity \link.
+ * @param a_mode One of \link Pool::Mode \link.
+ */
+casper::proxy::worker::v8::Pool::Lease::Lease (casper::proxy::worker::v8::Pool& a_pool, const uint64_t& a_id, const casper::proxy::worker::v8::Pool::Mode a_mode)
+: lock_(),
+  index_(a_pool.Acquire(a_id, a_mode, lock_)),
+  script_(*a_pool.scripts_[index_])
+{
+    // ... isolate might be entered by more than one thread ( never at the same time ) ...
+    if ( nullptr != script_.isolate() ) {
+        locker_ = std::unique_ptr<::v8::Locker>(new ::v8::Locker(script_.isolate()));
+        // ... previous evaluation terminated for exceeding heap limit? restore it ...
+        script_.Rearm();
+    }
+}
+
+/**
+ * @brief Destructor, releases isolate.
+ */
+casper::proxy::worker::v8::Pool::Lease::~Lease ()
+{
+    // ... v8 lock must be released before mutex ...
+    locker_.reset();
+}
+
+// MARK: - Pool
+
+/**
+ * @brief Default constructor.
+ *
+ * @param a_loggable_data           TO BE COPIED
+ * @param a_owner                   Script owner.
+ * @param a_name                    Script name, isolates other than the first one will be suffixed with it's index.
+ * @param a_uri                     Unused.
+ * @param a_out_path                Writable directory.
+ * @param a_cache_dir               Writable directory where V8 code cache is persisted, empty to keep it in memory only.
+ * @param a_signature_output_format One of \link ::cc::crypto::RSA::SignOutputFormat \link.
+ * @param a_size                    Number of isolates, at least 1.
+ */
+casper::proxy::worker::v8::Pool::Pool (const ::ev::Loggable::Data& a_loggable_data,
+                                       const std::string& a_owner, const std::string& a_name, const std::string& a_uri,
+                                       const std::string& a_out_path, const std::string& a_cache_dir, const ::cc::crypto::RSA::SignOutputFormat a_signature_output_format,
+                                       const size_t a_size)
+{
+    const size_t size = std::max(static_cast<size_t>(1), a_size);
+    for ( size_t idx = 0 ; idx < size ; ++idx ) {
+        scripts_.push_back(new casper::proxy::worker::v8::Script(a_loggable_data, a_owner,
+                                                                 ( 0 == idx ? a_name : a_name + "-" + std::to_string(idx) ),
+                                                                 a_uri, a_out_path, a_cache_dir, a_signature_output_format)
+        );
+        mutexes_.push_back(new std::mutex());
+    }
+}
+
+/**
+ * @brief Copy constructor.
+ *
+ * @param a_pool Object to copy.
+ */
+casper::proxy::worker::v8::Pool::Pool (const casper::proxy::worker::v8::Pool& a_pool)
+{
+    for ( const auto script : a_pool.scripts_ ) {
+        scripts_.push_back(new casper::proxy::worker::v8::Script(*script));
+        mutexes_.push_back(new std::mutex());
+    }
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::proxy::worker::v8::Pool::~Pool ()
+{
+    for ( auto script : scripts_ ) {
+        delete script;
+    }
+    for ( auto mutex : mutexes_ ) {
+        delete mutex;
+    }
+}
+
+/**
+ * @brief Load the same scripts to all isolates.
+ *
+ * @param a_external_scripts External scripts to load, as JSON string.
+ * @param a_expressions      Expressions to load.
+ */
+void casper::proxy::worker::v8::Pool::Load (const Json::Value& a_external_scripts, const ::cc::v8::basic::Evaluator::Expressions& a_expressions)
+{
+    for ( auto script : scripts_ ) {
+        script->Load(a_external_scripts, a_expressions);
+    }
+}
+
+/**
+ * @brief Call a function for each isolate script ( ⚠️ NOT leased, for setup purposes only ).
+ *
+ * @param a_callback Function to call.
+ */
+void casper::proxy::worker::v8::Pool::ForEach (const std::function<void(casper::proxy::worker::v8::Script&)>& a_callback)
+{
+    for ( auto script : scripts_ ) {
+        a_callback(*script);
+    }
+}
+
+/**
+ * @brief Start collecting GC metrics for all isolates.
+ *
+ * @param a_heap_limit Per isolate heap limit, in bytes, 0 for V8's default.
+ */
+void casper::proxy::worker::v8::Pool::Watch (const size_t a_heap_limit)
+{
+    for ( size_t idx = 0 ; idx < scripts_.size() ; ++idx ) {
+        std::lock_guard<std::mutex> lock(*mutexes_[idx]);
+        if ( nullptr == scripts_[idx]->isolate() ) {
+            continue;
+        }
+        const ::v8::Locker locker(scripts_[idx]->isolate());
+        scripts_[idx]->Watch(a_heap_limit);
+    }
+}
+
+/**
+ * @brief Lock an isolate.
+ *
+ * @param a_id   Usually a beanstalkd job id, see \link Affinity \link.
+ * @param a_mode One of \link Mode \link.
+ * @param o_lock Set with the isolate lock.
+ *
+ * @return Locked isolate index.
+ */
+size_t casper::proxy::worker::v8::Pool::Acquire (const uint64_t& a_id, const casper::proxy::worker::v8::Pool::Mode a_mode, std::unique_lock<std::mutex>& o_lock)
+{
+    const size_t affinity = Affinity(a_id, a_mode);
+    // ... looper: don't wait for another job evaluation if there's a free isolate ...
+    if ( Mode::Looper == a_mode ) {
+        for ( size_t idx = 0 ; idx < scripts_.size() ; ++idx ) {
+            const size_t index = ( affinity + idx ) % scripts_.size();
+            std::unique_lock<std::mutex> lock(*mutexes_[index], std::try_to_lock);
+            if ( true == lock.owns_lock() ) {
+                o_lock = std::move(lock);
+                return index;
+            }
+        }
+        // ... all leased, first one is only leased by looper jobs, GC or setup, so it won't be for long ...
+        o_lock = std::unique_lock<std::mutex>(*mutexes_[0]);
+        return 0;
+    }
+    o_lock = std::unique_lock<std::mutex>(*mutexes_[affinity]);
+    return affinity;
+}
+
+/**
+ * @brief Notify all isolates that are not leased that they can perform GC work now.
+ *
+ * @param a_callback Function to call with each notified isolate index and metrics.
+ */
+void casper::proxy::worker::v8::Pool::Idle (const std::function<void(const size_t, const casper::proxy::worker::v8::Script::Stats&)>& a_callback)
+{
+    for ( size_t idx = 0 ; idx < scripts_.size() ; ++idx ) {
+        // ... leased? skip it, we're not idle after all ...
+        std::unique_lock<std::mutex> lock(*mutexes_[idx], std::try_to_lock);
+        if ( false == lock.owns_lock() || nullptr == scripts_[idx]->isolate() ) {
+            continue;
+        }
+        {
+            const ::v8::Locker locker(scripts_[idx]->isolate());
+            scripts_[idx]->Idle();
+        }
+        a_callback(idx, scripts_[idx]->stats());
+    }
+}
@@ -0,0 +1,164 @@
+/**
+ * @file pool.h
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#ifndef CASPER_PROXY_WORKER_V8_POOL_H_
+#define CASPER_PROXY_WORKER_V8_POOL_H_
+
+#include "casper/proxy/worker/v8/script.h"
+
+#include "cc/non-movable.h"
+
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <functional>
+
+namespace casper
+{
+
+    namespace proxy
+    {
+
+        namespace worker
+        {
+
+            namespace v8
+            {
+
+                //
+                // Per provider pool of isolates, loaded from the same scripts:
+                //
+                // - the looper thread leases any free isolate ( affinity one first ), so its intake is not blocked by other jobs evaluations;
+                // - executor threads lease by affinity, and never the first isolate when there's more than one, so the looper always finds it free;
+                // - with a single isolate looper and executor threads share it.
+                //
+                class Pool final : public ::cc::NonMovable
+                {
+
+                public: // Data Type(s)
+
+                    enum class Mode : uint8_t {
+                        Looper = 0, //!< any free isolate, affinity one first, blocks only if all of them are leased
+                        Executor    //!< affinity isolate, see \link Pool::Affinity \link, blocks until it's available
+                    };
+
+                    class Lease final : public ::cc::NonMovable
+                    {
+
+                    private: // Data
+
+                        std::unique_lock<std::mutex>  lock_;   //!< exclusive access to isolate
+
+                    private: // Const Data
+
+                        const size_t                  index_;  //!< isolate index
+
+                    private: // Data
+
+                        Script&                       script_; //!< leased script
+                        std::unique_ptr<::v8::Locker> locker_; //!< v8 isolate lock, only if isolate is known
+
+                    public: // Constructor(s) / Destructor
+
+                        Lease () = delete;
+                        Lease (Pool& a_pool, const uint64_t& a_id, const Mode a_mode);
+                        Lease (const Lease&) = delete;
+                        virtual ~Lease ();
+
+                    public: // Overloaded Operator(s)
+
+                        void operator = (Lease const&) = delete;  // assignment is not allowed
+
+                    public: // Inline Method(s) / Function(s)
+
+                        inline Script&      script () const { return script_; }
+                        inline const size_t index  () const { return index_;  }
+
+                    }; // end of class 'Lease'
+
+                private: // Data
+
+                    std::vector<Script*>     scripts_; //!< one script per isolate
+                    std::vector<std::mutex*> mutexes_; //!< one mutex per isolate
+
+                public: // Constructor(s) / Destructor
+
+                    Pool () = delete;
+                    Pool (const ::ev::Loggable::Data& a_loggable_data,
+                          const std::string& a_owner, const std::string& a_name, const std::string& a_uri,
+                          const std::string& a_out_path, const std::string& a_cache_dir, const ::cc::crypto::RSA::SignOutputFormat a_signature_output_format,
+                          const size_t a_size);
+                    Pool (const Pool& a_pool);
+                    virtual ~Pool ();
+
+                public: // Overloaded Operator(s)
+
+                    void operator = (Pool const&) = delete;  // assignment is not allowed
+
+                public: // Method(s) / Function(s)
+
+                    void Load    (const Json::Value& a_external_scripts, const ::cc::v8::basic::Evaluator::Expressions& a_expressions);
+                    void ForEach (const std::function<void(Script&)>& a_callback);
+                    void Watch   (const size_t a_heap_limit);
+                    void Idle    (const std::function<void(const size_t, const Script::Stats&)>& a_callback);
+
+                private: // Method(s) / Function(s)
+
+                    size_t Acquire (const uint64_t& a_id, const Mode a_mode, std::unique_lock<std::mutex>& o_lock);
+
+                public: // Inline Method(s) / Function(s)
+
+                    /**
+                     * @return Number of isolates in this pool.
+                     */
+                    inline size_t size () const
+                    {
+                        return scripts_.size();
+                    }
+
+                    /**
+                     * @brief Isolate affinity, same ID will always be evaluated by the same isolate ( unless it's leased by another looper job ).
+                     *
+                     * @param a_id   Usually a beanstalkd job id.
+                     * @param a_mode One of \link Mode \link.
+                     *
+                     * @return Isolate index.
+                     */
+                    inline size_t Affinity (const uint64_t& a_id, const Mode a_mode) const
+                    {
+                        // ... first isolate is kept for the looper thread, if there's more than one ...
+                        if ( Mode::Executor == a_mode && scripts_.size() > 1 ) {
+                            return 1 + static_cast<size_t>(a_id % ( scripts_.size() - 1 ));
+                        }
+                        return static_cast<size_t>(a_id % scripts_.size());
+                    }
+
+                }; // end of class 'Pool'
+
+            } // end of namespace 'v8'
+
+        } // end of namespace 'worker'
+
+    } // end of namespace 'proxy'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_PROXY_WORKER_V8_POOL_H_
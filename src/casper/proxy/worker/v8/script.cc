@@ -21,6 +21,8 @@
 
 #include "casper/proxy/worker/v8/script.h"
 
+#include "casper/proxy/worker/v8/cache.h"
+
 #include "cc/v8/exception.h"
 
 #include "cc/types.h"
@@ -35,11 +37,12 @@
  * @param a_name                    Script name
  * @param a_uri                     Unused.
  * @param a_out_path                Writable directory.
+ * @param a_cache_dir               Writable directory where V8 code cache is persisted, empty to keep it in memory only.
  * @param a_signature_output_format One of \link ::cc::crypto::RSA::SignOutputFormat \link.
  */
 casper::proxy::worker::v8::Script::Script (const ::ev::Loggable::Data& a_loggable_data,
                                            const std::string& a_owner, const std::string& a_name, const std::string& a_uri,
-                                           const std::string& a_out_path,
+                                           const std::string& a_out_path, const std::string& a_cache_dir,
                                            const ::cc::crypto::RSA::SignOutputFormat a_signature_output_format)
 : ::cc::v8::basic::Evaluator(a_loggable_data,
                              a_owner, a_name, a_uri, a_out_path,
@@ -49,9 +52,14 @@ casper::proxy::worker::v8::Script::Script (const ::ev::Loggable::Data& a_loggabl
                                  { "NowUTCISO8601", casper::proxy::worker::v8::Script::NowUTCISO8601 },
                                  { "RSASignSHA256", casper::proxy::worker::v8::Script::RSASignSHA256 }
                              }),
-    signature_output_format_(a_signature_output_format)
+    signature_output_format_(a_signature_output_format), code_cache_dir_(a_cache_dir)
 {
     last_exception_ = nullptr;
+    isolate_ptr_    = nullptr;
+    watching_       = false;
+    heap_limit_     = 0;
+    raised_         = false;
+    stats_          = { 0, 0, 0, 0, 0, 0, 0, 0 };
 }
 
 /**
@@ -61,9 +69,14 @@ casper::proxy::worker::v8::Script::Script (const ::ev::Loggable::Data& a_loggabl
  */
 casper::proxy::worker::v8::Script::Script (const casper::proxy::worker::v8::Script& a_script)
 : ::cc::v8::basic::Evaluator(a_script),
-    signature_output_format_(a_script.signature_output_format_)
+    signature_output_format_(a_script.signature_output_format_), code_cache_dir_(a_script.code_cache_dir_)
 {
     last_exception_ = ( nullptr != a_script.last_exception_ ? new ::cc::v8::Exception(*last_exception_) : nullptr );
+    isolate_ptr_    = nullptr;
+    watching_       = false;
+    heap_limit_     = 0;
+    raised_         = false;
+    stats_          = { 0, 0, 0, 0, 0, 0, 0, 0 };
 }
 
 /**
@@ -71,6 +84,13 @@ casper::proxy::worker::v8::Script::Script (const casper::proxy::worker::v8::Scri
  */
 casper::proxy::worker::v8::Script::~Script ()
 {
+    // ... isolate might outlive us ...
+    if ( true == watching_ ) {
+        const ::v8::Locker locker(isolate_ptr_);
+        isolate_ptr_->RemoveGCPrologueCallback(casper::proxy::worker::v8::Script::OnGCPrologue, this);
+        isolate_ptr_->RemoveGCEpilogueCallback(casper::proxy::worker::v8::Script::OnGCEpilogue, this);
+        isolate_ptr_->RemoveNearHeapLimitCallback(casper::proxy::worker::v8::Script::OnNearHeapLimit, /* a_heap_limit */ 0);
+    }
     if ( nullptr != last_exception_ ){
         delete last_exception_;
     }
@@ -87,24 +107,185 @@ casper::proxy::worker::v8::Script::~Script ()
  */
 void casper::proxy::worker::v8::Script::InnerLoad (const Json::Value& a_external_scripts, const casper::proxy::worker::v8::Script::Expressions& /* a_expressions */, std::stringstream& a_ss)
 {
+    // ... keep track of the isolate we're being loaded to ( required for multi-thread access, see \link v8::Pool \link ) ...
+    isolate_ptr_ = ::v8::Isolate::GetCurrent();
     // ... load external scripts ( 😨 ) ...
     if ( false == a_external_scripts.isNull() ) {
-        cc::fs::Dir::ListFiles(cc::fs::Dir::Normalize(a_external_scripts.asString()), /* a_pattern */ "*.js", [this, &a_ss] (const std::string& a_uri) -> bool {
-            // ... log ...
-            ::ev::LoggerV2::GetInstance().Log(logger_client(), logger_token(), "Loading '%s'...", a_uri.c_str());
-            // ... load ...
-            a_ss << "\n\n//\n// " << a_uri << "\n//\n";
-            std::ifstream file(a_uri);
-            if ( file ) {
-                a_ss << file.rdbuf();
-                file.close();
-            } else {
-                throw ::cc::v8::Exception("Unable to load file %s: check permissions!", a_uri.c_str());
-            }
-            // ... next ...
-            return true;
-        });
+        const std::string directory = a_external_scripts.asString();
+        const auto        log       = [this] (const std::string& a_message) {
+            ::ev::LoggerV2::GetInstance().Log(logger_client(), logger_token(), "%s", a_message.c_str());
+        };
+        // ... sources are read once per process, compiled code is shared by all isolates and restarts ...
+        if ( false == casper::proxy::worker::v8::Cache::GetInstance().Run(isolate_ptr_, directory, code_cache_dir_, log) ) {
+            // ... no context available yet, let evaluator compile sources ...
+            a_ss << casper::proxy::worker::v8::Cache::GetInstance().Sources(directory, log).source_;
+        }
+    }
+}
+
+// MARK: -
+
+/**
+ * @brief Start collecting GC metrics and, optionally, enforce a heap limit.
+ *
+ * @param a_heap_limit Heap limit, in bytes, 0 to keep V8's default.
+ */
+void casper::proxy::worker::v8::Script::Watch (const size_t a_heap_limit)
+{
+    // ... not loaded or already watching?
+    if ( nullptr == isolate_ptr_ || true == watching_ ) {
+        return;
+    }
+    heap_limit_ = a_heap_limit;
+    watching_   = true;
+    isolate_ptr_->AddGCPrologueCallback(casper::proxy::worker::v8::Script::OnGCPrologue, this);
+    isolate_ptr_->AddGCEpilogueCallback(casper::proxy::worker::v8::Script::OnGCEpilogue, this);
+    isolate_ptr_->AddNearHeapLimitCallback(casper::proxy::worker::v8::Script::OnNearHeapLimit, this);
+    // ... isolate is already created, so limit is set by restoring it ( V8 never sets it above it's initial limit ) ...
+    if ( heap_limit_ > 0 ) {
+        raised_ = true;
+        Rearm();
+    }
+}
+
+/**
+ * @brief Notify isolate that we're idle, so GC work can be done now and not in the middle of an evaluation.
+ */
+void casper::proxy::worker::v8::Script::Idle ()
+{
+    // ... not loaded?
+    if ( nullptr == isolate_ptr_ ) {
+        return;
+    }
+    const ::v8::Isolate::Scope isolate_scope(isolate_ptr_);
+    Rearm();
+    // ... update heap metrics ...
+    ::v8::HeapStatistics heap;
+    isolate_ptr_->GetHeapStatistics(&heap);
+    stats_.used_heap_size_  = heap.used_heap_size();
+    stats_.total_heap_size_ = heap.total_heap_size();
+    // ... close to limit?
+    if ( heap_limit_ > 0 && stats_.used_heap_size_ > ( heap_limit_ / 4 ) * 3 ) {
+        // ... yes, full ( blocking ) GC now ...
+        isolate_ptr_->LowMemoryNotification();
+        stats_.low_memory_++;
+    } else {
+        // ... no, start incremental marking ...
+        isolate_ptr_->MemoryPressureNotification(::v8::MemoryPressureLevel::kModerate);
+    }
+}
+
+/**
+ * @brief Restore heap limit, if it was raised so that an evaluation terminated for exceeding it could unwind.
+ */
+void casper::proxy::worker::v8::Script::Rearm ()
+{
+    if ( false == raised_ || nullptr == isolate_ptr_ ) {
+        return;
+    }
+    // ... V8 restores heap limit when a callback is removed, but never below live objects size ...
+    isolate_ptr_->RemoveNearHeapLimitCallback(casper::proxy::worker::v8::Script::OnNearHeapLimit, heap_limit_);
+    isolate_ptr_->AddNearHeapLimitCallback(casper::proxy::worker::v8::Script::OnNearHeapLimit, this);
+    if ( true == isolate_ptr_->IsExecutionTerminating() ) {
+        isolate_ptr_->CancelTerminateExecution();
+    }
+    raised_ = false;
+}
+
+/**
+ * @brief Evaluate a V8 expression that must return an object.
+ *
+ * @param a_id         ID, name of the data object.
+ * @param a_expression Expression to evaluate.
+ * @param a_data       Data to load ( to be used during expression evaluation ), already serialized as a JSON object string.
+ * @param o_value      Evaluation result.
+ */
+void casper::proxy::worker::v8::Script::Evaluate (const std::string& a_id, const std::string& a_expression, const std::string& a_data, Json::Value& o_value)
+{
+    o_value.clear();
+    
+    ::v8::Persistent<::v8::Value> v8_value; ::cc::v8::Value cc_value;
+    SetData(/* a_name  */ a_id.c_str(),
+            /* a_data   */ a_data.c_str(),
+            /* o_object */ nullptr,
+            /* o_value  */ &v8_value,
+            /* a_key    */ nullptr
+    );
+    Evaluate(v8_value, a_expression, cc_value);
+    v8_value.Reset();
+    if ( true == IsExceptionSet() ) {
+        throw ::cc::BadRequest("%s", exception().what());
+    }
+    switch(cc_value.type()) {
+        case ::cc::v8::Value::Type::Object:
+            o_value = cc_value;
+            break;
+        default:
+            throw ::cc::BadRequest("Unexpected // unsupported v8 evaluation ( of %s ), result type %u ", a_expression.c_str(), cc_value.type());
+    }
+}
+
+// MARK: -
+
+/**
+ * @brief Called by V8 when a GC cycle is about to start.
+ *
+ * @param a_isolate Isolate.
+ * @param a_type    GC type.
+ * @param a_flags   GC flags.
+ * @param a_data    Script instance.
+ */
+void casper::proxy::worker::v8::Script::OnGCPrologue (::v8::Isolate* /* a_isolate */, ::v8::GCType /* a_type */, ::v8::GCCallbackFlags /* a_flags */, void* a_data)
+{
+    static_cast<casper::proxy::worker::v8::Script*>(a_data)->gc_start_ = std::chrono::steady_clock::now();
+}
+
+/**
+ * @brief Called by V8 when a GC cycle is finished.
+ *
+ * @param a_isolate Isolate.
+ * @param a_type    GC type.
+ * @param a_flags   GC flags.
+ * @param a_data    Script instance.
+ */
+void casper::proxy::worker::v8::Script::OnGCEpilogue (::v8::Isolate* /* a_isolate */, ::v8::GCType /* a_type */, ::v8::GCCallbackFlags /* a_flags */, void* a_data)
+{
+    casper::proxy::worker::v8::Script* instance = static_cast<casper::proxy::worker::v8::Script*>(a_data);
+    const uint64_t pause = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - instance->gc_start_).count());
+    instance->stats_.gc_count_++;
+    instance->stats_.gc_pause_total_us_ += pause;
+    if ( pause > instance->stats_.gc_pause_max_us_ ) {
+        instance->stats_.gc_pause_max_us_ = pause;
+    }
+}
+
+/**
+ * @brief Called by V8 when heap is near it's limit.
+ *
+ * @param a_data               Script instance.
+ * @param a_current_heap_limit Current heap limit, in bytes.
+ * @param a_initial_heap_limit Initial heap limit, in bytes.
+ *
+ * @return New heap limit, in bytes.
+ */
+size_t casper::proxy::worker::v8::Script::OnNearHeapLimit (void* a_data, size_t a_current_heap_limit, size_t a_initial_heap_limit)
+{
+    casper::proxy::worker::v8::Script* instance = static_cast<casper::proxy::worker::v8::Script*>(a_data);
+    instance->stats_.near_heap_limit_++;
+    ::ev::LoggerV2::GetInstance().Log(instance->logger_client(), instance->logger_token(), "Near heap limit: current " SIZET_FMT " byte(s), initial " SIZET_FMT " byte(s), configured " SIZET_FMT " byte(s)",
+                                      a_current_heap_limit, a_initial_heap_limit, instance->heap_limit_
+    );
+    // ... no limit configured? keep V8's behaviour ...
+    if ( 0 == instance->heap_limit_ ) {
+        return a_current_heap_limit;
+    }
+    // ... limit reached, terminate evaluation, just enough room for it to unwind, limit is restored by \link Rearm \link ...
+    if ( false == instance->raised_ ) {
+        instance->isolate_ptr_->TerminateExecution();
+        instance->stats_.terminations_++;
+        instance->raised_ = true;
     }
+    return a_current_heap_limit + sk_unwind_headroom_;
 }
 
 // MARK: -
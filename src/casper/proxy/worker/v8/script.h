@@ -28,6 +28,8 @@
 
 #include "cc/crypto/rsa.h"
 
+#include <chrono>
+
 namespace casper
 {
     
@@ -43,13 +45,37 @@ namespace casper
                 class Script final : public ::cc::v8::basic::Evaluator
                 {
                     
+                public: // Data Type(s)
+                    
+                    typedef struct {
+                        uint64_t gc_count_;           //!< number of GC cycles
+                        uint64_t gc_pause_total_us_;  //!< sum of all GC pauses, in microseconds
+                        uint64_t gc_pause_max_us_;    //!< longest GC pause, in microseconds
+                        uint64_t near_heap_limit_;    //!< number of times V8 reported it's near it's heap limit
+                        uint64_t terminations_;       //!< number of evaluations terminated because heap limit was reached
+                        uint64_t low_memory_;         //!< number of low memory notifications sent because heap usage is close to it's limit
+                        size_t   used_heap_size_;     //!< last known used heap size, in bytes
+                        size_t   total_heap_size_;    //!< last known total heap size, in bytes
+                    } Stats;
+                    
+                public: // Static Const Data
+                    
+                    constexpr static const size_t sk_unwind_headroom_ = 16 * 1024 * 1024; //!< heap limit increase, in bytes, so that a terminated evaluation can unwind
+                    
                 private: // Data
                     
                     ::cc::crypto::RSA::SignOutputFormat signature_output_format_;
+                    const std::string                   code_cache_dir_; //!< writable directory where V8 code cache is persisted, empty if kept in memory only
 
                 private: // Data
 
                     ::cc::v8::Exception* last_exception_;
+                    ::v8::Isolate*       isolate_ptr_;     //!< isolate where scripts were loaded, nullptr if unknown
+                    bool                 watching_;        //!< true if V8 callbacks are installed
+                    size_t               heap_limit_;      //!< heap limit, in bytes, 0 if none ( V8 default )
+                    bool                 raised_;          //!< true while heap limit is raised so that a terminated evaluation can unwind
+                    Stats                stats_;           //!< heap and GC metrics
+                    std::chrono::steady_clock::time_point gc_start_; //!< current GC cycle start
                     
                 public: // Constructor(s) / Destructor
                     
@@ -58,10 +84,21 @@ namespace casper
                             const std::string& a_out_path) = delete;
                     Script (const ::ev::Loggable::Data& a_loggable_data,
                             const std::string& a_owner, const std::string& a_name, const std::string& a_uri,
-                            const std::string& a_out_path, const ::cc::crypto::RSA::SignOutputFormat a_signature_output_format);
+                            const std::string& a_out_path, const std::string& a_cache_dir, const ::cc::crypto::RSA::SignOutputFormat a_signature_output_format);
                     Script (const Script& a_script);
                     virtual ~Script ();
                     
+                public: // Method(s) / Function(s) - ⚠️ isolate must be locked by caller, see \link v8::Pool \link ⚠️
+                    
+                    void Watch    (const size_t a_heap_limit);
+                    void Idle     ();
+                    void Rearm    ();
+                    void Evaluate (const std::string& a_id, const std::string& a_expression, const std::string& a_data, Json::Value& o_value);
+                    
+                public: // Inherited Method(s) / Function(s) - from ::cc::v8::basic::Evaluator
+                    
+                    using ::cc::v8::basic::Evaluator::Evaluate;
+                    
                 protected: // Inherited Method(s) / Function(s) - from ::cc::v8::basic::Evaluator
                     
                     virtual void InnerLoad (const Json::Value& a_external_scripts, const Expressions& a_expressions, std::stringstream& a_ss);
@@ -70,6 +107,9 @@ namespace casper
                     
                     static void NowUTCISO8601 (const ::v8::FunctionCallbackInfo<::v8::Value>& a_args);
                     static void RSASignSHA256 (const ::v8::FunctionCallbackInfo<::v8::Value>& a_args);
+                    static void   OnGCPrologue    (::v8::Isolate* a_isolate, ::v8::GCType a_type, ::v8::GCCallbackFlags a_flags, void* a_data);
+                    static void   OnGCEpilogue    (::v8::Isolate* a_isolate, ::v8::GCType a_type, ::v8::GCCallbackFlags a_flags, void* a_data);
+                    static size_t OnNearHeapLimit (void* a_data, size_t a_current_heap_limit, size_t a_initial_heap_limit);
                     static void TryCall       (const std::function<void(const ::v8::HandleScope&, const ::v8::FunctionCallbackInfo<::v8::Value>&, const casper::proxy::worker::v8::Script*)> a_function,
                                                const size_t, const ::v8::FunctionCallbackInfo<::v8::Value>&);
                     
@@ -78,6 +118,8 @@ namespace casper
                     inline const bool                  IsExceptionSet () const {                                        return nullptr != last_exception_;  }
                     inline const ::cc::v8::Exception&  exception      () const { CC_ASSERT(nullptr != last_exception_); return *last_exception_;            }
                     inline void                        Reset          ()       { if ( nullptr != last_exception_ ) { delete last_exception_; last_exception_ = nullptr; }}
+                    inline ::v8::Isolate*              isolate        () const { return isolate_ptr_; }
+                    inline const Stats&                stats          () const { return stats_;       }
           
                 }; // end of class 'Script'
                 
@@ -0,0 +1,129 @@
+/**
+ * @file base64.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// codec::Base64 round-trip, against a scalar reference encoder, for every length up to a few SIMD blocks:
+//
+// g++ -std=c++11 -O2 -I src -I $CC_SRC test/base64.cc src/casper/proxy/worker/codec/base64.cc -o /tmp/base64 && /tmp/base64
+//
+
+#include "casper/proxy/worker/codec/base64.h"
+
+#include "cc/exception.h"
+
+#include "check.h"
+
+#include <algorithm> // std::min
+#include <random>
+#include <string>
+
+/**
+ * @brief Scalar, RFC 4648, reference encoder.
+ */
+static std::string Reference (const std::string& a_data)
+{
+    static const char* const sk_alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(a_data.data());
+    std::string          out;
+    size_t               idx  = 0;
+    for ( ; idx + 3 <= a_data.length() ; idx += 3 ) {
+        const uint32_t v = ( static_cast<uint32_t>(data[idx]) << 16 ) | ( static_cast<uint32_t>(data[idx + 1]) << 8 ) | data[idx + 2];
+        out += sk_alphabet[v >> 18]; out += sk_alphabet[( v >> 12 ) & 63]; out += sk_alphabet[( v >> 6 ) & 63]; out += sk_alphabet[v & 63];
+    }
+    if ( 1 == a_data.length() - idx ) {
+        const uint32_t v = static_cast<uint32_t>(data[idx]) << 16;
+        out += sk_alphabet[v >> 18]; out += sk_alphabet[( v >> 12 ) & 63]; out += "==";
+    } else if ( 2 == a_data.length() - idx ) {
+        const uint32_t v = ( static_cast<uint32_t>(data[idx]) << 16 ) | ( static_cast<uint32_t>(data[idx + 1]) << 8 );
+        out += sk_alphabet[v >> 18]; out += sk_alphabet[( v >> 12 ) & 63]; out += sk_alphabet[( v >> 6 ) & 63]; out += '=';
+    }
+    return out;
+}
+
+int main ()
+{
+    using Base64 = casper::proxy::worker::codec::Base64;
+
+    fprintf(stdout, "engine: %s\n", Base64::Engine());
+
+    std::mt19937 random(1);
+    for ( size_t length = 0 ; length < 600 ; ++length ) {
+        std::string data(length, '\0');
+        for ( auto& c : data ) {
+            c = static_cast<char>(random());
+        }
+        // ... one shot ...
+        const std::string encoded = Base64::Encode(reinterpret_cast<const unsigned char*>(data.data()), data.length());
+        CHECK(Reference(data) == encoded);
+        CHECK(Base64::EncodedLength(length) == encoded.length());
+        std::string decoded;
+        Base64::Decode(encoded.data(), encoded.length(), decoded);
+        CHECK(data == decoded);
+        // ... padding is optional when decoding ...
+        std::string unpadded = encoded;
+        while ( 0 != unpadded.length() && '=' == unpadded.back() ) {
+            unpadded.pop_back();
+        }
+        Base64::Decode(unpadded.data(), unpadded.length(), decoded);
+        CHECK(data == decoded);
+        // ... streaming, random chunk sizes ...
+        std::string streamed;
+        {
+            Base64::Encoder encoder;
+            size_t          offset = 0;
+            while ( offset < length ) {
+                const size_t count = std::min(static_cast<size_t>(random() % 50), length - offset);
+                encoder.Update(reinterpret_cast<const unsigned char*>(data.data()) + offset, count, [&streamed] (const char* const a_data, const size_t a_length) {
+                    streamed.append(a_data, a_length);
+                });
+                offset += count;
+            }
+            encoder.Final([&streamed] (const char* const a_data, const size_t a_length) {
+                streamed.append(a_data, a_length);
+            });
+        }
+        CHECK(encoded == streamed);
+        streamed.clear();
+        {
+            Base64::Decoder decoder;
+            size_t          offset = 0;
+            while ( offset < encoded.length() ) {
+                const size_t count = std::min(static_cast<size_t>(random() % 70), encoded.length() - offset);
+                decoder.Update(encoded.data() + offset, count, [&streamed] (const char* const a_data, const size_t a_length) {
+                    streamed.append(a_data, a_length);
+                });
+                offset += count;
+            }
+            decoder.Final([&streamed] (const char* const a_data, const size_t a_length) {
+                streamed.append(a_data, a_length);
+            });
+        }
+        CHECK(data == streamed);
+        // ... invalid characters are rejected, wherever they are ...
+        if ( encoded.length() > 8 ) {
+            std::string invalid = encoded;
+            invalid[random() % ( encoded.length() - 4 )] = '*';
+            CHECK_THROWS(::cc::Exception, Base64::Decode(invalid.data(), invalid.length(), decoded));
+        }
+    }
+
+    return TEST_DONE();
+}
@@ -0,0 +1,90 @@
+/**
+ * @file check.h
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#ifndef CASPER_PROXY_WORKER_TEST_CHECK_H_
+#define CASPER_PROXY_WORKER_TEST_CHECK_H_
+
+//
+// Minimal assertions for standalone test programs, each one is a single translation unit ( plus the sources under test ):
+//
+// - there's no test framework, programs exit with 0 when all checks pass, 1 otherwise;
+// - compile commands are documented in each program header, 'CC_SRC' is casper-connectors 'src' directory.
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <ftw.h>    // nftw
+#include <stdlib.h> // mkdtemp
+#include <unistd.h> // rmdir, unlink
+
+static int casper_proxy_worker_test_failures_ = 0;
+
+#define CHECK(a_condition) \
+    do { \
+        if ( not ( a_condition ) ) { \
+            fprintf(stderr, "%s:%d: CHECK( %s ) failed\n", __FILE__, __LINE__, #a_condition); \
+            casper_proxy_worker_test_failures_++; \
+        } \
+    } while(0)
+
+#define CHECK_THROWS(a_type, a_statement) \
+    do { \
+        bool thrown = false; \
+        try { \
+            a_statement; \
+        } catch (const a_type&) { \
+            thrown = true; \
+        } \
+        if ( false == thrown ) { \
+            fprintf(stderr, "%s:%d: %s did not throw %s\n", __FILE__, __LINE__, #a_statement, #a_type); \
+            casper_proxy_worker_test_failures_++; \
+        } \
+    } while(0)
+
+#define TEST_DONE() \
+    ( 0 == casper_proxy_worker_test_failures_ ? ( fprintf(stdout, "%s: OK\n", __FILE__), 0 ) : ( fprintf(stderr, "%s: %d failure(s)\n", __FILE__, casper_proxy_worker_test_failures_), 1 ) )
+
+/**
+ * @return A new, empty, scratch directory URI, with a trailing '/'.
+ */
+static inline std::string TestScratch ()
+{
+    char tmpl[] = "/tmp/casper-proxy-worker-test.XXXXXX";
+    if ( nullptr == mkdtemp(tmpl) ) {
+        fprintf(stderr, "unable to create a scratch directory\n");
+        exit(1);
+    }
+    return std::string(tmpl) + '/';
+}
+
+/**
+ * @brief Remove a scratch directory, and everything in it.
+ */
+static inline void TestScratchRemove (const std::string& a_dir)
+{
+    (void)nftw(a_dir.c_str(), [] (const char* a_path, const struct stat*, int a_flag, struct FTW*) -> int {
+        return ( FTW_DP == a_flag ? rmdir(a_path) : unlink(a_path) );
+    }, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+#endif // CASPER_PROXY_WORKER_TEST_CHECK_H_
@@ -0,0 +1,136 @@
+/**
+ * @file compressor.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// codec::Compressor: zlib / gzip streams decode, with zlib itself, back to the input, for a few levels, in bounded chunks, plus compression policy:
+//
+// g++ -std=c++11 -O2 -I src -I $CC_SRC test/compressor.cc src/casper/proxy/worker/codec/compressor.cc -lz -o /tmp/compressor && /tmp/compressor
+//
+// zstd frames are covered by test/decompressor.cc.
+//
+
+#include "casper/proxy/worker/codec/compressor.h"
+
+#include "cc/exception.h"
+
+#include "check.h"
+
+#include <zlib.h>
+
+#include <random>
+#include <string>
+
+/**
+ * @brief Inflate a zlib or gzip stream.
+ *
+ * @param a_data Compressed data.
+ * @param o_data Decompressed data.
+ *
+ * @return True if a complete stream was decoded.
+ */
+static bool Inflate (const std::string& a_data, std::string& o_data)
+{
+    z_stream stream = {};
+    // ... 15 + 32: zlib or gzip header, auto detected ...
+    if ( Z_OK != inflateInit2(&stream, 15 + 32) ) {
+        return false;
+    }
+    stream.next_in  = reinterpret_cast<Bytef*>(const_cast<char*>(a_data.data()));
+    stream.avail_in = static_cast<uInt>(a_data.length());
+    o_data.clear();
+    int rv = Z_OK;
+    while ( Z_OK == rv ) {
+        unsigned char chunk[16384];
+        stream.next_out  = chunk;
+        stream.avail_out = sizeof(chunk);
+        rv = inflate(&stream, Z_NO_FLUSH);
+        o_data.append(reinterpret_cast<const char*>(chunk), sizeof(chunk) - stream.avail_out);
+    }
+    inflateEnd(&stream);
+    return ( Z_STREAM_END == rv );
+}
+
+int main ()
+{
+    using Compressor = casper::proxy::worker::codec::Compressor;
+
+    // ... compressible, larger than a few output chunks ...
+    std::string  data;
+    std::mt19937 random(1);
+    while ( data.length() < 3 * 1024 * 1024 ) {
+        data += "line " + std::to_string(random() % 1000) + "\n";
+    }
+
+    for ( const auto codec : { Compressor::Codec::Deflate, Compressor::Codec::GZip } ) {
+        for ( const int level : { -1, 1, 9 } ) {
+            std::string compressed;
+            size_t      calls = 0;
+            Compressor(codec, level).Do(reinterpret_cast<const unsigned char*>(data.data()), data.length(), [&compressed, &calls] (const unsigned char* const a_data, const size_t a_length) {
+                CHECK(a_length <= Compressor::sk_chunk_size_);
+                compressed.append(reinterpret_cast<const char*>(a_data), a_length);
+                calls++;
+            });
+            CHECK(calls > 0 && compressed.length() < data.length());
+            // ... right container ...
+            CHECK(compressed.length() > 2);
+            if ( Compressor::Codec::GZip == codec ) {
+                CHECK(0x1f == static_cast<unsigned char>(compressed[0]) && 0x8b == static_cast<unsigned char>(compressed[1]));
+            } else {
+                CHECK(0 == ( ( static_cast<unsigned char>(compressed[0]) << 8 ) | static_cast<unsigned char>(compressed[1]) ) % 31);
+            }
+            std::string decoded;
+            CHECK(true == Inflate(compressed, decoded) && data == decoded);
+        }
+        // ... empty input still produces a valid stream ...
+        std::string empty;
+        Compressor(codec, -1).Do(nullptr, 0, [&empty] (const unsigned char* const a_data, const size_t a_length) {
+            empty.append(reinterpret_cast<const char*>(a_data), a_length);
+        });
+        std::string decoded = "x";
+        CHECK(true == Inflate(empty, decoded) && 0 == decoded.length());
+    }
+
+    // ... policy ...
+    {
+        std::string small = "small";
+        CHECK(false == Compressor::Compress({ Compressor::Codec::GZip, -1, 1024 }, small) && "small" == small);
+        std::string large = data;
+        CHECK(true == Compressor::Compress({ Compressor::Codec::GZip, -1, 1024 }, large) && large.length() < data.length());
+        std::string decoded;
+        CHECK(true == Inflate(large, decoded) && data == decoded);
+        std::string none = data;
+        CHECK(false == Compressor::Compress({ Compressor::Codec::None, -1, 0 }, none) && data == none);
+    }
+
+    // ... names ...
+    CHECK(Compressor::Codec::Deflate == Compressor::Translated("deflate"));
+    CHECK(Compressor::Codec::GZip    == Compressor::Translated("GZIP"));
+    CHECK(nullptr == Compressor::ContentType(Compressor::Codec::None));
+    CHECK(std::string("application/gzip") == Compressor::ContentType(Compressor::Codec::GZip));
+    CHECK(nullptr == Compressor::Encoding(Compressor::Codec::None));
+    CHECK(std::string("deflate") == Compressor::Encoding(Compressor::Codec::Deflate));
+
+    // ... invalid settings ...
+    CHECK_THROWS(::cc::Exception, Compressor::ValidateLevel(Compressor::Codec::GZip, 12));
+    CHECK_THROWS(::cc::Exception, Compressor::Translated("lzma"));
+
+    return TEST_DONE();
+}
@@ -0,0 +1,125 @@
+/**
+ * @file decompressor.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// codec::Decompressor: bodies encoded by codec::Compressor, for every codec and a few levels, raw deflate, truncated streams, pass-through:
+//
+// g++ -std=c++11 -O2 -I src -I $CC_SRC test/decompressor.cc src/casper/proxy/worker/codec/compressor.cc src/casper/proxy/worker/codec/decompressor.cc -lz -o /tmp/decompressor && /tmp/decompressor
+//
+// add -DCASPER_PROXY_WORKER_WITH_ZSTD and -lzstd to cover zstd too.
+//
+
+#include "casper/proxy/worker/codec/compressor.h"
+#include "casper/proxy/worker/codec/decompressor.h"
+
+#include "cc/exception.h"
+
+#include "check.h"
+
+#include <zlib.h>
+
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+int main ()
+{
+    using Compressor   = casper::proxy::worker::codec::Compressor;
+    using Decompressor = casper::proxy::worker::codec::Decompressor;
+
+    // ... compressible, larger than a few output chunks ...
+    std::string  data;
+    std::mt19937 random(1);
+    while ( data.length() < 3 * 1024 * 1024 ) {
+        data += "line " + std::to_string(random() % 1000) + "\n";
+    }
+
+    std::vector<std::pair<Compressor::Codec, std::string>> codecs = { { Compressor::Codec::Deflate, "deflate" }, { Compressor::Codec::GZip, "gzip" } };
+#ifdef CASPER_PROXY_WORKER_WITH_ZSTD
+    codecs.push_back({ Compressor::Codec::ZSTD, "zstd" });
+#endif
+
+    for ( const auto& it : codecs ) {
+        const Compressor::Codec codec = it.first;
+        for ( const int level : { -1, 1, 9 } ) {
+            std::string compressed;
+            size_t      calls = 0;
+            Compressor(codec, level).Do(reinterpret_cast<const unsigned char*>(data.data()), data.length(), [&compressed, &calls] (const unsigned char* const a_data, const size_t a_length) {
+                CHECK(a_length <= Compressor::sk_chunk_size_);
+                compressed.append(reinterpret_cast<const char*>(a_data), a_length);
+                calls++;
+            });
+            CHECK(calls > 0 && compressed.length() < data.length());
+            // ... decode it as a response body would be ...
+            const Decompressor::Headers headers = { { "Content-Encoding", it.second }, { "Content-Type", "text/plain" } };
+            CHECK(codec == Decompressor::Encoding(headers));
+            std::string        buffer;
+            const std::string& decoded = Decompressor::Decoded(headers, compressed, buffer);
+            CHECK(&decoded == &buffer);
+            CHECK(data == decoded);
+            Decompressor::Headers stripped;
+            Decompressor::Stripped(headers, stripped);
+            CHECK(1 == stripped.size() && stripped.end() == stripped.find("Content-Encoding"));
+            // ... truncated data is an error ...
+            std::string truncated;
+            CHECK_THROWS(::cc::Exception, Decompressor::Do(codec, reinterpret_cast<const unsigned char*>(compressed.data()), compressed.length() / 2, truncated));
+        }
+        // ... empty input still produces a valid stream ...
+        std::string empty;
+        Compressor(codec, -1).Do(nullptr, 0, [&empty] (const unsigned char* const a_data, const size_t a_length) {
+            empty.append(reinterpret_cast<const char*>(a_data), a_length);
+        });
+        std::string decoded = "x";
+        Decompressor::Do(codec, reinterpret_cast<const unsigned char*>(empty.data()), empty.length(), decoded);
+        CHECK(0 == decoded.length());
+    }
+
+    // ... 'deflate' encoded bodies are sometimes raw deflate, without zlib header ...
+    {
+        z_stream stream = {};
+        CHECK(Z_OK == deflateInit2(&stream, 6, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY));
+        std::string raw(deflateBound(&stream, static_cast<uLong>(data.length())), '\0');
+        stream.next_in   = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+        stream.avail_in  = static_cast<uInt>(data.length());
+        stream.next_out  = reinterpret_cast<Bytef*>(&raw[0]);
+        stream.avail_out = static_cast<uInt>(raw.length());
+        CHECK(Z_STREAM_END == deflate(&stream, Z_FINISH));
+        raw.resize(stream.total_out);
+        deflateEnd(&stream);
+        std::string decoded;
+        Decompressor::Do(Compressor::Codec::Deflate, reinterpret_cast<const unsigned char*>(raw.data()), raw.length(), decoded);
+        CHECK(data == decoded);
+    }
+
+    // ... not encoded: body is used as-is, no copy ...
+    {
+        const Decompressor::Headers headers = { { "Content-Type", "text/plain" } };
+        std::string                 buffer;
+        CHECK(Compressor::Codec::None == Decompressor::Encoding(headers));
+        CHECK(&data == &Decompressor::Decoded(headers, data, buffer));
+    }
+
+    // ... not supported ...
+    CHECK_THROWS(::cc::Exception, Decompressor::Encoding({ { "Content-Encoding", "br" } }));
+
+    return TEST_DONE();
+}
@@ -0,0 +1,202 @@
+/**
+ * @file gateway.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// http::Gateway: V1 and V2 responses decode back to the same status, content type, body and headers, V2 frames have the announced size:
+//
+// g++ -std=c++11 -O2 -I src -I $CC_SRC -I /usr/include/jsoncpp test/gateway.cc src/casper/proxy/worker/http/gateway.cc src/casper/proxy/worker/fs/spill.cc src/casper/proxy/worker/fs/store.cc src/casper/proxy/worker/fs/writer.cc -ljsoncpp -lcrypto -lpthread -o /tmp/gateway && /tmp/gateway
+//
+
+#include "casper/proxy/worker/http/gateway.h"
+
+#include "cc/exception.h"
+
+#include "check.h"
+
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string.h> // strlen
+#include <utility>
+#include <vector>
+
+typedef std::vector<std::pair<std::string, std::string>> Headers;
+
+/**
+ * @brief Encode a response as V1 and decode it back.
+ *
+ * @return True if decoded response matches the encoded one.
+ */
+static bool V1 (const uint16_t a_code, const std::string& a_content_type, const std::string& a_body, const Headers& a_headers)
+{
+    using Gateway = casper::proxy::worker::http::Gateway;
+
+    Json::Value payload = Json::Value(Json::ValueType::objectValue);
+    Gateway::Encode(Gateway::Format::V1, a_code, a_content_type, a_body.c_str(), a_body.length(), a_headers, /* a_output */ {}, payload);
+    if ( false == payload.isMember("data") || false == payload["data"].isString() ) {
+        return false;
+    }
+    Gateway::Message message;
+    Gateway::Decode(payload["data"].asString(), message);
+    return ( a_code == message.code_ && a_content_type == message.content_type_ && a_body == message.body_ && a_headers == message.headers_ );
+}
+
+/**
+ * @brief Encode a response as V2 and decode it back.
+ *
+ * @return True if decoded response matches the encoded one, and frame size is the announced one.
+ */
+static bool V2 (const uint16_t a_code, const std::string& a_content_type, const std::string& a_body, const Headers& a_headers, const std::string& a_dir)
+{
+    using Gateway = casper::proxy::worker::http::Gateway;
+
+    const casper::proxy::worker::fs::Spill::Config output = { /* threshold_ */ 0, /* dir_ */ a_dir, /* prefix_ */ "", /* base_url_ */ "", /* store_ */ "" };
+
+    Json::Value payload = Json::Value(Json::ValueType::objectValue);
+    Gateway::Encode(Gateway::Format::V2, a_code, a_content_type, a_body.c_str(), a_body.length(), a_headers, output, payload);
+    // ... never inlined ...
+    if ( true == payload.isMember("data") || false == payload["url"].isString() || false == payload["size"].isNumeric() ) {
+        return false;
+    }
+    const std::string url = payload["url"].asString();
+    if ( 0 != url.find("file://" + a_dir) ) {
+        return false;
+    }
+    std::ifstream     file(url.substr(strlen("file://")), std::ios::binary);
+    std::stringstream ss;
+    ss << file.rdbuf();
+    const std::string data = ss.str();
+    // ... '@2' + code + count + content type + headers + ( chunk length + chunk )* + tail ...
+    size_t expected = 2 + 2 + 4 + 4 + a_content_type.length() + ( ( a_body.length() + Gateway::sk_v2_chunk_size_ - 1 ) / Gateway::sk_v2_chunk_size_ ) * 4 + a_body.length() + 4;
+    for ( const auto& header : a_headers ) {
+        expected += 4 + header.first.length() + 4 + header.second.length();
+    }
+    if ( expected != data.length() || payload["size"].asUInt64() != data.length() ) {
+        return false;
+    }
+    Gateway::Message message;
+    Gateway::Decode(data, message);
+    return ( a_code == message.code_ && a_content_type == message.content_type_ && a_body == message.body_ && a_headers == message.headers_ );
+}
+
+int main ()
+{
+    using Gateway = casper::proxy::worker::http::Gateway;
+
+    std::mt19937 random(1);
+
+    Headers many;
+    for ( size_t idx = 0 ; idx < 200 ; ++idx ) {
+        many.push_back(std::make_pair("X-Header-" + std::to_string(idx), std::string(idx % 17, static_cast<char>('a' + idx % 26))));
+    }
+    const Headers tricky = {
+        { "Date"      , "Mon, 01 Jan 2024 00:00:00 GMT"            },
+        { "Link"      , "<https://example.com:8443/a,b>; rel=next" },
+        { "X-Odd,Name", ":,:,,"                                    },
+        { "X-Empty"   , ""                                         },
+        { "Set-Cookie", "a=1"                                      },
+        { "Set-Cookie", "b=2"                                      }
+    };
+    std::string binary(1000, '\0');
+    for ( auto& c : binary ) {
+        c = static_cast<char>(random());
+    }
+
+    // ... V1 ...
+    for ( const auto& body : { std::string(""), std::string("{\"a\":1}"), std::string(",12,!,:"), binary } ) {
+        for ( const auto& content_type : { std::string(""), std::string("application/json; charset=utf-8") } ) {
+            CHECK(true == V1(200, content_type, body, {}));
+            CHECK(true == V1(404, content_type, body, { { "Content-Length", std::to_string(body.length()) } }));
+            CHECK(true == V1(500, content_type, body, many));
+            CHECK(true == V1(0  , content_type, body, tricky));
+        }
+    }
+
+    // ... V1, any container of pairs, exact layout ...
+    {
+        const std::map<std::string, std::string> headers = { { "a", "1" }, { "b", "2,3" } };
+        Json::Value payload = Json::Value(Json::ValueType::objectValue);
+        Gateway::Encode(Gateway::Format::V1, 201, "text/plain", "ok", 2, headers, /* a_output */ {}, payload);
+        CHECK("!201,10,text/plain,2,ok,3,a:1,5,b:2,3" == payload["data"].asString());
+    }
+
+    // ... V1, malformed ...
+    {
+        Gateway::Message message;
+        for ( const char* const data : { "", "200", "!", "!200", "!200,", "!200,3,abc", "!200,3,ab", "!200,0,,2,ok,3,a", "!200,0,,2,ok,x" } ) {
+            CHECK_THROWS(::cc::Exception, Gateway::Decode(data, message));
+        }
+    }
+
+    const std::string scratch = TestScratch();
+
+    // ... V2, bodies with NUL bytes, at and around chunk boundaries ...
+    std::string nul = std::string("\0a\0\0b", 5) + binary;
+    for ( const size_t length : { static_cast<size_t>(0), static_cast<size_t>(1), Gateway::sk_v2_chunk_size_ - 1, Gateway::sk_v2_chunk_size_, Gateway::sk_v2_chunk_size_ + 1, 3 * Gateway::sk_v2_chunk_size_ + 7 } ) {
+        std::string body(length, '\0');
+        for ( size_t idx = 0 ; idx < length ; idx += 4093 ) {
+            body[idx] = static_cast<char>(random());
+        }
+        for ( const auto& content_type : { std::string(""), std::string("application/octet-stream") } ) {
+            CHECK(true == V2(200, content_type, body, {}, scratch));
+            CHECK(true == V2(206, content_type, body, tricky, scratch));
+        }
+    }
+    CHECK(true == V2(500, "text/plain", nul, many, scratch));
+
+    // ... V2, hand made frame: several chunks ...
+    std::string frame;
+    const Gateway::Sink sink = [&frame] (const char* const a_data, const size_t a_length) {
+        frame.append(a_data, a_length);
+    };
+    Gateway::Head(200, "text/plain", Headers({ { "a", "1" } }), sink);
+    Gateway::Chunk("hel", 3, sink);
+    Gateway::Chunk("", 0, sink);
+    Gateway::Chunk(std::string("l\0o", 3).c_str(), 3, sink);
+    Gateway::Tail(sink);
+    {
+        Gateway::Message message;
+        Gateway::Decode(frame, message);
+        CHECK(200 == message.code_ && "text/plain" == message.content_type_ && std::string("hell\0o", 6) == message.body_ && Headers({ { "a", "1" } }) == message.headers_);
+    }
+
+    // ... V2, truncated frames and trailing data ...
+    {
+        Gateway::Message message;
+        for ( size_t length = 0 ; length < frame.length() ; ++length ) {
+            CHECK_THROWS(::cc::Exception, Gateway::Decode(frame.substr(0, length), message));
+        }
+        CHECK_THROWS(::cc::Exception, Gateway::Decode(frame + '\0', message));
+        CHECK_THROWS(::cc::Exception, Gateway::Decode(frame + frame, message));
+    }
+
+    // ... V2, no output directory ...
+    {
+        Json::Value payload = Json::Value(Json::ValueType::objectValue);
+        CHECK_THROWS(::cc::Exception, Gateway::Encode(Gateway::Format::V2, 200, "", "", 0, Headers(), /* a_output */ {}, payload));
+    }
+
+    TestScratchRemove(scratch);
+
+    return TEST_DONE();
+}
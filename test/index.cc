@@ -0,0 +1,81 @@
+/**
+ * @file index.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// http::Index: keys ignore header names case, order and revalidation headers, entries are forgotten once their file is gone or expired:
+//
+// g++ -std=c++11 -O2 -I src -I $CC_SRC test/index.cc src/casper/proxy/worker/http/index.cc -o /tmp/index -lcrypto && /tmp/index
+//
+
+#include "casper/proxy/worker/http/index.h"
+
+#include "check.h"
+
+#include <fstream>
+
+#include <unistd.h>
+
+int main ()
+{
+    using Index  = casper::proxy::worker::http::Index;
+    using Client = ::cc::easy::http::Client;
+
+    // ... keys ...
+    const Client::Headers h1 = { { "Accept", { "a" } }, { "X-B", { "1", "2" } } };
+    const Client::Headers h2 = { { "x-b", { "1", "2" } }, { "accept", { "a" } }, { "If-None-Match", { "\"x\"" } }, { "If-Modified-Since", { "y" } } };
+    const Client::Headers h3 = { { "Accept", { "a" } }, { "X-B", { "2", "1" } } };
+    const std::string     key = Index::Key(Client::Method::GET, "u", h1, false);
+    CHECK(key == Index::Key(Client::Method::GET, "u", h2, false));
+    CHECK(key != Index::Key(Client::Method::GET, "u", h3, false));
+    CHECK(key != Index::Key(Client::Method::GET, "u", h1, true));
+    CHECK(key != Index::Key(Client::Method::GET, "v", h1, false));
+    CHECK(key != Index::Key(Client::Method::POST, "u", h1, false));
+
+    // ... headers ...
+    CHECK("\"x\"" == Index::Header({ { "etag", "\"x\"" } }, "ETag"));
+    CHECK(""      == Index::Header({ { "etag", "\"x\"" } }, "Last-Modified"));
+
+    const std::string scratch = TestScratch();
+    const std::string uri     = scratch + "index.bin";
+    std::ofstream(uri) << "data";
+
+    auto& index = Index::GetInstance();
+    Index::Entry entry;
+
+    // ... only what can be revalidated is tracked ...
+    index.Set("plain", { { "Content-Type", "text/plain" } }, uri, 10);
+    CHECK(false == index.Find("plain", entry));
+    index.Set(key, { { "etag", "\"x\"" }, { "Last-Modified", "y" } }, uri, 10);
+    CHECK(true == index.Find(key, entry));
+    CHECK(uri == entry.uri_ && "\"x\"" == entry.etag_ && "y" == entry.last_modified_);
+
+    // ... no validity, not tracked either ...
+    index.Set("expired", { { "ETag", "\"z\"" } }, uri, 0);
+    CHECK(false == index.Find("expired", entry));
+
+    // ... file is gone ...
+    CHECK(0 == unlink(uri.c_str()));
+    CHECK(false == index.Find(key, entry));
+
+    TestScratchRemove(scratch);
+
+    return TEST_DONE();
+}
@@ -0,0 +1,120 @@
+/**
+ * @file pool.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// executor::Pool: every accepted task runs exactly once, on a pool thread, rejected ones are reported to the caller, V8 instance work never stalls
+// post-processing ( also meant to be run with -fsanitize=thread ):
+//
+// g++ -std=c++11 -O2 -pthread -I src -I $CC_SRC test/pool.cc src/casper/proxy/worker/executor/pool.cc -o /tmp/pool && /tmp/pool
+//
+
+#include "casper/proxy/worker/executor/pool.h"
+
+#include "check.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+
+int main ()
+{
+    using casper::proxy::worker::executor::Pool;
+
+    auto& pool = Pool::GetInstance();
+    pool.Setup(4);
+
+    const std::thread::id caller = std::this_thread::get_id();
+    std::atomic<size_t>   ran(0);
+    std::atomic<size_t>   on_caller(0);
+    std::mutex            mutex;
+    std::set<std::thread::id> threads;
+    size_t                accepted = 0;
+    size_t                rejected = 0;
+
+    // ... bursts larger than the queue, some tasks will be rejected ...
+    for ( int burst = 0 ; burst < 50 ; ++burst ) {
+        for ( size_t idx = 0 ; idx < 2 * Pool::sk_max_pending_ ; ++idx ) {
+            const bool submitted = pool.Submit([&ran, &on_caller, &mutex, &threads, caller] () {
+                if ( caller == std::this_thread::get_id() ) {
+                    on_caller++;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    threads.insert(std::this_thread::get_id());
+                }
+                ran++;
+            });
+            if ( true == submitted ) {
+                accepted++;
+            } else {
+                rejected++;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    // ... wait for all accepted tasks ...
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while ( ran.load() < accepted && std::chrono::steady_clock::now() < deadline ) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    CHECK(accepted == ran.load());
+    CHECK(0 == on_caller.load());
+    CHECK(threads.size() >= 1 && threads.size() <= 4);
+    fprintf(stdout, "accepted: %zu, rejected: %zu, threads: %zu\n", accepted, rejected, threads.size());
+
+    // ... V8 instance: tasks blocked there ( e.g. waiting for an isolate ) never stall post-processing ...
+    {
+        auto& v8 = Pool::GetV8Instance();
+        CHECK(&v8 != &pool);
+
+        std::mutex                   isolate;
+        std::unique_lock<std::mutex> leased(isolate);
+        std::atomic<size_t>          blocked(0);
+        for ( size_t idx = 0 ; idx < Pool::sk_v8_threads_ ; ++idx ) {
+            CHECK(true == v8.Submit([&isolate, &blocked] () {
+                std::lock_guard<std::mutex> lock(isolate);
+                blocked++;
+            }));
+        }
+        std::atomic<bool> done(false);
+        CHECK(true == pool.Submit([&done] () {
+            done = true;
+        }));
+        const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while ( false == done.load() && std::chrono::steady_clock::now() < until ) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        CHECK(true == done.load());
+        CHECK(0 == blocked.load());
+        leased.unlock();
+        while ( blocked.load() < Pool::sk_v8_threads_ && std::chrono::steady_clock::now() < until ) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        CHECK(Pool::sk_v8_threads_ == blocked.load());
+    }
+
+    return TEST_DONE();
+}
@@ -0,0 +1,100 @@
+/**
+ * @file ring.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// executor::Ring: capacity, FIFO order per producer and no loss under concurrent producers ( also meant to be run with -fsanitize=thread ):
+//
+// g++ -std=c++11 -O2 -pthread -I src -I $CC_SRC test/ring.cc -o /tmp/ring && /tmp/ring
+//
+
+#include "casper/proxy/worker/executor/ring.h"
+
+#include "check.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <stdint.h>
+
+int main ()
+{
+    using casper::proxy::worker::executor::Ring;
+
+    // ... single thread: exactly N records fit, FIFO ...
+    {
+        static Ring<int, 8> ring;
+        int value = -1;
+        CHECK(false == ring.Pop(value));
+        for ( int idx = 0 ; idx < 8 ; ++idx ) {
+            CHECK(true == ring.Push(idx));
+        }
+        CHECK(false == ring.Push(8));
+        for ( int idx = 0 ; idx < 8 ; ++idx ) {
+            CHECK(true == ring.Pop(value) && idx == value);
+        }
+        CHECK(false == ring.Pop(value));
+        // ... wraps around ...
+        for ( int round = 0 ; round < 100 ; ++round ) {
+            CHECK(true == ring.Push(round) && true == ring.Pop(value) && round == value);
+        }
+    }
+
+    // ... multiple producers, one consumer: nothing lost or duplicated, each producer order is kept ...
+    {
+        static Ring<uint64_t, 64> ring;
+        const uint64_t            producers = 4;
+        const uint64_t            count     = 200000;
+        std::atomic<uint64_t>     full(0);
+        std::vector<std::thread>  threads;
+        for ( uint64_t producer = 0 ; producer < producers ; ++producer ) {
+            threads.push_back(std::thread([&full, producer, count] () {
+                for ( uint64_t idx = 0 ; idx < count ; ++idx ) {
+                    while ( false == ring.Push(( producer << 32 ) | idx) ) {
+                        full++;
+                        std::this_thread::yield();
+                    }
+                }
+            }));
+        }
+        std::vector<int64_t> last(producers, -1);
+        bool                 ordered  = true;
+        uint64_t             received = 0;
+        uint64_t             value;
+        while ( received < producers * count ) {
+            if ( true == ring.Pop(value) ) {
+                const uint64_t producer = value >> 32;
+                const int64_t  idx      = static_cast<int64_t>(value & 0xFFFFFFFF);
+                ordered = ordered && ( producer < producers && last[producer] + 1 == idx );
+                last[producer] = idx;
+                received++;
+            }
+        }
+        for ( auto& thread : threads ) {
+            thread.join();
+        }
+        CHECK(true == ordered);
+        CHECK(false == ring.Pop(value));
+        fprintf(stdout, "received: %llu, push attempts on full ring: %llu\n", static_cast<unsigned long long>(received), static_cast<unsigned long long>(full.load()));
+    }
+
+    return TEST_DONE();
+}
@@ -0,0 +1,101 @@
+/**
+ * @file store.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// fs::Store: same content is written once and hard linked, different variants are kept apart, unlinked objects are pruned:
+//
+// g++ -std=c++11 -O2 -I src -I $CC_SRC test/store.cc src/casper/proxy/worker/fs/store.cc -o /tmp/store -lcrypto && /tmp/store
+//
+
+#include "casper/proxy/worker/fs/store.h"
+
+#include "check.h"
+
+#include <fstream>
+#include <sstream>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+int main ()
+{
+    using Store = casper::proxy::worker::fs::Store;
+
+    const std::string scratch = TestScratch();
+    const std::string dir     = scratch + "store";
+    CHECK(0 == mkdir(dir.c_str(), 0755));
+
+    size_t writes = 0;
+    const auto put = [&writes, &dir] (const std::string& a_uri, const std::string& a_data, const std::string& a_variant) -> bool {
+        return Store::Put(dir, Store::Key(a_data, a_variant), a_uri, [&writes, &a_uri, &a_data] () {
+            writes++;
+            std::ofstream(a_uri, std::ios::binary) << a_data;
+        });
+    };
+
+    // ... keys ...
+    CHECK(Store::Key("hello", "") == Store::Key("hello", ""));
+    CHECK(Store::Key("hello", "") != Store::Key("hello!", ""));
+    CHECK(Store::Key("hello", "") != Store::Key("hello", "base64"));
+
+    // ... first one is written, second one is linked ...
+    CHECK(false == put(scratch + "a.ohc", "hello", ""));
+    CHECK(true  == put(scratch + "b.ohc", "hello", ""));
+    CHECK(1 == writes);
+    struct stat st;
+    CHECK(0 == stat((scratch + "b.ohc").c_str(), &st) && 3 == st.st_nlink && 5 == st.st_size);
+    {
+        std::ifstream     file(scratch + "b.ohc", std::ios::binary);
+        std::stringstream ss;
+        ss << file.rdbuf();
+        CHECK("hello" == ss.str());
+    }
+    CHECK(0 != access((scratch + "b.ohc.lnk").c_str(), F_OK));
+
+    // ... other variant, other object ...
+    CHECK(false == put(scratch + "c.ohc", "hello", "base64"));
+    CHECK(2 == writes);
+
+    // ... disabled ...
+    CHECK(false == Store::Put("", Store::Key("hello", ""), scratch + "d.ohc", [&writes] () { writes++; }));
+    CHECK(3 == writes);
+
+    // ... only objects no longer linked by any job file are pruned ...
+    uint64_t files = 0;
+    uint64_t bytes = 0;
+    Store::Prune(dir, files, bytes);
+    CHECK(0 == files && 0 == bytes);
+    CHECK(0 == unlink((scratch + "a.ohc").c_str()));
+    Store::Prune(dir, files, bytes);
+    CHECK(0 == files && 0 == bytes);
+    CHECK(0 == unlink((scratch + "b.ohc").c_str()));
+    Store::Prune(dir, files, bytes);
+    CHECK(1 == files && 5 == bytes);
+    CHECK(0 == stat((scratch + "c.ohc").c_str(), &st) && 2 == st.st_nlink);
+
+    // ... and, once pruned, content is written again ...
+    CHECK(false == put(scratch + "e.ohc", "hello", ""));
+    CHECK(4 == writes);
+
+    TestScratchRemove(scratch);
+
+    return TEST_DONE();
+}
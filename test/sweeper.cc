@@ -0,0 +1,95 @@
+/**
+ * @file sweeper.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// fs::Sweeper: buckets outlive validity plus grace plus margin, expired ( and interrupted ) buckets are removed, live ones are kept:
+//
+// g++ -std=c++11 -O2 -pthread -I src -I $CC_SRC test/sweeper.cc src/casper/proxy/worker/fs/sweeper.cc src/casper/proxy/worker/fs/store.cc -o /tmp/sweeper -lcrypto && /tmp/sweeper
+//
+
+#include "casper/proxy/worker/fs/sweeper.h"
+
+#include "check.h"
+
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+int main ()
+{
+    using Sweeper = casper::proxy::worker::fs::Sweeper;
+
+    // ... grace ...
+    CHECK(0  == Sweeper::Grace(0, -1));
+    CHECK(30 == Sweeper::Grace(10, 20));
+    CHECK(20 == Sweeper::Grace(-1, 20));
+
+    const std::string scratch = TestScratch();
+    const std::string root    = scratch + "expires/";
+
+    // ... expired bucket, with nested content, and an interrupted removal ...
+    CHECK(0 == mkdir(root.c_str(), 0755));
+    CHECK(0 == mkdir((root + "5").c_str(), 0755));
+    CHECK(0 == mkdir((root + "5/x").c_str(), 0755));
+    CHECK(0 == mkdir((root + ".7").c_str(), 0755));
+    std::ofstream(root + "5/a") << "hello";
+    std::ofstream(root + "5/x/b") << "hi";
+    // ... not a bucket ...
+    CHECK(0 == mkdir((root + "other").c_str(), 0755));
+
+    auto&         sweeper  = Sweeper::GetInstance();
+    const int64_t now      = static_cast<int64_t>(time(nullptr));
+    const int64_t validity = 100;
+    const int64_t grace    = 40;
+    const int64_t bucket   = 60;
+    const std::string dir  = sweeper.Dir(scratch, validity, bucket, grace);
+
+    // ... '<root><epoch>/', epoch is a multiple of bucket size, not before files expire ...
+    CHECK(0 == dir.find(root) && '/' == dir.back());
+    const int64_t epoch = std::stoll(dir.substr(root.length()));
+    CHECK(0 == epoch % bucket);
+    CHECK(epoch >= now + validity + grace + Sweeper::sk_margin_);
+    CHECK(epoch <  now + validity + grace + Sweeper::sk_margin_ + bucket + 2);
+    struct stat st;
+    CHECK(0 == stat(dir.c_str(), &st) && 0 != S_ISDIR(st.st_mode));
+    CHECK(dir == sweeper.Dir(scratch, validity, bucket, grace));
+
+    // ... first sweep starts with the thread ...
+    Sweeper::Stats stats = sweeper.stats();
+    for ( int attempt = 0 ; attempt < 100 && 2 != stats.buckets_ ; ++attempt ) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        stats = sweeper.stats();
+    }
+    CHECK(2 == stats.buckets_ && 2 == stats.files_ && 7 == stats.bytes_);
+    CHECK(0 != access((root + "5").c_str(), F_OK));
+    CHECK(0 != access((root + ".5").c_str(), F_OK));
+    CHECK(0 != access((root + ".7").c_str(), F_OK));
+    CHECK(0 == access((root + "other").c_str(), F_OK));
+    CHECK(0 == access(dir.c_str(), F_OK));
+
+    TestScratchRemove(scratch);
+
+    return TEST_DONE();
+}
@@ -0,0 +1,120 @@
+/**
+ * @file writer.cc
+ *
+ * Copyright (c) 2011-2021 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-proxy-worker.
+ *
+ * casper-proxy-worker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-proxy-worker  is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-proxy-worker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// fs::Writer: sequential appends and concurrent positional writes produce the exact content and size, even when the reservation is larger:
+//
+// g++ -std=c++11 -O2 -pthread -I src -I $CC_SRC test/writer.cc src/casper/proxy/worker/fs/writer.cc -o /tmp/writer && /tmp/writer
+//
+
+#include "casper/proxy/worker/fs/writer.h"
+
+#include "cc/exception.h"
+
+#include "check.h"
+
+#include <algorithm> // std::min
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+
+/**
+ * @return File content.
+ */
+static std::string Content (const std::string& a_uri)
+{
+    std::ifstream     file(a_uri, std::ios::binary);
+    std::stringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+int main ()
+{
+    using Writer = casper::proxy::worker::fs::Writer;
+
+    const std::string scratch = TestScratch();
+
+    // ... appends, not buffer aligned, spanning several buffers, reservation larger than the content ...
+    {
+        std::string data(5 * Writer::sk_buffer_size_ + 123, '\0');
+        for ( size_t idx = 0 ; idx < data.length() ; ++idx ) {
+            data[idx] = static_cast<char>(idx * 31);
+        }
+        const std::string uri = scratch + "append.bin";
+        {
+            Writer writer(uri, 2 * data.length());
+            for ( size_t offset = 0 ; offset < data.length() ; offset += 70000 ) {
+                writer.Append(reinterpret_cast<const unsigned char*>(data.data()) + offset, std::min(static_cast<size_t>(70000), data.length() - offset));
+            }
+            writer.Close();
+        }
+        struct stat st;
+        CHECK(0 == stat(uri.c_str(), &st) && data.length() == static_cast<size_t>(st.st_size));
+        CHECK(data == Content(uri));
+    }
+
+    // ... nothing written ...
+    {
+        const std::string uri = scratch + "empty.bin";
+        {
+            Writer writer(uri, 1024);
+            writer.Close();
+        }
+        struct stat st;
+        CHECK(0 == stat(uri.c_str(), &st) && 0 == st.st_size);
+    }
+
+    // ... positional writes, from several threads, in reverse order ...
+    {
+        const size_t count  = 8;
+        const size_t length = 1000003;
+        std::string  data(count * length, '\0');
+        for ( size_t idx = 0 ; idx < data.length() ; ++idx ) {
+            data[idx] = static_cast<char>(idx * 7);
+        }
+        const std::string uri = scratch + "write-at.bin";
+        {
+            Writer                   writer(uri, data.length() + 100);
+            std::vector<std::thread> threads;
+            for ( size_t idx = count ; idx-- > 0 ; ) {
+                threads.push_back(std::thread([&writer, &data, idx, length] () {
+                    writer.WriteAt(reinterpret_cast<const unsigned char*>(data.data()) + idx * length, length, static_cast<off_t>(idx * length));
+                }));
+            }
+            for ( auto& thread : threads ) {
+                thread.join();
+            }
+            writer.Close();
+        }
+        CHECK(data == Content(uri));
+    }
+
+    // ... unable to open ...
+    CHECK_THROWS(::cc::Exception, Writer(scratch + "missing/file.bin", 0));
+
+    TestScratchRemove(scratch);
+
+    return TEST_DONE();
+}